@@ -24,10 +24,14 @@
 
 #include "dsp.hpp"
 
+#include "audio/biquad.hpp"
 #include "audio/data.hpp"
 #include "audio/decoder.hpp"
+#include "audio/dynamics.hpp"
 #include "audio/encoder.hpp"
 #include "audio/io.hpp"
+#include "audio/mixer.hpp"
+#include "audio/resampler.hpp"
 
 namespace kfr
 {
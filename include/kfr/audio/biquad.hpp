@@ -0,0 +1,199 @@
+/** @addtogroup audio
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#pragma once
+
+#include "../dsp/biquad.hpp"
+#include "data.hpp"
+#include "decoder.hpp"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace kfr
+{
+
+/**
+ * @brief Applies biquad cascades to multichannel audio_data.
+ *
+ * All channels are filtered by one multichannel_biquad, several channels at once in SIMD lanes. Both planar
+ * and interleaved audio_data are filtered without conversion between layouts.
+ */
+struct audio_biquad : public multichannel_biquad<fbase>
+{
+    /**
+     * @brief Constructs a filter with the same sections for all channels.
+     * @param channels Number of channels.
+     * @param params Biquad sections.
+     */
+    audio_biquad(size_t channels, const iir_params<fbase>& params)
+        : multichannel_biquad<fbase>(channels, params)
+    {
+    }
+
+    /**
+     * @brief Constructs a filter with the sections of each channel.
+     * @param params Biquad sections, one element per channel.
+     */
+    explicit audio_biquad(const std::vector<iir_params<fbase>>& params) : multichannel_biquad<fbase>(params)
+    {
+    }
+
+    /**
+     * @brief Filters the audio.
+     * @param output Output audio, may be the same as input.
+     * @param input Input audio of the same size.
+     */
+    template <bool Interleaved>
+    void apply(audio_data<Interleaved>& output, const audio_data<Interleaved>& input)
+    {
+        KFR_LOGIC_CHECK(output.channels == channels() && input.channels == channels(),
+                        "audio_biquad: channel count mismatch");
+        KFR_LOGIC_CHECK(output.size == input.size, "audio_biquad: size mismatch");
+        if constexpr (Interleaved)
+            process_interleaved(output.data, input.data, input.size);
+        else
+            process(output.pointers(), input.pointers(), input.size);
+    }
+
+    /**
+     * @brief Filters the audio in place.
+     */
+    template <bool Interleaved>
+    void apply(audio_data<Interleaved>& data)
+    {
+        apply(data, data);
+    }
+};
+
+/**
+ * @brief Zero-phase filtering (same as filtfilt) of the decoded audio with bounded memory.
+ *
+ * The input is read three times in segments. The first pass saves the state of the forward filter at the
+ * start of each segment. The second pass goes from the last segment to the first, recomputes the forward
+ * pass of each segment from the saved state and saves the state of the backward filter at its end. The
+ * third pass recomputes both passes of each segment from the saved states and passes the result to
+ * @p output in order. Apart from one segment, memory is two filter states per segment, so inputs larger
+ * than RAM can be filtered. The decoder must support precise seeking.
+ *
+ * @param decoder Opened decoder, read from the start.
+ * @param params Biquad sections applied to all channels.
+ * @param output Called with the planar filtered audio of each segment, from the first to the last.
+ * @param segment_frames Number of frames per segment.
+ * @return Number of frames filtered.
+ */
+template <typename Fn>
+expected<uint64_t, audiofile_error> filtfilt_stream(audio_decoder& decoder, const iir_params<fbase>& params,
+                                                    Fn&& output, size_t segment_frames = 65536)
+{
+    if (!decoder.format())
+        return unexpected(audiofile_error::closed);
+    if (!decoder.seek_is_precise())
+        return unexpected(audiofile_error::not_implemented);
+    if (segment_frames == 0)
+        return unexpected(audiofile_error::invalid_argument);
+    const size_t channels = decoder.format()->channels;
+    audio_data_interleaved buffer(channels, segment_frames);
+
+    // Seeks only when the segments are not read one after another
+    uint64_t position = std::numeric_limits<uint64_t>::max();
+    auto read_segment = [&](size_t index) -> expected<audio_data_planar, audiofile_error>
+    {
+        const uint64_t start = uint64_t(index) * segment_frames;
+        if (start != position)
+        {
+            if (auto sought = decoder.seek(start); !sought)
+                return unexpected(sought.error());
+        }
+        size_t filled = 0;
+        while (filled < segment_frames)
+        {
+            auto read = decoder.read_to(buffer.slice(filled));
+            if (!read && read.error() != audiofile_error::end_of_file)
+                return unexpected(read.error());
+            if (!read || *read == 0)
+                break;
+            filled += *read;
+        }
+        position = start + filled;
+        return audio_data_planar(buffer.slice(0, filled));
+    };
+    auto reverse_channels = [&](audio_data_planar& segment)
+    {
+        for (size_t ch = 0; ch < channels; ++ch)
+        {
+            univector_ref<fbase> channel = segment.channel(ch);
+            std::reverse(channel.begin(), channel.end());
+        }
+    };
+
+    audio_biquad forward(channels, params);
+    audio_biquad backward(channels, params);
+    std::vector<univector<fbase>> forward_states;
+    uint64_t total = 0;
+    for (;;)
+    {
+        auto segment = read_segment(forward_states.size());
+        if (!segment)
+            return unexpected(segment.error());
+        if (segment->empty())
+            break;
+        forward_states.push_back(forward.get_state());
+        forward.apply(*segment);
+        total += segment->size;
+        if (segment->size < segment_frames)
+            break;
+    }
+
+    std::vector<univector<fbase>> backward_states(forward_states.size());
+    for (size_t i = forward_states.size(); i-- > 0;)
+    {
+        auto segment = read_segment(i);
+        if (!segment)
+            return unexpected(segment.error());
+        forward.set_state(forward_states[i]);
+        forward.apply(*segment);
+        backward_states[i] = backward.get_state();
+        reverse_channels(*segment);
+        backward.apply(*segment);
+    }
+
+    for (size_t i = 0; i < forward_states.size(); ++i)
+    {
+        auto segment = read_segment(i);
+        if (!segment)
+            return unexpected(segment.error());
+        forward.set_state(forward_states[i]);
+        forward.apply(*segment);
+        backward.set_state(backward_states[i]);
+        reverse_channels(*segment);
+        backward.apply(*segment);
+        reverse_channels(*segment);
+        output(static_cast<const audio_data_planar&>(*segment));
+    }
+    return total;
+}
+
+} // namespace kfr
@@ -0,0 +1,86 @@
+/** @addtogroup audio
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#pragma once
+
+#include "../dsp/dynamics.hpp"
+#include "data.hpp"
+
+namespace kfr
+{
+
+/**
+ * @brief Applies a compressor, expander or limiter to multichannel audio_data.
+ *
+ * Channels are processed by one dynamics_processor, linked or each with its own gain. Both planar and
+ * interleaved audio_data are supported. The processor works on interleaved frames, so interleaved audio is
+ * copied into its block buffer as is and planar audio is interleaved into it block by block and back. The
+ * output is delayed by latency() frames if the lookahead is used.
+ */
+struct audio_dynamics : public dynamics_processor<fbase>
+{
+    /**
+     * @brief Constructs the processor.
+     * @param params Processing parameters.
+     * @param sample_rate Sample rate in Hz.
+     * @param channels Number of channels.
+     * @param linked If true, all channels share the gain computed from their maximum level.
+     */
+    audio_dynamics(const dynamics_params<fbase>& params, double sample_rate, size_t channels,
+                   bool linked = false)
+        : dynamics_processor<fbase>(params, sample_rate, channels, linked)
+    {
+    }
+
+    using dynamics_processor<fbase>::apply;
+
+    /**
+     * @brief Processes the audio.
+     * @param output Output audio, may be the same as input.
+     * @param input Input audio of the same size.
+     */
+    template <bool Interleaved>
+    void apply(audio_data<Interleaved>& output, const audio_data<Interleaved>& input)
+    {
+        KFR_LOGIC_CHECK(output.channels == channels() && input.channels == channels(),
+                        "audio_dynamics: channel count mismatch");
+        KFR_LOGIC_CHECK(output.size == input.size, "audio_dynamics: size mismatch");
+        if constexpr (Interleaved)
+            process_interleaved(output.data, input.data, input.size);
+        else
+            process(output.pointers(), input.pointers(), input.size);
+    }
+
+    /**
+     * @brief Processes the audio in place.
+     */
+    template <bool Interleaved>
+    void apply(audio_data<Interleaved>& data)
+    {
+        apply(data, data);
+    }
+};
+
+} // namespace kfr
@@ -0,0 +1,413 @@
+/** @addtogroup audio
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#pragma once
+
+#include "../dsp/speaker.hpp"
+#include "data.hpp"
+#include <algorithm>
+#include <span>
+#include <vector>
+
+namespace kfr
+{
+
+/**
+ * @brief Mixes N input channels to M output channels with the gain matrix.
+ *
+ * Output o is the sum of input i multiplied by gain(o, i). The zero entries of the matrix are skipped, so
+ * sparse matrices (routing, downmix) cost only their nonzero entries. Audio is processed in blocks of
+ * block_size frames: the block of every input stays in cache while all outputs are computed from it, the
+ * interleaved audio is converted to planar block by block into the buffer allocated by the constructor, so
+ * mixing doesn't allocate. Gains set with @c ramp = true are crossfaded linearly over the next call to
+ * process or apply with a nonzero number of frames.
+ *
+ * Planar and interleaved audio_data are supported (the layouts of input and output may differ), raw
+ * planar buffers allow more channels than max_audio_channels. Output must not overlap with input.
+ */
+struct audio_matrix_mixer
+{
+    /// Number of frames per block
+    constexpr static size_t block_size = 256;
+
+    /**
+     * @brief Constructs a mixer with all gains set to zero.
+     * @param inputs Number of input channels.
+     * @param outputs Number of output channels.
+     */
+    audio_matrix_mixer(size_t inputs, size_t outputs)
+        : input_count(inputs), output_count(outputs), current(inputs * outputs, fbase(0)),
+          target(inputs * outputs, fbase(0)), in_pointers(inputs), out_pointers(outputs),
+          block_pointers(inputs + outputs), scratch((inputs + outputs) * block_size)
+    {
+        KFR_LOGIC_CHECK(inputs > 0 && outputs > 0, "audio_matrix_mixer: channel count must be positive");
+        update_routes();
+    }
+
+    /**
+     * @brief Constructs a mixer with the gain matrix.
+     * @param gains outputs × inputs gains, row by row (the gains of output 0 first).
+     */
+    audio_matrix_mixer(size_t inputs, size_t outputs, std::span<const fbase> gains)
+        : audio_matrix_mixer(inputs, outputs)
+    {
+        set_gains(gains);
+    }
+
+    /**
+     * @brief Constructs the mixer from one speaker arrangement to another (upmix or downmix).
+     *
+     * A speaker present in both arrangements is passed with the unity gain. Others are distributed to
+     * the nearest speakers of the output: the center to left and right at -3 dB, left and right to the mono
+     * at -3 dB, the surround speakers to the side ones or to the front ones at -3 dB, the top speakers to
+     * the ones below them at -3 dB etc. LFE is dropped unless the output has one.
+     */
+    static audio_matrix_mixer for_arrangements(speaker_arrangement input, speaker_arrangement output)
+    {
+        const std::span<const speaker_type> in  = arrangement_speakers(input);
+        const std::span<const speaker_type> out = arrangement_speakers(output);
+        KFR_LOGIC_CHECK(!in.empty() && !out.empty(), "audio_matrix_mixer: unsupported arrangement");
+        audio_matrix_mixer mixer(in.size(), out.size());
+        for (size_t i = 0; i < in.size(); ++i)
+            mixer.route(out, i, in[i], fbase(1), 0);
+        mixer.current = mixer.target;
+        mixer.update_routes();
+        return mixer;
+    }
+
+    /// Number of input channels
+    size_t inputs() const { return input_count; }
+    /// Number of output channels
+    size_t outputs() const { return output_count; }
+
+    /// Gain from the input to the output (the target one if a ramp is pending)
+    fbase gain(size_t output, size_t input) const { return target[output * input_count + input]; }
+
+    /// @brief Sets one gain, instantly or crossfaded over the next call
+    void set_gain(size_t output, size_t input, fbase gain, bool ramp = false)
+    {
+        KFR_LOGIC_CHECK(output < output_count && input < input_count, "audio_matrix_mixer: invalid channel");
+        target[output * input_count + input] = gain;
+        if (!ramp)
+            current[output * input_count + input] = gain;
+        update_routes();
+    }
+
+    /// @brief Sets all gains (outputs × inputs, row by row), instantly or crossfaded over the next call
+    void set_gains(std::span<const fbase> gains, bool ramp = false)
+    {
+        KFR_LOGIC_CHECK(gains.size() == target.size(), "audio_matrix_mixer: matrix size mismatch");
+        std::copy(gains.begin(), gains.end(), target.begin());
+        if (!ramp)
+            current = target;
+        update_routes();
+    }
+
+    /**
+     * @brief Mixes planar buffers.
+     * @param output Pointers to the outputs() output channels.
+     * @param input Pointers to the inputs() input channels.
+     * @param size Number of frames.
+     */
+    void process(fbase* const* output, const fbase* const* input, size_t size)
+    {
+        std::copy_n(input, input_count, in_pointers.begin());
+        std::copy_n(output, output_count, out_pointers.begin());
+        for (size_t done = 0; done < size; done += block_size)
+        {
+            const size_t frames = std::min(block_size, size - done);
+            mix_block(out_pointers.data(), in_pointers.data(), frames, done == 0 ? size : 0);
+            for (size_t i = 0; i < input_count; ++i)
+                in_pointers[i] += frames;
+            for (size_t o = 0; o < output_count; ++o)
+                out_pointers[o] += frames;
+        }
+        finish_ramp();
+    }
+
+    /**
+     * @brief Mixes the audio.
+     * @param output Output audio with outputs() channels and the size of input.
+     * @param input Input audio with inputs() channels.
+     */
+    template <bool OutputInterleaved, bool InputInterleaved>
+    void apply(audio_data<OutputInterleaved>& output, const audio_data<InputInterleaved>& input)
+    {
+        KFR_LOGIC_CHECK(output.channels == output_count && input.channels == input_count,
+                        "audio_matrix_mixer: channel count mismatch");
+        KFR_LOGIC_CHECK(output.size == input.size, "audio_matrix_mixer: size mismatch");
+        if constexpr (!OutputInterleaved && !InputInterleaved)
+        {
+            process(output.pointers(), input.pointers(), input.size);
+            return;
+        }
+        else
+        {
+            // Interleaved sides go through the planar block buffers. The pointers are taken here rather than
+            // in the constructor, so copies of the mixer use their own scratch
+            fbase** in_block  = block_pointers.data();
+            fbase** out_block = block_pointers.data() + input_count;
+            for (size_t c = 0; c < input_count + output_count; ++c)
+                block_pointers[c] = scratch.data() + c * block_size;
+            const fbase** in = in_pointers.data();
+            fbase** out      = out_pointers.data();
+            if constexpr (InputInterleaved)
+                std::copy_n(in_block, input_count, in);
+            if constexpr (OutputInterleaved)
+                std::copy_n(out_block, output_count, out);
+
+            for (size_t done = 0; done < input.size; done += block_size)
+            {
+                const size_t frames = std::min(block_size, input.size - done);
+                if constexpr (InputInterleaved)
+                {
+                    samples_load(in_block, input.data + done * input_count, input_count, frames);
+                }
+                else
+                {
+                    for (size_t i = 0; i < input_count; ++i)
+                        in[i] = input.data[i] + done;
+                }
+                if constexpr (!OutputInterleaved)
+                {
+                    for (size_t o = 0; o < output_count; ++o)
+                        out[o] = output.data[o] + done;
+                }
+                mix_block(out, in, frames, done == 0 ? input.size : 0);
+                if constexpr (OutputInterleaved)
+                    samples_store(output.data + done * output_count, out, output_count, frames);
+            }
+            finish_ramp();
+        }
+    }
+
+private:
+    struct route_entry
+    {
+        size_t input;
+        fbase from;
+        fbase to;
+    };
+
+    // Output channels are computed from the nonzero entries, two inputs per pass
+    void mix_block(fbase* const* out, const fbase* const* in, size_t frames, size_t ramp_size)
+    {
+        // Crossfade spans the whole call to process or apply
+        if (ramp_size > 0)
+            ramp_length = ramp_size;
+        for (size_t o = 0; o < output_count; ++o)
+        {
+            univector_ref<fbase> y(out[o], frames);
+            const std::vector<route_entry>& entries = routes[o];
+            if (entries.empty())
+            {
+                y = scalar(0);
+                continue;
+            }
+            for (size_t k = 0; k < entries.size(); k += 2)
+            {
+                const bool first = k == 0;
+                if (k + 1 < entries.size())
+                    mix(y, in, entries[k], &entries[k + 1], frames, first);
+                else
+                    mix(y, in, entries[k], nullptr, frames, first);
+            }
+        }
+        ramp_position += frames;
+    }
+
+    void mix(univector_ref<fbase>& y, const fbase* const* in, const route_entry& a, const route_entry* b,
+             size_t frames, bool first)
+    {
+        auto put = [&](auto&& expr)
+        {
+            if (first)
+                y = expr;
+            else
+                y += expr;
+        };
+        const univector_ref<const fbase> xa(in[a.input], frames);
+        const univector_ref<const fbase> xb(b ? in[b->input] : nullptr, b ? frames : 0);
+        if (!ramping)
+        {
+            if (b)
+                put(xa * a.to + xb * b->to);
+            else
+                put(xa * a.to);
+            return;
+        }
+        // Gain of the frame n of the call is from + (to - from) · (n + 1) / length
+        const fbase scale = fbase(1) / ramp_length;
+        auto gain         = [&](const route_entry& e)
+        {
+            const fbase step = (e.to - e.from) * scale;
+            return counter(e.from + step * (ramp_position + 1), step);
+        };
+        if (b)
+            put(xa * gain(a) + xb * gain(*b));
+        else
+            put(xa * gain(a));
+    }
+
+    void finish_ramp()
+    {
+        // A call without frames leaves the ramp pending
+        if (ramping && ramp_position > 0)
+        {
+            current = target;
+            update_routes();
+        }
+        ramp_position = 0;
+    }
+
+    void update_routes()
+    {
+        routes.assign(output_count, {});
+        ramping = false;
+        for (size_t o = 0; o < output_count; ++o)
+        {
+            for (size_t i = 0; i < input_count; ++i)
+            {
+                const fbase from = current[o * input_count + i];
+                const fbase to   = target[o * input_count + i];
+                if (from != 0 || to != 0)
+                    routes[o].push_back({ i, from, to });
+                ramping = ramping || from != to;
+            }
+        }
+    }
+
+    // Adds the input speaker to the output speakers, depth limits the chain of substitutions
+    void route(std::span<const speaker_type> out, size_t input, speaker_type type, fbase gain, int depth)
+    {
+        using enum speaker_type;
+        constexpr fbase h = fbase(0.7071067811865476);
+        auto find         = [&](speaker_type t) -> size_t
+        { return std::find(out.begin(), out.end(), t) - out.begin(); };
+        auto add = [&](speaker_type t, fbase g) { target[find(t) * input_count + input] += gain * g; };
+        auto has = [&](speaker_type t) { return find(t) < out.size(); };
+
+        if (has(type))
+            return add(type, 1);
+        if (depth > 3)
+            return;
+        auto either = [&](speaker_type a, speaker_type b, fbase g)
+        {
+            if (!has(a) || !has(b))
+                return false;
+            add(a, g);
+            add(b, g);
+            return true;
+        };
+        auto single = [&](speaker_type a, fbase g)
+        {
+            if (!has(a))
+                return false;
+            add(a, g);
+            return true;
+        };
+        auto via = [&](speaker_type a, fbase g) { route(out, input, a, gain * g, depth + 1); };
+        switch (type)
+        {
+        case M:
+            if (!single(C, 1) && !either(L, R, h))
+                either(Lc, Rc, h);
+            break;
+        case L:
+        case R:
+            if (!single(M, h) && !single(C, h))
+                single(type == L ? Lc : Rc, 1);
+            break;
+        case C:
+            if (!either(L, R, h) && !single(M, 1))
+                either(Lc, Rc, h);
+            break;
+        case Lfe:
+            single(Lfe2, 1);
+            break;
+        case Lfe2:
+            single(Lfe, 1);
+            break;
+        case Ls:
+        case Rs:
+            if (!single(type == Ls ? Sl : Sr, 1))
+                via(type == Ls ? L : R, h);
+            break;
+        case Sl:
+        case Sr:
+            if (!single(type == Sl ? Ls : Rs, 1))
+                via(type == Sl ? L : R, h);
+            break;
+        case Lc:
+        case Rc:
+            if (!either(type == Lc ? L : R, C, h))
+                via(type == Lc ? L : R, 1);
+            break;
+        case Cs:
+            if (!either(Ls, Rs, h) && !either(Sl, Sr, h))
+            {
+                via(Ls, h);
+                via(Rs, h);
+            }
+            break;
+        case Tm:
+        case Tfc:
+            via(C, h);
+            break;
+        case Tfl:
+            via(L, h);
+            break;
+        case Tfr:
+            via(R, h);
+            break;
+        case Trl:
+            via(Ls, h);
+            break;
+        case Trr:
+            via(Rs, h);
+            break;
+        case Trc:
+            via(Cs, h);
+            break;
+        default:
+            break;
+        }
+    }
+
+    size_t input_count;
+    size_t output_count;
+    univector<fbase> current;
+    univector<fbase> target;
+    std::vector<std::vector<route_entry>> routes;
+    std::vector<const fbase*> in_pointers;
+    std::vector<fbase*> out_pointers;
+    std::vector<fbase*> block_pointers; /**< Channels of scratch, inputs first. */
+    univector<fbase> scratch;           /**< Planar blocks of the interleaved inputs and outputs. */
+    bool ramping         = false;
+    size_t ramp_length   = 1;
+    size_t ramp_position = 0;
+};
+
+} // namespace kfr
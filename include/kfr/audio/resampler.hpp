@@ -0,0 +1,90 @@
+/** @addtogroup audio
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#pragma once
+
+#include "../dsp/sample_rate_conversion.hpp"
+#include "data.hpp"
+
+namespace kfr
+{
+
+/**
+ * @brief Converts the sample rate of multichannel audio_data.
+ *
+ * All channels are processed by one multichannel_samplerate_converter, which computes the phase and the
+ * taps of each output once for all channels. Both planar and interleaved audio_data are accepted.
+ */
+struct audio_resampler : public multichannel_samplerate_converter<fbase>
+{
+    /**
+     * @brief Constructs a resampler.
+     * @param quality The desired conversion quality.
+     * @param input_sample_rate Sample rate of the input.
+     * @param output_sample_rate Sample rate of the output.
+     * @param channels Number of channels.
+     */
+    audio_resampler(sample_rate_conversion_quality quality, size_t input_sample_rate,
+                    size_t output_sample_rate, size_t channels)
+        : multichannel_samplerate_converter<fbase>(quality, itype(output_sample_rate),
+                                                   itype(input_sample_rate), channels)
+    {
+    }
+
+    audio_resampler() = default;
+
+    /**
+     * @brief Fills the output with resampled audio (pull or push method).
+     * @param output Output audio, output.size frames are produced.
+     * @param input Input audio, at least input_size_for_output(output.size) frames are expected.
+     * @return Number of input frames processed.
+     */
+    template <bool Interleaved>
+    size_t process(audio_data<Interleaved>& output, const audio_data<Interleaved>& input)
+    {
+        KFR_LOGIC_CHECK(output.channels == channels && input.channels == channels,
+                        "audio_resampler: channel count mismatch");
+        if constexpr (Interleaved)
+            return process_interleaved(output.data, output.size, input.data, input.size);
+        else
+            return multichannel_samplerate_converter<fbase>::process(output.pointers(), output.size,
+                                                                     input.pointers(), input.size);
+    }
+
+    /**
+     * @brief Resamples the whole input (push method).
+     * @param input Input audio.
+     * @return Resampled audio of output_size_for_input(input.size) frames.
+     */
+    template <bool Interleaved>
+    audio_data<Interleaved> process(const audio_data<Interleaved>& input)
+    {
+        audio_data<Interleaved> output(channels, size_t(output_size_for_input(itype(input.size))));
+        process(output, input);
+        return output;
+    }
+};
+
+} // namespace kfr
@@ -80,12 +80,12 @@ public:
     template <univector_tag Tag>
     void apply(univector<T, Tag>& dest, const expression_handle<T, 1>& src)
     {
-        process_expression(dest.data(), src, size_min(dest.size(), src.size()));
+        process_expression(dest.data(), src, size_min(dest.size(), get_shape(src).front()));
     }
 
     void apply(T* dest, const expression_handle<T, 1>& src, size_t size)
     {
-        process_expression(dest, src, size_min(size, src.size()));
+        process_expression(dest, src, size_min(size, get_shape(src).front()));
     }
 
     template <univector_tag Tag, input_expression Expr>
@@ -98,7 +98,7 @@ public:
     template <input_expression Expr>
     void apply(T* dest, const Expr& src, size_t size)
     {
-        process_expression(dest, to_handle(src), size_min(size, src.size()));
+        process_expression(dest, to_handle(src), size_min(size, get_shape(src).front()));
     }
 
 protected:
@@ -635,11 +635,21 @@ KFR_API_SPEC void kfr_dct_delete_plan_f32(KFR_DCT_PLAN_F32* plan);
  */
 KFR_API_SPEC void kfr_dct_delete_plan_f64(KFR_DCT_PLAN_F64* plan);
 
+/// @brief Implementation of the FIR filter.
+typedef enum KFR_FIR_METHOD
+{
+    KFR_FIR_AUTOMATIC = 0, ///< Chosen by the cost model calibrated on this machine.
+    KFR_FIR_DIRECT    = 1, ///< Direct form.
+    KFR_FIR_FFT       = 2 ///< Partitioned FFT convolution.
+} KFR_FIR_METHOD;
+
 /**
  * @brief Create a FIR filter plan (Single precision).
  * @param taps Pointer to filter taps.
  * @param size Number of filter taps.
  * @return Pointer to the created FIR filter plan. Use `kfr_filter_delete_plan_f**` to free.
+ * @note The direct form or the FFT convolution is chosen automatically, the results are the same up to
+ * the floating point tolerance. Use `kfr_filter_create_fir_plan_method_f32` to force one of them.
  */
 KFR_API_SPEC KFR_FILTER_F32* kfr_filter_create_fir_plan_f32(const kfr_f32* taps, size_t size);
 
@@ -648,9 +658,33 @@ KFR_API_SPEC KFR_FILTER_F32* kfr_filter_create_fir_plan_f32(const kfr_f32* taps,
  * @param taps Pointer to filter taps.
  * @param size Number of filter taps.
  * @return Pointer to the created FIR filter plan. Use `kfr_filter_delete_plan_f**` to free.
+ * @note The direct form or the FFT convolution is chosen automatically, the results are the same up to
+ * the floating point tolerance. Use `kfr_filter_create_fir_plan_method_f64` to force one of them.
  */
 KFR_API_SPEC KFR_FILTER_F64* kfr_filter_create_fir_plan_f64(const kfr_f64* taps, size_t size);
 
+/**
+ * @brief Create a FIR filter plan with the given implementation (Single precision).
+ * @param taps Pointer to filter taps.
+ * @param size Number of filter taps.
+ * @param call_size Expected number of samples per call to `kfr_filter_process_f32`, 0 if unknown.
+ * @param method Implementation of the filter.
+ * @return Pointer to the created FIR filter plan. Use `kfr_filter_delete_plan_f**` to free.
+ */
+KFR_API_SPEC KFR_FILTER_F32* kfr_filter_create_fir_plan_method_f32(const kfr_f32* taps, size_t size,
+                                                                   size_t call_size, KFR_FIR_METHOD method);
+
+/**
+ * @brief Create a FIR filter plan with the given implementation (Double precision).
+ * @param taps Pointer to filter taps.
+ * @param size Number of filter taps.
+ * @param call_size Expected number of samples per call to `kfr_filter_process_f64`, 0 if unknown.
+ * @param method Implementation of the filter.
+ * @return Pointer to the created FIR filter plan. Use `kfr_filter_delete_plan_f**` to free.
+ */
+KFR_API_SPEC KFR_FILTER_F64* kfr_filter_create_fir_plan_method_f64(const kfr_f64* taps, size_t size,
+                                                                   size_t call_size, KFR_FIR_METHOD method);
+
 /**
  * @brief Create a convolution filter plan (Single precision).
  * @param taps Pointer to filter taps.
@@ -24,9 +24,13 @@
 
 #include "base.hpp"
 
+#include "dft/analytic.hpp"
 #include "dft/cache.hpp"
 #include "dft/convolution.hpp"
 #include "dft/fft.hpp"
+#include "dft/fir_auto.hpp"
+#include "dft/minimum_phase.hpp"
+#include "dft/psd.hpp"
 #include "dft/reference_dft.hpp"
 
 namespace kfr
@@ -0,0 +1,218 @@
+/** @addtogroup dft
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#pragma once
+
+#include "../base/univector.hpp"
+#include "../dsp/fir_design.hpp"
+#include "../dsp/window.hpp"
+#include "../math/atan.hpp"
+#include "../simd/complex.hpp"
+#include "convolution.hpp"
+#include "fft.hpp"
+
+namespace kfr
+{
+
+/**
+ * @brief Computes the analytic signal x + j·H{x} of real blocks (same as scipy.signal.hilbert)
+ *
+ * The Hilbert transform is computed by the real DFT in both directions: the half spectrum is rotated by
+ * -90° (DC and Nyquist are zeroed) and transformed back to a real signal. Complex output is assembled in
+ * place in the output buffer, so no full-size complex buffer is ever allocated.
+ */
+template <typename T>
+struct analytic_plan
+{
+    size_t size;
+    size_t temp_size;
+
+    /// @param size Block size, must be even
+    explicit analytic_plan(size_t size)
+        : size(size), temp_size(0), dft(size, dft_pack_format::CCs),
+          spectrum_size(align_up((size / 2 + 1) * sizeof(complex<T>), 64))
+    {
+        temp_size = dft.temp_size + spectrum_size;
+    }
+
+    /// @brief Computes the analytic signal
+    /// @param out Output buffer of @c size complex values, must not overlap with @c in
+    void execute(complex<T>* out, const T* in, u8* temp) const
+    {
+        // Spectrum fits in the first half of the output
+        dft.execute(out, in, temp);
+        rotate(out);
+        T* im = ptr_cast<T>(out);
+        dft.execute(im, out, temp);
+        // Expand to interleaved complex from the end, im[i] is read before being overwritten
+        for (size_t i = size; i > 0; --i)
+        {
+            const T h  = im[i - 1];
+            out[i - 1] = complex<T>(in[i - 1], h);
+        }
+    }
+
+    /// @brief Computes the Hilbert transform (imaginary part of the analytic signal)
+    void hilbert(T* out, const T* in, u8* temp) const
+    {
+        complex<T>* spectrum = ptr_cast<complex<T>>(temp);
+        dft.execute(spectrum, in, temp + spectrum_size);
+        rotate(spectrum);
+        dft.execute(out, spectrum, temp + spectrum_size);
+    }
+
+    /// @brief Computes the envelope (magnitude of the analytic signal)
+    void envelope(T* out, const T* in, u8* temp) const
+    {
+        hilbert(out, in, temp);
+        make_univector(out, size) = sqrt(sqr(make_univector(in, size)) + sqr(make_univector(out, size)));
+    }
+
+    /// @brief Computes the instantaneous phase (argument of the analytic signal) in radians
+    void phase(T* out, const T* in, u8* temp) const
+    {
+        hilbert(out, in, temp);
+        make_univector(out, size) = atan2(make_univector(out, size), make_univector(in, size));
+    }
+
+    template <univector_tag Tag1, univector_tag Tag2>
+    void execute(univector<complex<T>, Tag1>& out, const univector<T, Tag2>& in) const
+    {
+        univector<u8> temp(temp_size);
+        execute(out.data(), in.data(), temp.data());
+    }
+    template <univector_tag Tag1, univector_tag Tag2>
+    void envelope(univector<T, Tag1>& out, const univector<T, Tag2>& in) const
+    {
+        univector<u8> temp(temp_size);
+        envelope(out.data(), in.data(), temp.data());
+    }
+    template <univector_tag Tag1, univector_tag Tag2>
+    void phase(univector<T, Tag1>& out, const univector<T, Tag2>& in) const
+    {
+        univector<u8> temp(temp_size);
+        phase(out.data(), in.data(), temp.data());
+    }
+
+private:
+    // X[k] *= -j for 0 < k < N/2, X[0] = X[N/2] = 0, scaled by 1/N for the inverse transform
+    void rotate(complex<T>* spectrum) const
+    {
+        spectrum[0]        = T(0);
+        spectrum[size / 2] = T(0);
+        if (size > 2)
+        {
+            univector_ref<complex<T>> s = make_univector(spectrum + 1, size / 2 - 1);
+            s                           = s * complex<T>(T(0), T(-1) / T(size));
+        }
+    }
+
+    dft_plan_real<T> dft;
+    size_t spectrum_size;
+};
+
+/**
+ * @brief Streaming analytic signal generator based on the FFT convolution
+ *
+ * Imaginary part is produced by the FIR Hilbert transformer (see fir_hilbert) applied through
+ * convolve_filter, real part is the input delayed by latency() samples to match the group delay.
+ * Preferred over hilbert_fir for long filters.
+ */
+template <typename T>
+class analytic_stream
+{
+public:
+    /// @param taps odd number of taps of the Hilbert transformer
+    /// @param block_size block size of the partitioned convolution
+    analytic_stream(size_t taps, size_t block_size = 1024)
+        : convolution(design(taps), block_size), delay(taps / 2), scratch(convolution.input_block_size())
+    {
+        reset();
+    }
+
+    /// Group delay in samples
+    size_t latency() const { return delay.size(); }
+
+    void reset()
+    {
+        convolution.reset();
+        process(delay, zeros());
+        cursor = 0;
+    }
+
+    /// @brief Computes the analytic signal
+    void apply(complex<T>* out, const T* in, size_t size)
+    {
+        run(in, size, [out](size_t i, T re, T im) { out[i] = complex<T>(re, im); });
+    }
+
+    /// @brief Computes the envelope (magnitude of the analytic signal)
+    void envelope(T* out, const T* in, size_t size)
+    {
+        run(in, size, [out](size_t i, T re, T im) { out[i] = std::sqrt(re * re + im * im); });
+    }
+
+    /// @brief Computes the instantaneous phase (argument of the analytic signal) in radians
+    void phase(T* out, const T* in, size_t size)
+    {
+        run(in, size, [out](size_t i, T re, T im) { out[i] = atan2(im, re); });
+    }
+
+private:
+    static univector<T> design(size_t taps)
+    {
+        univector<T> result(taps);
+        fir_hilbert(result, to_handle(window_kaiser<T>(taps, T(8))));
+        return result;
+    }
+
+    template <typename Fn>
+    void run(const T* in, size_t size, Fn&& fn)
+    {
+        for (size_t offset = 0; offset < size;)
+        {
+            const size_t count = std::min(scratch.size(), size - offset);
+            convolution.apply(scratch.data(), in + offset, count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                T re = in[offset + i];
+                if (!delay.empty())
+                {
+                    std::swap(re, delay[cursor]);
+                    cursor = cursor + 1 == delay.size() ? 0 : cursor + 1;
+                }
+                fn(offset + i, re, scratch[i]);
+            }
+            offset += count;
+        }
+    }
+
+    convolve_filter<T> convolution;
+    univector<T> delay;
+    univector<T> scratch;
+    size_t cursor;
+};
+
+} // namespace kfr
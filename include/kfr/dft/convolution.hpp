@@ -34,6 +34,7 @@
 
 #include "cache.hpp"
 #include "fft.hpp"
+#include <algorithm>
 
 KFR_PRAGMA_GNU(GCC diagnostic push)
 #if KFR_HAS_WARNING("-Wshadow")
@@ -43,12 +44,22 @@ KFR_PRAGMA_GNU(GCC diagnostic ignored "-Wshadow")
 namespace kfr
 {
 
+/// @brief Frequency weighting of the cross-correlation
+enum class correlation_weighting
+{
+    none, ///< Plain cross-correlation
+    phat  ///< Phase transform (GCC-PHAT), cross-spectrum is normalized to unit magnitude
+};
+
 namespace internal_generic
 {
 template <typename T>
 univector<T> convolve(const univector_ref<const T>& src1, const univector_ref<const T>& src2,
                       bool correlate = false);
-}
+template <typename T>
+univector<T> correlate(const univector_ref<const T>& src1, const univector_ref<const T>& src2, size_t maxlag,
+                       correlation_weighting weighting);
+} // namespace internal_generic
 
 /// @brief Convolution
 template <typename T1, typename T2, univector_tag Tag1, univector_tag Tag2>
@@ -66,6 +77,58 @@ univector<std::remove_const_t<T1>> correlate(const univector<T1, Tag1>& src1, co
     return internal_generic::convolve(src1.slice(), src2.slice(), true);
 }
 
+/**
+ * @brief Cross-correlation restricted to lags from -maxlag to maxlag
+ * @return 2 * maxlag + 1 values, element maxlag corresponds to zero lag. Same as the middle part of
+ * correlate(src1, src2) if weighting is none
+ * @note Small lag windows are computed by direct dot products, larger ones by FFT blocks sized to
+ * the lag window, so memory usage doesn't depend on the signal length. GCC-PHAT weighting always uses
+ * the FFT path and is applied to the accumulated cross-spectrum.
+ */
+template <typename T1, typename T2, univector_tag Tag1, univector_tag Tag2>
+    requires(std::is_same_v<std::remove_const_t<T1>, std::remove_const_t<T2>>)
+univector<std::remove_const_t<T1>> correlate(const univector<T1, Tag1>& src1, const univector<T2, Tag2>& src2,
+                                             size_t maxlag,
+                                             correlation_weighting weighting = correlation_weighting::none)
+{
+    return internal_generic::correlate(src1.slice(), src2.slice(), maxlag, weighting);
+}
+
+/// @brief Position and height of the correlation peak
+template <typename T>
+struct correlation_peak
+{
+    T lag;   ///< Lag with sub-sample precision
+    T value; ///< Interpolated peak value
+};
+
+/**
+ * @brief Finds the maximum of the result of lag-limited correlate() and refines it by parabolic
+ * interpolation
+ */
+template <typename T, univector_tag Tag>
+correlation_peak<T> find_correlation_peak(const univector<T, Tag>& corr)
+{
+    KFR_LOGIC_CHECK(!corr.empty(), "find_correlation_peak: empty input");
+    const size_t maxlag = corr.size() / 2;
+    const size_t index  = std::max_element(corr.begin(), corr.end()) - corr.begin();
+    correlation_peak<T> result{ static_cast<T>(index) - static_cast<T>(maxlag), corr[index] };
+    if (index > 0 && index + 1 < corr.size())
+    {
+        const T ym    = corr[index - 1];
+        const T y0    = corr[index];
+        const T yp    = corr[index + 1];
+        const T denom = ym - 2 * y0 + yp;
+        if (denom < 0)
+        {
+            const T delta = T(0.5) * (ym - yp) / denom;
+            result.lag += delta;
+            result.value = y0 - T(0.25) * (ym - yp) * delta;
+        }
+    }
+    return result;
+}
+
 /// @brief Auto-correlation
 template <typename T, univector_tag Tag1>
 univector<std::remove_const_t<T>> autocorrelate(const univector<T, Tag1>& src)
@@ -100,13 +163,23 @@ template <typename T>
 class convolve_filter : public filter<T>
 {
 public:
-    explicit convolve_filter(size_t size, size_t block_size = 1024);
-    explicit convolve_filter(const univector_ref<const T>& data, size_t block_size = 1024);
+    /// @param progressive If true, the multiplication of the input history with the filter blocks for
+    /// the next block is spread over the calls that fill the current block instead of being done at once
+    /// at the block boundary. The output is the same, but the per-call cost becomes more uniform.
+    explicit convolve_filter(size_t size, size_t block_size = 1024, bool progressive = false);
+    explicit convolve_filter(const univector_ref<const T>& data, size_t block_size = 1024,
+                             bool progressive = false);
     void set_data(const univector_ref<const T>& data);
     void reset() final;
     /// Apply filter to multiples of returned block size for optimal processing efficiency.
     size_t input_block_size() const { return block_size; }
 
+    /// @brief Advances the background work of the progressive mode within the given time budget.
+    /// May be called between `apply` calls (for example, when the audio thread has spare time) to
+    /// reduce the work done inside the next `apply`. Does nothing if progressive mode is disabled.
+    /// @return `true` if there is more work to do for the current block.
+    bool progressive_step_for(std::chrono::nanoseconds budget);
+
 protected:
     void process_expression(T* dest, const expression_handle<T>& src, size_t size) final
     {
@@ -145,6 +218,14 @@ protected:
     univector<T> scratch1, scratch2;
     // Overlap saved from previous block to add into current block.
     univector<T> overlap;
+    // Whether progressive mode is enabled.
+    const bool progressive;
+    // Products of older input history (2 or more blocks back) and filter blocks for the next block.
+    univector<complex<ST>> premul_next;
+    // Number of products accumulated into premul_next.
+    size_t premul_next_count;
+    // Measured time of one multiply-accumulate, used to schedule progressive_step_for.
+    std::chrono::nanoseconds premul_cost;
 };
 
 } // namespace kfr
@@ -33,7 +33,9 @@
 #include "../simd/complex.hpp"
 #include "../simd/constants.hpp"
 #include <bitset>
+#include <chrono>
 #include <functional>
+#include <memory>
 
 KFR_PRAGMA_GNU(GCC diagnostic push)
 #if KFR_HAS_WARNING("-Wshadow")
@@ -71,6 +73,11 @@ struct dft_stage
     bool recursion    = false;
     bool can_inplace  = true;
     bool need_reorder = true;
+    /// Stages with equal id, shared_data_key and data_size have equal data that may be shared between plans.
+    /// Null if the data depends on anything else
+    const char* shared_data_id = nullptr;
+    /// Parameter the shared data depends on besides the id, e.g. the stage size
+    size_t shared_data_key = 0;
 
     void initialize(size_t size) { do_initialize(size); }
 
@@ -168,6 +175,38 @@ void dft_progressive_start(const dft_plan<T>& plan, typename dft_plan<T>::progre
 template <typename T>
 void dft_progressive_step(const dft_plan<T>& plan, typename dft_plan<T>::progressive& progressive);
 
+/// @brief Returns stage data shared between all plans (ref-counted, released with the last plan using it).
+/// @p init is called to fill the data if it does not exist yet
+template <typename T>
+std::shared_ptr<u8> dft_shared_stage_data(const char* id, size_t key, size_t data_size,
+                                          const std::function<void(u8*)>& init);
+
+/// @brief Runs `step` while the estimated cost of the next step fits into `budget`.
+/// `cost` returns the calibrated cost of the next step or zero if unknown. Unknown costs are assumed to
+/// be equal to the slowest step measured during this call. Returns `true` if more steps remain.
+template <typename StepFn, typename CostFn>
+bool progressive_run_for(std::chrono::nanoseconds budget, StepFn&& step, CostFn&& cost)
+{
+    using clock                       = std::chrono::steady_clock;
+    const clock::time_point start     = clock::now();
+    clock::time_point last            = start;
+    std::chrono::nanoseconds slowest  = std::chrono::nanoseconds(0);
+    std::chrono::nanoseconds estimate = cost();
+    for (;;)
+    {
+        if (estimate.count() == 0)
+            estimate = slowest;
+        if (last - start + estimate > budget)
+            return true;
+        if (!step())
+            return false;
+        const clock::time_point now = clock::now();
+        slowest  = std::max(slowest, std::chrono::duration_cast<std::chrono::nanoseconds>(now - last));
+        last     = now;
+        estimate = cost();
+    }
+}
+
 } // namespace internal_generic
 
 /**
@@ -371,6 +410,7 @@ struct dft_plan
 
     autofree<u8> data; /**< Internal data. */
     size_t data_size; /**< Internal data size. */
+    std::vector<std::shared_ptr<u8>> shared_data; /**< Stage data shared with other plans. */
 
     std::vector<dft_stage_ptr<T>> all_stages; /**< Internal data. */
     std::array<std::vector<dft_stage<T>*>, 2> stages; /**< Internal data. */
@@ -438,6 +478,42 @@ struct dft_plan
         return ++progressive.step < stages[progressive.inverse].size();
     }
 
+    /**
+     * @brief Steps the progressive execution of the DFT within the given time budget.
+     *
+     * Executes steps while the estimated cost of the next step fits into the remaining budget.
+     * Estimates come from `progressive_calibrate`; without calibration, the slowest step executed
+     * during this call is used, so at least one step is always executed.
+     * @param progressive A `progressive` structure returned by `progressive_start`.
+     * @param budget Time available for this call.
+     * @return `true` if there are more steps to execute, `false` if the DFT is complete.
+     */
+    bool progressive_step_for(progressive& progressive, std::chrono::nanoseconds budget) const
+    {
+        if (progressive.step >= stages[progressive.inverse].size())
+            return false;
+        return internal_generic::progressive_run_for(
+            budget, [&]() { return progressive_step(progressive); },
+            [&]() { return progressive_step_cost(progressive.inverse, progressive.step); });
+    }
+
+    /**
+     * @brief Measures the execution time of each progressive step and stores it for
+     * `progressive_step_for`.
+     * @param iterations Number of measurements per step. The fastest one is kept.
+     */
+    void progressive_calibrate(size_t iterations = 4);
+
+    /// @brief Returns the calibrated cost of the given progressive step or zero if not calibrated.
+    std::chrono::nanoseconds progressive_step_cost(bool inverse, size_t step) const
+    {
+        const auto& costs = progressive_cost[inverse];
+        return step < costs.size() ? costs[step] : std::chrono::nanoseconds(0);
+    }
+
+    /// Calibrated execution time for each progressive step, see `progressive_calibrate`.
+    std::array<std::vector<std::chrono::nanoseconds>, 2> progressive_cost;
+
 protected:
     struct noinit
     {
@@ -627,7 +703,183 @@ struct dft_plan_md
         execute_dft(cbool<inverse>, out, in, temp);
     }
 
+    /** Internal data structure for progressive execution of the multidimensional DFT.
+        Do not access the members directly as they may change in future versions.
+     */
+    struct progressive
+    {
+        bool inverse;
+        complex<T>* out;
+        const complex<T>* in;
+        u8* temp;
+        shape<Dims> sh;
+        index_t pass = 0;
+        index_t row  = 0;
+        size_t step  = 0;
+    };
+
+    /// @brief Returns the number of steps for progressive execution of the DFT.
+    /// Each step is either a single 1D DFT along one axis or a transposition between axes.
+    size_t progressive_total_steps() const
+    {
+        size_t steps = 0;
+        for (index_t axis = 0; axis < size.dims(); ++axis)
+            steps += pass_rows(axis) + 1;
+        return steps;
+    }
+
+    /**
+     * @brief Initiates the progressive execution of the DFT.
+     * @param inverse If true, applies the inverse DFT.
+     * @param out Pointer to the output data.
+     * @param in Pointer to the input data.
+     * @param temp Temporary (scratch) buffer. A scratch buffer of size `temp_size` must be provided.
+     * @return A `progressive` structure that can be used with `progressive_step`.
+     * @note `in` must stay unchanged until the first axis has been processed.
+     */
+    progressive progressive_start(bool inverse, complex<T>* out, const complex<T>* in, u8* temp) const
+    {
+        KFR_LOGIC_CHECK(is_initialized(), "dft_plan_md is not initialized");
+        KFR_LOGIC_CHECK(temp_size == 0 || temp != nullptr,
+                        "Temporary buffer must be provided for progressive execution");
+        progressive result{ inverse, out, in, temp, size };
+        return result;
+    }
+
+    /**
+     * @brief Steps the progressive execution of the DFT.
+     * @param progressive A `progressive` structure returned by `progressive_start`.
+     * @return `true` if there are more steps to execute, `false` if the DFT is complete.
+     */
+    bool progressive_step(progressive& progressive) const
+    {
+        if (progressive.inverse)
+            progressive_step_dim(ctrue, progressive);
+        else
+            progressive_step_dim(cfalse, progressive);
+        return ++progressive.step < progressive_total_steps();
+    }
+
+    /**
+     * @brief Steps the progressive execution of the DFT within the given time budget.
+     * See `dft_plan::progressive_step_for`.
+     */
+    bool progressive_step_for(progressive& progressive, std::chrono::nanoseconds budget) const
+    {
+        if (progressive.step >= progressive_total_steps())
+            return false;
+        return internal_generic::progressive_run_for(
+            budget, [&]() { return progressive_step(progressive); },
+            [&]() { return progressive_step_cost(progressive); });
+    }
+
+    /**
+     * @brief Measures the average execution time of 1D DFTs and transpositions for each axis and
+     * stores it for `progressive_step_for`.
+     */
+    void progressive_calibrate(size_t iterations = 2)
+    {
+        using clock = std::chrono::steady_clock;
+        if (!is_initialized())
+            return;
+        univector<complex<T>> buffer(size.product(), complex<T>(0));
+        univector<u8> temp(temp_size);
+        for (bool inverse : { false, true })
+        {
+            std::vector<std::chrono::nanoseconds> total(size.dims() * 2, std::chrono::nanoseconds(0));
+            std::vector<size_t> count(size.dims() * 2, 0);
+            for (size_t iter = 0; iter < std::max(iterations, size_t(1)); ++iter)
+            {
+                progressive prog = progressive_start(inverse, buffer.data(), buffer.data(), temp.data());
+                bool more;
+                do
+                {
+                    const size_t index            = progressive_step_kind(prog);
+                    const clock::time_point start = clock::now();
+                    more                          = progressive_step(prog);
+                    total[index] += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+                    ++count[index];
+                } while (more);
+            }
+            progressive_cost[inverse].resize(total.size());
+            for (size_t i = 0; i < total.size(); ++i)
+                progressive_cost[inverse][i] = count[i] ? total[i] / static_cast<std::chrono::nanoseconds::rep>(count[i])
+                                                         : std::chrono::nanoseconds(0);
+        }
+    }
+
+    /// Calibrated execution time of a 1D DFT (even indices) and a transposition (odd indices) per axis.
+    std::array<std::vector<std::chrono::nanoseconds>, 2> progressive_cost;
+
 private:
+    index_t pass_rows(index_t axis) const { return size[axis] > 1 ? size.product() / size[axis] : 0; }
+
+    size_t progressive_step_kind(const progressive& progressive) const
+    {
+        if (progressive.inverse)
+            return progressive.pass * 2 + (progressive.row == 0 ? 1 : 0);
+        const index_t axis = size.dims() - 1 - progressive.pass;
+        return axis * 2 + (progressive.row < pass_rows(axis) ? 0 : 1);
+    }
+
+    std::chrono::nanoseconds progressive_step_cost(const progressive& progressive) const
+    {
+        const auto& costs = progressive_cost[progressive.inverse];
+        if (progressive.pass >= size.dims())
+            return std::chrono::nanoseconds(0);
+        const size_t index = progressive_step_kind(progressive);
+        return index < costs.size() ? costs[index] : std::chrono::nanoseconds(0);
+    }
+
+    void progressive_step_dim(cfalse_t, progressive& p) const
+    {
+        const index_t axis       = size.dims() - 1 - p.pass;
+        const index_t rows       = pass_rows(axis);
+        const complex<T>* cur_in = p.pass == 0 ? p.in : p.out;
+        if (p.row < rows)
+        {
+            const index_t o = p.row * size[axis];
+            dfts[axis].execute(p.out + o, cur_in + o, p.temp, cfalse);
+            ++p.row;
+            return;
+        }
+        if (rows == 0 && cur_in != p.out)
+            builtin_memcpy(p.out, cur_in, sizeof(complex<T>) * size.product());
+        if (size.dims() > 1)
+            transpose(p.out, p.out, shape{ p.sh.remove_back().product(), p.sh.back() });
+        p.sh  = p.sh.rotate_right();
+        p.row = 0;
+        ++p.pass;
+    }
+    void progressive_step_dim(ctrue_t, progressive& p) const
+    {
+        const index_t axis = p.pass;
+        const index_t rows = pass_rows(axis);
+        if (p.row == 0)
+        {
+            const complex<T>* cur_in = p.pass == 0 ? p.in : p.out;
+            if (size.dims() > 1)
+                transpose(p.out, cur_in, shape{ p.sh.front(), p.sh.remove_front().product() });
+            else if (cur_in != p.out)
+                builtin_memcpy(p.out, cur_in, sizeof(complex<T>) * size.product());
+        }
+        else
+        {
+            const index_t o = (p.row - 1) * size[axis];
+            dfts[axis].execute(p.out + o, p.out + o, p.temp, ctrue);
+        }
+        if (p.row == rows)
+        {
+            p.sh  = p.sh.rotate_left();
+            p.row = 0;
+            ++p.pass;
+        }
+        else
+        {
+            ++p.row;
+        }
+    }
+
     template <bool inverse>
     KFR_INTRINSIC void execute_dft(cbool_t<inverse>, complex<T>* out, const complex<T>* in, u8* temp) const
     {
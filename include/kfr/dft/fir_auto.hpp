@@ -0,0 +1,211 @@
+/** @addtogroup dft
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#pragma once
+
+#include "../base/filter.hpp"
+#include "../base/univector.hpp"
+#include "../dsp/fir.hpp"
+#include "../simd/complex.hpp"
+#include "convolution.hpp"
+#include "fft.hpp"
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+namespace kfr
+{
+
+/// @brief Implementation of the FIR filter
+enum class fir_method
+{
+    automatic, ///< Chosen by the cost model
+    direct,    ///< Direct form (fir_filter)
+    fft        ///< Partitioned FFT convolution (convolve_filter)
+};
+
+/**
+ * @brief Estimates the cost of the direct form and of the partitioned FFT convolution per output sample
+ *
+ * The direct form costs one multiply-accumulate per tap. The FFT convolution with the block B computes
+ * the forward and the inverse real DFT of size 2B and one spectrum product per call, and the products of
+ * the input history with the remaining ceil(taps / B) - 1 filter blocks once per block.
+ */
+template <typename T>
+struct fir_cost_model
+{
+    /// Time of one multiply-accumulate of the direct form, ns
+    double direct_mac = 0.1;
+    /// Time of a real DFT of size N divided by N·log2(N), ns
+    double fft_point = 0.15;
+    /// Time of the complex multiply-accumulate of one spectrum bin, ns
+    double spectrum_mac = 0.5;
+
+    /// @brief Returns the model measured on this machine (once per process)
+    static const fir_cost_model& calibrated()
+    {
+        static const fir_cost_model model = calibrate();
+        return model;
+    }
+
+    /// @brief Cost of the direct form per output sample, ns
+    double direct_cost(size_t taps) const { return direct_mac * taps; }
+
+    /// @brief Cost of the FFT convolution per output sample, ns
+    /// @param call_size expected number of samples per call, 0 if unknown (whole blocks are assumed)
+    double fft_cost(size_t taps, size_t block_size, size_t call_size) const
+    {
+        const size_t segments = (taps + block_size - 1) / block_size;
+        size_t calls          = 1;
+        if (call_size != 0 && call_size < block_size)
+            calls = (block_size + call_size - 1) / call_size;
+
+        const double n        = 2.0 * block_size;
+        const double bins     = block_size + 1;
+        const double per_call = 2 * fft_point * n * std::log2(n) + spectrum_mac * bins;
+        return (calls * per_call + (segments - 1) * spectrum_mac * bins) / block_size;
+    }
+
+    /// @brief Power of two block size with the lowest cost of the FFT convolution
+    size_t best_block_size(size_t taps, size_t call_size) const
+    {
+        size_t best = 32;
+        for (size_t block = 64; block <= std::max(next_poweroftwo(taps), size_t(64)); block *= 2)
+        {
+            if (fft_cost(taps, block, call_size) < fft_cost(taps, best, call_size))
+                best = block;
+        }
+        return best;
+    }
+
+    /// @brief Chooses the implementation for the filter
+    fir_method select(size_t taps, size_t call_size) const
+    {
+        return direct_cost(taps) <= fft_cost(taps, best_block_size(taps, call_size), call_size)
+                   ? fir_method::direct
+                   : fir_method::fft;
+    }
+
+private:
+    template <typename Fn>
+    static double measure(Fn&& fn)
+    {
+        using clock = std::chrono::steady_clock;
+        fn();
+        size_t count                  = 0;
+        const clock::time_point start = clock::now();
+        clock::duration elapsed;
+        do
+        {
+            fn();
+            ++count;
+            elapsed = clock::now() - start;
+        } while (elapsed < std::chrono::microseconds(500));
+        return std::chrono::duration<double, std::nano>(elapsed).count() / count;
+    }
+
+    static fir_cost_model calibrate()
+    {
+        constexpr size_t taps = 128;
+        constexpr size_t size = 2048;
+        fir_cost_model model;
+
+        univector<T> x = truncate(counter(T(0), T(1) / size), size);
+        univector<T> y(size);
+        fir_filter<T> direct(fir_params<T>(univector<T>(taps, T(1) / taps)));
+        model.direct_mac = measure([&]() { direct.apply(y.data(), x.data(), size); }) / (size * taps);
+
+        const dft_plan_real_ptr<T> dft = dft_cache::instance().getreal(ctype_t<T>(), size);
+        univector<complex<T>> spectrum(size / 2 + 1);
+        univector<u8> temp(dft->temp_size);
+        model.fft_point = measure([&]() { dft->execute(spectrum, x, temp); }) / (size * std::log2(size));
+
+        univector<complex<T>> accum(spectrum.size(), complex<T>(0));
+        model.spectrum_mac = measure([&]() { accum = accum + spectrum * spectrum; }) / spectrum.size();
+        return model;
+    }
+};
+
+/**
+ * @brief FIR filter that chooses between the direct form and the partitioned FFT convolution
+ *
+ * The choice is made once, in the constructor, from the number of taps and the expected number of samples
+ * per call using the cost model (calibrated on this machine unless passed explicitly), or forced by
+ * @p method. Both implementations produce the same output up to the rounding errors and have no latency.
+ * @note Uses both kfr_dsp (fir_filter) and kfr_dft (convolve_filter)
+ */
+template <typename T>
+class fir_auto_filter : public filter<T>
+{
+public:
+    /// @param taps filter coefficients
+    /// @param call_size expected number of samples per call to apply, 0 if unknown
+    /// @param method implementation, automatic by default
+    explicit fir_auto_filter(const univector_ref<const T>& taps, size_t call_size = 0,
+                             fir_method method = fir_method::automatic)
+        : fir_auto_filter(taps, call_size, method,
+                          method == fir_method::automatic ? fir_cost_model<T>::calibrated()
+                                                          : fir_cost_model<T>())
+    {
+    }
+
+    fir_auto_filter(const univector_ref<const T>& taps, size_t call_size, fir_method method,
+                    const fir_cost_model<T>& model)
+        : used_method(method), block_size(0)
+    {
+        if (used_method == fir_method::automatic)
+            used_method = model.select(taps.size(), call_size);
+        if (used_method == fir_method::fft)
+        {
+            block_size = model.best_block_size(taps.size(), call_size);
+            engine     = std::make_unique<convolve_filter<T>>(taps, block_size);
+        }
+        else
+        {
+            engine = std::make_unique<fir_filter<T>>(fir_params<T>(taps.data(), taps.size()));
+        }
+    }
+
+    /// Implementation in use, either direct or fft
+    fir_method method() const { return used_method; }
+
+    /// Block size of the FFT convolution, 0 for the direct form
+    size_t fft_block_size() const { return block_size; }
+
+    void reset() final { engine->reset(); }
+
+protected:
+    void process_buffer(T* dest, const T* src, size_t size) final { engine->apply(dest, src, size); }
+    void process_expression(T* dest, const expression_handle<T, 1>& src, size_t size) final
+    {
+        engine->apply(dest, src, size);
+    }
+
+    fir_method used_method;
+    size_t block_size;
+    std::unique_ptr<filter<T>> engine;
+};
+
+} // namespace kfr
@@ -0,0 +1,110 @@
+/** @addtogroup dft
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#pragma once
+
+#include "../base/univector.hpp"
+#include "../simd/complex.hpp"
+#include "fft.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace kfr
+{
+
+/**
+ * @brief Converts the FIR filter to the minimum phase one using the homomorphic (cepstrum) method (same as
+ * scipy.signal.minimum_phase with method='homomorphic')
+ *
+ * The log magnitude of the spectrum is transformed to the real cepstrum, which is folded onto the positive
+ * quefrencies and transformed back and exponentiated. Resulting filter has the magnitude response of
+ * @p taps with the energy concentrated at the start, so the group delay is much lower than (size - 1) / 2
+ * of the linear phase filter.
+ *
+ * @param taps filter coefficients, usually a linear phase filter
+ * @param half if true, the result has (size + 1) / 2 taps and the magnitude response is the square root of
+ * the original one. Use it for a linear phase filter designed for the squared magnitude (e.g. with the
+ * doubled attenuation in dB), the default of scipy
+ * @param fft_size DFT size, must be even and at least 2·size. By default the power of two not less than
+ * 200·(size - 1) is used, which keeps the aliasing of the cepstrum below 1%
+ * @note 1e-7 of the smallest nonzero magnitude is added to the magnitude of every bin before the logarithm,
+ * so the logarithm stays finite. Zeros of the magnitude response end up about 140 dB below the smallest
+ * nonzero magnitude, which limits the stopband attenuation of the result, and the nonzero bins change by a
+ * relative amount of at most 1e-7
+ */
+template <typename T>
+univector<T> minimum_phase(const univector_ref<const T>& taps, bool half = false, size_t fft_size = 0)
+{
+    const size_t size = taps.size();
+    KFR_LOGIC_CHECK(size > 0, "minimum_phase: no taps");
+    if (fft_size == 0)
+        fft_size = next_poweroftwo(std::max(200 * (size - 1), size_t(2)));
+    KFR_LOGIC_CHECK(fft_size % 2 == 0 && fft_size >= 2 * size,
+                    "minimum_phase: fft_size must be even and at least twice the number of taps");
+
+    const dft_plan_real_ptr<T> dft = dft_cache::instance().getreal(ctype_t<T>(), fft_size);
+    univector<u8> temp(dft->temp_size);
+    univector<T> signal(fft_size, T(0));
+    univector<complex<T>> spectrum(fft_size / 2 + 1);
+    signal.slice(0, size) = taps;
+    dft->execute(spectrum, signal, temp);
+
+    // Log magnitude, halved to take the square root of the magnitude
+    T smallest = std::numeric_limits<T>::max();
+    for (const complex<T>& x : spectrum)
+    {
+        const T magnitude = std::abs(x);
+        if (magnitude > 0)
+            smallest = std::min(smallest, magnitude);
+    }
+    const T floor = smallest == std::numeric_limits<T>::max() ? T(1) : smallest * T(1e-7);
+    const T scale = half ? T(0.5) : T(1);
+    for (complex<T>& x : spectrum)
+        x = std::log(std::abs(x) + floor) * scale;
+
+    // Real cepstrum folded onto the positive quefrencies, 1/N of both inverse transforms is applied here
+    dft->execute(signal, spectrum, temp);
+    const T norm = T(1) / fft_size;
+    signal[0] *= norm;
+    signal.slice(1, fft_size / 2 - 1) = signal.slice(1, fft_size / 2 - 1) * (2 * norm);
+    signal[fft_size / 2] *= norm;
+    std::fill(signal.begin() + fft_size / 2 + 1, signal.end(), T(0));
+
+    dft->execute(spectrum, signal, temp);
+    for (complex<T>& x : spectrum)
+        x = std::exp(x) * norm;
+    dft->execute(signal, spectrum, temp);
+
+    return signal.slice(0, half ? (size + 1) / 2 : size);
+}
+
+template <typename T, univector_tag Tag>
+univector<T> minimum_phase(const univector<T, Tag>& taps, bool half = false, size_t fft_size = 0)
+{
+    return minimum_phase(taps.slice(), half, fft_size);
+}
+
+} // namespace kfr
@@ -0,0 +1,367 @@
+/** @addtogroup dft
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#pragma once
+
+#include "../base/reduce.hpp"
+#include "../base/univector.hpp"
+#include "../dsp/window.hpp"
+#include "../math/complex_math.hpp"
+#include "../simd/complex.hpp"
+#include "fft.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace kfr
+{
+
+/// @brief Averaging of the segment periodograms
+enum class psd_average
+{
+    mean,  ///< Welch (overlapping segments) or Bartlett (non-overlapping segments) method
+    median ///< Median of the periodograms with the bias correction, robust to transients
+};
+
+/// @brief Normalization of the result
+enum class psd_scaling
+{
+    density, ///< Power spectral density, units²/Hz
+    spectrum ///< Power spectrum, units²
+};
+
+namespace internal_generic
+{
+
+/// Splits a stream of one or more channels into overlapping windowed segments and computes their spectra
+template <typename T, size_t Channels>
+struct psd_segmenter
+{
+    psd_segmenter(size_t segment_size, size_t overlap, const expression_handle<T>& window_fn)
+        : size(segment_size), hop(segment_size - overlap), dft(segment_size, dft_pack_format::CCs),
+          window(segment_size), windowed(segment_size), temp(dft.temp_size), filled(0)
+    {
+        KFR_LOGIC_CHECK(overlap < segment_size, "psd_estimator: overlap must be less than segment size");
+        window = truncate(window_fn, size);
+        for (size_t c = 0; c < Channels; ++c)
+        {
+            pending[c].resize(size);
+            spectra[c].resize(size / 2 + 1);
+        }
+    }
+
+    size_t bins() const { return size / 2 + 1; }
+
+    void reset() { filled = 0; }
+
+    /// Calls fn() after the spectra of each complete segment are computed
+    template <typename Fn>
+    void push(const T* const (&in)[Channels], size_t count, Fn&& fn)
+    {
+        // Offset of the next segment in the concatenation of pending samples and input
+        size_t start = 0;
+        for (; start + size <= filled + count; start += hop)
+        {
+            for (size_t c = 0; c < Channels; ++c)
+            {
+                if (start >= filled)
+                {
+                    windowed = window * make_univector(in[c] + (start - filled), size);
+                }
+                else
+                {
+                    const size_t head       = filled - start;
+                    windowed.slice(0, head) = window.slice(0, head) * pending[c].slice(start, head);
+                    windowed.slice(head)    = window.slice(head) * make_univector(in[c], size - head);
+                }
+                dft.execute(spectra[c], windowed, temp);
+            }
+            fn();
+        }
+        for (size_t c = 0; c < Channels; ++c)
+        {
+            if (start >= filled)
+            {
+                pending[c].slice(0, filled + count - start) =
+                    make_univector(in[c] + (start - filled), filled + count - start);
+            }
+            else
+            {
+                std::copy(pending[c].begin() + start, pending[c].begin() + filled, pending[c].begin());
+                std::copy(in[c], in[c] + count, pending[c].begin() + (filled - start));
+            }
+        }
+        filled = filled + count - start;
+    }
+
+    /// Scale factors of the one-sided result
+    univector<T> scale(psd_scaling scaling, T samplerate) const
+    {
+        const T factor = scaling == psd_scaling::density ? T(1) / (samplerate * sumsqr(window))
+                                                         : T(1) / sqr(sum(window));
+        univector<T> result(bins(), 2 * factor);
+        result[0] = factor;
+        if (is_even(size))
+            result[size / 2] = factor;
+        return result;
+    }
+
+    const size_t size;
+    const size_t hop;
+    dft_plan_real<T> dft;
+    univector<T> window;
+    univector<T> windowed;
+    univector<u8> temp;
+    univector<T> pending[Channels];
+    univector<complex<T>> spectra[Channels];
+    size_t filled;
+};
+
+} // namespace internal_generic
+
+/**
+ * @brief Estimates power spectral density of a real signal by averaging periodograms of windowed segments
+ *
+ * Input may be pushed in blocks of any size, complete segments are processed directly from the input.
+ * The window is applied while the segment is copied to the FFT buffer and the squared magnitudes are
+ * accumulated right after the real FFT.
+ */
+template <typename T>
+class psd_estimator
+{
+public:
+    /// @param segment_size length of each segment (FFT size), must be even
+    /// @param overlap number of samples shared by adjacent segments
+    /// @param window window function
+    /// @param average averaging method
+    /// @param scaling normalization of the result
+    /// @param samplerate sample rate, used for the density scaling and frequencies()
+    /// @param median_segments number of the latest periodograms kept by psd_average::median. The median is
+    /// taken over them only, so the memory is bounded by median_segments · bins() values
+    psd_estimator(size_t segment_size, size_t overlap, const expression_handle<T>& window,
+                  psd_average average = psd_average::mean, psd_scaling scaling = psd_scaling::density,
+                  T samplerate = T(1), size_t median_segments = 256)
+        : seg(segment_size, overlap, window), average(average), scaling(scaling), samplerate(samplerate),
+          accum(seg.bins()), median_segments(median_segments), count(0)
+    {
+        KFR_LOGIC_CHECK(median_segments > 0, "psd_estimator: median_segments must be positive");
+        reset();
+    }
+
+    /// Welch method: Hann window, 50% overlap
+    static psd_estimator welch(size_t segment_size, T samplerate = T(1),
+                               psd_average average = psd_average::mean, size_t median_segments = 256)
+    {
+        return psd_estimator(segment_size, segment_size / 2, to_handle(window_hann<T>(segment_size)), average,
+                             psd_scaling::density, samplerate, median_segments);
+    }
+
+    /// Bartlett method: rectangular window, no overlap
+    static psd_estimator bartlett(size_t segment_size, T samplerate = T(1))
+    {
+        return psd_estimator(segment_size, 0, to_handle(window_rectangular<T>(segment_size)),
+                             psd_average::mean, psd_scaling::density, samplerate);
+    }
+
+    void reset()
+    {
+        seg.reset();
+        process(accum, zeros());
+        periodograms.clear();
+        count = 0;
+    }
+
+    /// @brief Adds samples to the estimate
+    void push(const T* in, size_t size)
+    {
+        const T* const inputs[1] = { in };
+        seg.push(inputs, size,
+                 [this]()
+                 {
+                     if (average == psd_average::mean)
+                     {
+                         accum = accum + cabssqr(seg.spectra[0]);
+                     }
+                     else
+                     {
+                         // Ring of the latest periodograms, the oldest one is overwritten when it is full
+                         const size_t slot = count % median_segments;
+                         if (slot == periodograms.size())
+                             periodograms.push_back(cabssqr(seg.spectra[0]));
+                         else
+                             periodograms[slot] = cabssqr(seg.spectra[0]);
+                     }
+                     ++count;
+                 });
+    }
+
+    template <univector_tag Tag>
+    void push(const univector<T, Tag>& in)
+    {
+        push(in.data(), in.size());
+    }
+
+    /// Number of segments pushed so far, the median uses at most median_segments of them
+    size_t segments() const { return count; }
+
+    /// Number of frequency bins of the one-sided result
+    size_t bins() const { return seg.bins(); }
+
+    /// @brief Frequencies of the bins
+    univector<T> frequencies() const { return truncate(counter(T(0), samplerate / seg.size), bins()); }
+
+    /// @brief Returns the normalized one-sided estimate
+    univector<T> result() const
+    {
+        univector<T> out = seg.scale(scaling, samplerate);
+        if (count == 0)
+        {
+            process(out, zeros());
+        }
+        else if (average == psd_average::mean)
+        {
+            out = out * accum * (T(1) / count);
+        }
+        else
+        {
+            // Bias of the median of chi-squared distributed values with 2 degrees of freedom
+            const size_t stored = periodograms.size();
+            T bias              = 1;
+            for (size_t k = 1; k <= (stored - 1) / 2; ++k)
+                bias += T(1) / (2 * k + 1) - T(1) / (2 * k);
+            std::vector<T> values(stored);
+            for (size_t i = 0; i < bins(); ++i)
+            {
+                for (size_t s = 0; s < stored; ++s)
+                    values[s] = periodograms[s][i];
+                out[i] *= median(values) / bias;
+            }
+        }
+        return out;
+    }
+
+private:
+    static T median(std::vector<T>& values)
+    {
+        const size_t mid = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + mid, values.end());
+        if (is_odd(values.size()))
+            return values[mid];
+        const T upper = values[mid];
+        return (*std::max_element(values.begin(), values.begin() + mid) + upper) / 2;
+    }
+
+    internal_generic::psd_segmenter<T, 1> seg;
+    psd_average average;
+    psd_scaling scaling;
+    T samplerate;
+    univector<T> accum;
+    std::vector<univector<T>> periodograms;
+    size_t median_segments;
+    size_t count;
+};
+
+/**
+ * @brief Estimates cross spectral density and coherence of a pair of real signals (Welch method)
+ */
+template <typename T>
+class csd_estimator
+{
+public:
+    /// @copydoc psd_estimator::psd_estimator
+    csd_estimator(size_t segment_size, size_t overlap, const expression_handle<T>& window,
+                  psd_scaling scaling = psd_scaling::density, T samplerate = T(1))
+        : seg(segment_size, overlap, window), scaling(scaling), samplerate(samplerate), accum_x(seg.bins()),
+          accum_y(seg.bins()), accum_xy(seg.bins()), count(0)
+    {
+        reset();
+    }
+
+    /// Welch method: Hann window, 50% overlap
+    static csd_estimator welch(size_t segment_size, T samplerate = T(1))
+    {
+        return csd_estimator(segment_size, segment_size / 2, to_handle(window_hann<T>(segment_size)),
+                             psd_scaling::density, samplerate);
+    }
+
+    void reset()
+    {
+        seg.reset();
+        process(accum_x, zeros());
+        process(accum_y, zeros());
+        process(accum_xy, zeros());
+        count = 0;
+    }
+
+    /// @brief Adds samples of both channels to the estimate
+    void push(const T* x, const T* y, size_t size)
+    {
+        const T* const inputs[2] = { x, y };
+        seg.push(inputs, size,
+                 [this]()
+                 {
+                     accum_x  = accum_x + cabssqr(seg.spectra[0]);
+                     accum_y  = accum_y + cabssqr(seg.spectra[1]);
+                     accum_xy = accum_xy + cconj(seg.spectra[0]) * seg.spectra[1];
+                     ++count;
+                 });
+    }
+
+    size_t segments() const { return count; }
+    size_t bins() const { return seg.bins(); }
+    univector<T> frequencies() const { return truncate(counter(T(0), samplerate / seg.size), bins()); }
+
+    /// @brief Returns the power spectral density of the first channel
+    univector<T> psd_x() const { return seg.scale(scaling, samplerate) * accum_x * norm(); }
+    /// @brief Returns the power spectral density of the second channel
+    univector<T> psd_y() const { return seg.scale(scaling, samplerate) * accum_y * norm(); }
+    /// @brief Returns the cross spectral density, conj(X)·Y
+    univector<complex<T>> csd() const { return seg.scale(scaling, samplerate) * accum_xy * norm(); }
+
+    /// @brief Returns the magnitude squared coherence, |Sxy|² / (Sxx·Syy), 0 for bins where either channel
+    /// has no power
+    univector<T> coherence() const
+    {
+        univector<T> out = cabssqr(accum_xy);
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            const T power = accum_x[i] * accum_y[i];
+            out[i]        = power > 0 ? out[i] / power : T(0);
+        }
+        return out;
+    }
+
+private:
+    T norm() const { return count ? T(1) / count : T(0); }
+
+    internal_generic::psd_segmenter<T, 2> seg;
+    psd_scaling scaling;
+    T samplerate;
+    univector<T> accum_x;
+    univector<T> accum_y;
+    univector<complex<T>> accum_xy;
+    size_t count;
+};
+
+} // namespace kfr
@@ -28,13 +28,16 @@
 #include "dsp/biquad.hpp"
 #include "dsp/dcremove.hpp"
 #include "dsp/delay.hpp"
+#include "dsp/dynamics.hpp"
 #include "dsp/ebu.hpp"
 #include "dsp/fir_design.hpp"
 #include "dsp/fir.hpp"
 #include "dsp/goertzel.hpp"
+#include "dsp/hilbert.hpp"
 #include "dsp/iir_design.hpp"
 #include "dsp/iir.hpp"
 #include "dsp/mixdown.hpp"
+#include "dsp/moving_stats.hpp"
 #include "dsp/oscillators.hpp"
 #include "dsp/sample_rate_conversion.hpp"
 #include "dsp/speaker.hpp"
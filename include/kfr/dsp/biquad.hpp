@@ -32,6 +32,8 @@
 #include "../base/state_holder.hpp"
 #include "../simd/vec.hpp"
 #include "../test/assert.hpp"
+#include <algorithm>
+#include <vector>
 
 namespace kfr
 {
@@ -190,6 +192,55 @@ iir_params(const std::vector<biquad_section<T>>&) -> iir_params<T, tag_dynamic_v
 template <typename T>
 iir_params(std::vector<biquad_section<T>>&&) -> iir_params<T, tag_dynamic_vector>;
 
+/**
+ * @brief Coefficients of many biquad sections stored as a structure of arrays, normalized to a0 = 1
+ *
+ * Doesn't own the memory. Coefficient k of the i-th section is k[i * stride]. a0 is null if the
+ * destination has no place for it, otherwise 1 is written there.
+ */
+template <typename T>
+struct biquad_soa
+{
+    T* a0;
+    T* a1;
+    T* a2;
+    T* b0;
+    T* b1;
+    T* b2;
+    size_t stride;
+
+    /// View of separate arrays, one per coefficient
+    constexpr biquad_soa(T* a1, T* a2, T* b0, T* b1, T* b2, size_t stride = 1) noexcept
+        : a0(nullptr), a1(a1), a2(a2), b0(b0), b1(b1), b2(b2), stride(stride)
+    {
+    }
+
+    /// View of an array of biquad_section
+    biquad_soa(biquad_section<T>* sections) noexcept
+        : a0(&sections->a0), a1(&sections->a1), a2(&sections->a2), b0(&sections->b0), b1(&sections->b1),
+          b2(&sections->b2), stride(sizeof(biquad_section<T>) / sizeof(T))
+    {
+    }
+
+    /// View of the sections of iir_params
+    biquad_soa(iir_params<T>& params) noexcept : biquad_soa(params.data()) {}
+
+    /// View of the sections of iir_params, one per lane
+    template <size_t filters>
+        requires(filters != tag_dynamic_vector)
+    biquad_soa(iir_params<T, filters>& params) noexcept
+        : biquad_soa(ptr_cast<T>(&params.a1), ptr_cast<T>(&params.a2), ptr_cast<T>(&params.b0),
+                     ptr_cast<T>(&params.b1), ptr_cast<T>(&params.b2))
+    {
+    }
+
+    biquad_section<T> operator[](size_t i) const noexcept
+    {
+        const size_t n = i * stride;
+        return { T(1), a1[n], a2[n], b0[n], b1[n], b2[n] };
+    }
+};
+
 template <typename T, size_t filters>
 struct iir_state
 {
@@ -442,5 +493,379 @@ class iir_filter : public expression_filter<T>
 {
 public:
     iir_filter(const iir_params<T>& params);
+
+    /**
+     * @brief Replaces the coefficients of the sections, keeping the state
+     *
+     * Doesn't allocate or lock, so it may be called from the audio thread between apply calls. The number
+     * of sections must not change. With a nonzero @p ramp the coefficients move linearly from the current
+     * ones to the new ones over @p ramp samples, updated every @p step samples (1 for every sample). The
+     * stability region of a biquad section in (a1, a2) is convex, so the sections stay stable during the
+     * ramp if both the current and the new ones are stable.
+     * @note Sections of a cascade are processed with a delay of one sample each, so the coefficients of
+     * the k-th section switch up to k samples earlier than the ones of the first section.
+     */
+    void set_params(const iir_params<T>& params, size_t ramp = 0, size_t step = 16)
+    {
+        KFR_LOGIC_CHECK(params.size() == target.size(), "iir_filter: number of sections must not change");
+        KFR_LOGIC_CHECK(step > 0, "iir_filter: step must be positive");
+        std::copy(params.begin(), params.end(), target.begin());
+        if (ramp == 0)
+        {
+            ramp_length = 0;
+            std::copy(target.begin(), target.end(), active.begin());
+            update(active.data());
+        }
+        else
+        {
+            std::copy(active.begin(), active.end(), start.begin());
+            ramp_length   = ramp;
+            ramp_position = 0;
+            ramp_step     = step;
+        }
+    }
+
+    /// Returns true while the coefficients are being ramped
+    bool ramping() const { return ramp_length != 0; }
+
+protected:
+    void process_buffer(T* dest, const T* src, size_t size) override
+    {
+        while (ramp_length != 0 && size > 0)
+        {
+            // Coefficients of each step are the ones at its end, steps don't depend on the call sizes
+            const size_t end   = std::min((ramp_position / ramp_step + 1) * ramp_step, ramp_length);
+            const size_t count = std::min(size, end - ramp_position);
+            const T t          = T(end) / T(ramp_length);
+            for (size_t i = 0; i < active.size(); ++i)
+            {
+                active[i].a1 = start[i].a1 + (target[i].a1 - start[i].a1) * t;
+                active[i].a2 = start[i].a2 + (target[i].a2 - start[i].a2) * t;
+                active[i].b0 = start[i].b0 + (target[i].b0 - start[i].b0) * t;
+                active[i].b1 = start[i].b1 + (target[i].b1 - start[i].b1) * t;
+                active[i].b2 = start[i].b2 + (target[i].b2 - start[i].b2) * t;
+            }
+            update(active.data());
+            ramp_position += count;
+            if (ramp_position == ramp_length)
+            {
+                std::copy(target.begin(), target.end(), active.begin());
+                ramp_length = 0;
+            }
+            expression_filter<T>::process_buffer(dest, src, count);
+            dest += count;
+            src += count;
+            size -= count;
+        }
+        if (size > 0)
+            expression_filter<T>::process_buffer(dest, src, size);
+    }
+    void process_expression(T* dest, const expression_handle<T, 1>& src, size_t size) override
+    {
+        if (ramp_length == 0)
+            return expression_filter<T>::process_expression(dest, src, size);
+        process(make_univector(dest, size), src, shape<1>(0), shape<1>(size));
+        process_buffer(dest, dest, size);
+    }
+
+    /// Writes the coefficients to the filter expression
+    void update(const biquad_section<T>* sections);
+
+    std::vector<biquad_section<T>> active; /**< Coefficients in use. */
+    std::vector<biquad_section<T>> start;  /**< Coefficients at the start of the ramp. */
+    std::vector<biquad_section<T>> target; /**< Coefficients at the end of the ramp. */
+    size_t ramp_length   = 0;
+    size_t ramp_position = 0;
+    size_t ramp_step     = 1;
 };
+
+/**
+ * @brief Cascade of biquad filters applied to many independent channels, one channel per SIMD lane
+ *
+ * biquad_process puts the sections of one cascade in the lanes, so one or two sections leave most of them
+ * idle. Here the lanes hold channels instead: each section runs over a block of frames for 4·width
+ * channels at once (or fewer if there are fewer channels), with the state in registers. All channels have
+ * the same number of sections, shorter cascades are padded with identity sections.
+ */
+template <typename T>
+class multichannel_biquad
+{
+public:
+    /// @param channels number of channels
+    /// @param params biquad sections shared by all channels
+    multichannel_biquad(size_t channels, const iir_params<T>& params)
+        : multichannel_biquad(std::vector<iir_params<T>>(channels, params))
+    {
+    }
+
+    /// @param params biquad sections of each channel
+    explicit multichannel_biquad(const std::vector<iir_params<T>>& params)
+        : channel_count(params.size()), section_count(0), lanes(lanes_for(params.size())),
+          padded((params.size() + lanes - 1) / lanes * lanes)
+    {
+        for (const iir_params<T>& p : params)
+            section_count = std::max(section_count, p.size());
+        // Lane c of each section: a1, a2, b0, b1, b2 of the channel c
+        coefs.resize(padded * section_count * 5);
+        state.resize(padded * section_count * 2);
+        block.resize(block_frames * lanes);
+        for (size_t c = 0; c < padded; ++c)
+        {
+            for (size_t s = 0; s < section_count; ++s)
+            {
+                const biquad_section<T> bq = c < channel_count && s < params[c].size()
+                                                 ? params[c][s].normalized_a0()
+                                                 : biquad_section<T>();
+                T* section = coefs.data() + (c / lanes * section_count + s) * 5 * lanes + c % lanes;
+                section[0 * lanes] = bq.a1;
+                section[1 * lanes] = bq.a2;
+                section[2 * lanes] = bq.b0;
+                section[3 * lanes] = bq.b1;
+                section[4 * lanes] = bq.b2;
+            }
+        }
+        reset();
+    }
+
+    /// Number of channels
+    size_t channels() const { return channel_count; }
+
+    /// Number of sections of each channel
+    size_t sections() const { return section_count; }
+
+    void reset() { std::fill(state.begin(), state.end(), T(0)); }
+
+    /// State of all sections, may be saved and restored later to continue from the same position
+    const univector<T>& get_state() const { return state; }
+
+    /// Restores the state returned by get_state of this or an identical filter
+    void set_state(const univector<T>& saved)
+    {
+        KFR_LOGIC_CHECK(saved.size() == state.size(), "multichannel_biquad: state size mismatch");
+        state = saved;
+    }
+
+    /// @brief Replaces the coefficients of one section of all channels, keeping the state
+    /// @param values coefficients for each channel, see the batch functions in biquad_design.hpp
+    void set_section(size_t section, const biquad_soa<T>& values)
+    {
+        KFR_LOGIC_CHECK(section < section_count, "multichannel_biquad: section index out of range");
+        for (size_t c = 0; c < channel_count; ++c)
+        {
+            const biquad_section<T> bq = values[c];
+            T* dest = coefs.data() + (c / lanes * section_count + section) * 5 * lanes + c % lanes;
+            dest[0 * lanes] = bq.a1;
+            dest[1 * lanes] = bq.a2;
+            dest[2 * lanes] = bq.b0;
+            dest[3 * lanes] = bq.b1;
+            dest[4 * lanes] = bq.b2;
+        }
+    }
+
+    /// @brief Filters planar channels, output may be the same as input
+    void process(T* const* output, const T* const* input, size_t frames);
+
+    /// @brief Filters interleaved channels, output may be the same as input
+    void process_interleaved(T* output, const T* input, size_t frames);
+
+protected:
+    constexpr static size_t block_frames = 64;
+
+    static size_t lanes_for(size_t channels)
+    {
+        constexpr size_t width = vector_width<T>;
+        return channels <= width ? width : channels <= 2 * width ? 2 * width : 4 * width;
+    }
+
+    size_t channel_count;
+    size_t section_count;
+    size_t lanes;       /**< Channels processed at once. */
+    size_t padded;      /**< Number of channels rounded up to lanes. */
+    univector<T> coefs; /**< Coefficients of each section for each group of lanes. */
+    univector<T> state; /**< s1 and s2 of each section for each group of lanes. */
+    univector<T> block; /**< Frames of one group of channels, lanes samples each. */
+};
+
+/**
+ * @brief Cascade of biquad filters computed in blocks of samples from the state-space form
+ *
+ * biquad_process and iir_filter compute one sample at a time, each output waits for the previous one. Here
+ * each section computes a block of N outputs at once as a product of the lower triangular Toeplitz matrix
+ * of its impulse response by the N inputs, plus the response to the state at the start of the block. The
+ * state at the end of the block is A^N times the state at the start plus a term that depends on the inputs
+ * only, so the only serial dependency left is two multiply-adds per block. Suited for long single-channel
+ * signals. The result matches iir_filter up to the rounding errors, which may be a few times larger for
+ * poles close to the unit circle because the precomputed matrices are rounded to T.
+ */
+template <typename T>
+class iir_block_filter : public filter<T>
+{
+public:
+    explicit iir_block_filter(const iir_params<T>& params)
+        : block(std::min(std::max(vector_width<T>, size_t(8)), size_t(16))), biquads(params.size())
+    {
+        const size_t stride = (block + 2) * block;
+        matrices.resize(params.size() * stride);
+        transitions.resize(params.size() * 4);
+        state.resize(params.size() * 2);
+        for (size_t i = 0; i < params.size(); ++i)
+        {
+            const biquad_section<double> bq = biquad_section<double>(params[i]).normalized_a0();
+            biquads[i]                      = bq;
+            // Runs the section for one block from the given state and input
+            auto run = [&](double s1, double s2, size_t impulse, T* out, T* end_state)
+            {
+                for (size_t n = 0; n < block; ++n)
+                {
+                    const double x = n == impulse ? 1.0 : 0.0;
+                    const double y = bq.b0 * x + s1;
+                    s1             = s2 + bq.b1 * x - bq.a1 * y;
+                    s2             = bq.b2 * x - bq.a2 * y;
+                    if (out)
+                        out[n] = static_cast<T>(y);
+                }
+                if (end_state)
+                {
+                    end_state[0] = static_cast<T>(s1);
+                    end_state[1] = static_cast<T>(s2);
+                }
+            };
+            T* m = matrices.data() + i * stride;
+            T* p = transitions.data() + i * 4;
+            T a[2], b[2];
+            run(1, 0, block, m, a);
+            run(0, 1, block, m + block, b);
+            // A^N, row-major
+            p[0] = a[0];
+            p[1] = b[0];
+            p[2] = a[1];
+            p[3] = b[1];
+            // Column j of the Toeplitz matrix is the impulse response delayed by j
+            for (size_t j = 0; j < block; ++j)
+                run(0, 0, j, m + (2 + j) * block, nullptr);
+        }
+        reset();
+    }
+
+    /// Number of sections
+    size_t sections() const { return biquads.size(); }
+
+    void reset() final { std::fill(state.begin(), state.end(), T(0)); }
+
+    /// State of the sections: s1 and s2 of each section (transposed direct form II)
+    const univector<T>& get_state() const { return state; }
+
+    /// Sets the state of the sections, see get_state
+    void set_state(const univector<T>& values)
+    {
+        KFR_LOGIC_CHECK(values.size() == state.size(), "iir_block_filter: state size mismatch");
+        state = values;
+    }
+
+protected:
+    void process_buffer(T* dest, const T* src, size_t size) final;
+    void process_expression(T* dest, const expression_handle<T, 1>& src, size_t size) final;
+
+    size_t block;                           /**< Number of samples computed at once. */
+    std::vector<biquad_section<T>> biquads; /**< Normalized sections. */
+    univector<T> matrices;    /**< Responses to s1, s2 and the Toeplitz matrix columns of each section. */
+    univector<T> transitions; /**< A^N of each section, row-major. */
+    univector<T> state;       /**< s1 and s2 of each section. */
+};
+
+/**
+ * @brief IIR filter in the parallel form: sum of the outputs of second-order sections applied to the same
+ * input plus the FIR direct term, see to_parallel_sos in iir_design.hpp
+ */
+template <typename T>
+struct parallel_sos
+{
+    iir_params<T> sections; /**< Sections with numerators of the first order (b2 = 0), a0 = 1. */
+    univector<T> direct;    /**< Coefficients of the FIR direct term. */
+};
+
+/**
+ * @brief Applies the IIR filter in the parallel form with all sections in SIMD lanes
+ *
+ * Sections of the parallel form don't depend on each other, so each sample costs a few vector operations
+ * for all sections at once and a horizontal sum, the serial dependency is one section long whatever the
+ * order of the filter. Sections are padded with zero sections to a power of two, at least 4.
+ */
+template <typename T>
+class parallel_sos_filter : public filter<T>
+{
+public:
+    explicit parallel_sos_filter(const parallel_sos<T>& params)
+        : lanes(std::max(next_poweroftwo(params.sections.size()), size_t(4))),
+          section_count(params.sections.size()), coefs(lanes * 5, T(0)), state(lanes * 2),
+          direct(params.direct.empty() ? univector<T>(1, T(0)) : params.direct),
+          buffer(direct.size() - 1 + chunk)
+    {
+        KFR_LOGIC_CHECK(section_count <= maximum_biquad_count, "parallel_sos_filter: too many sections");
+        for (size_t i = 0; i < section_count; ++i)
+        {
+            const biquad_section<T> bq = params.sections[i].normalized_a0();
+            coefs[0 * lanes + i]       = bq.a1;
+            coefs[1 * lanes + i]       = bq.a2;
+            coefs[2 * lanes + i]       = bq.b0;
+            coefs[3 * lanes + i]       = bq.b1;
+            coefs[4 * lanes + i]       = bq.b2;
+        }
+        reset();
+    }
+
+    /// Number of sections
+    size_t sections() const { return section_count; }
+
+    void reset() final
+    {
+        std::fill(state.begin(), state.end(), T(0));
+        std::fill(buffer.begin(), buffer.end(), T(0));
+    }
+
+protected:
+    void process_buffer(T* dest, const T* src, size_t size) final;
+    void process_expression(T* dest, const expression_handle<T, 1>& src, size_t size) final;
+
+    constexpr static size_t chunk = 1024;
+
+    size_t lanes;
+    size_t section_count;
+    univector<T> coefs;  /**< a1, a2, b0, b1, b2 of all sections, lanes values each. */
+    univector<T> state;  /**< s1 and s2 of all sections, lanes values each. */
+    univector<T> direct; /**< FIR direct term. */
+    univector<T> buffer; /**< Last direct.size() - 1 inputs followed by the current chunk of the input. */
+};
+
+/**
+ * @brief Applies the IIR filter to the array using several threads
+ *
+ * The array is split into chunks, one per thread. Each thread filters its chunk from the zero state
+ * (with iir_block_filter), then the states at the chunk boundaries are propagated serially: the state at
+ * the end of a chunk of L samples is A^L times the state at its start plus the final state of its zero-state
+ * response, A being the state transition matrix of the whole cascade. Finally each thread adds the response
+ * to the initial state of its chunk, which is computed only until it decays below the rounding errors.
+ * The result matches iir() up to the rounding errors.
+ * @param threads number of threads, 0 for std::thread::hardware_concurrency()
+ */
+template <typename T>
+void iir_parallel(T* data, size_t size, const iir_params<T>& params, size_t threads = 0);
+
+/**
+ * @brief Zero-phase filtering (same as filtfilt) with both passes computed by iir_parallel
+ */
+template <typename T>
+void filtfilt_parallel(T* data, size_t size, const iir_params<T>& params, size_t threads = 0);
+
+template <typename T, univector_tag Tag>
+void iir_parallel(univector<T, Tag>& arr, const iir_params<T>& params, size_t threads = 0)
+{
+    iir_parallel(arr.data(), arr.size(), params, threads);
+}
+
+template <typename T, univector_tag Tag>
+void filtfilt_parallel(univector<T, Tag>& arr, const iir_params<T>& params, size_t threads = 0)
+{
+    filtfilt_parallel(arr.data(), arr.size(), params, threads);
+}
 } // namespace kfr
@@ -25,6 +25,12 @@
  */
 #pragma once
 
+#include "../math/log_exp.hpp"
+#include "../math/sqrt.hpp"
+#include "../math/tan.hpp"
+#include "../simd/abs.hpp"
+#include "../simd/read_write.hpp"
+#include "../simd/select.hpp"
 #include "biquad.hpp"
 #include <cmath>
 
@@ -248,5 +254,245 @@ KFR_FUNCTION biquad_section<T> biquad_highshelf(std::type_identity_t<T> frequenc
     }
     return result;
 }
+
+namespace internal
+{
+/// Normalized coefficients of one section per lane
+template <typename V>
+struct biquad_lanes
+{
+    V a1;
+    V a2;
+    V b0;
+    V b1;
+    V b2;
+};
+
+/// Designs the sections vector_width<T> at a time, fn receives the function that loads their parameters
+template <typename T, typename Fn>
+KFR_INTRINSIC void biquad_batch(const biquad_soa<T>& out, size_t count, Fn&& fn)
+{
+    constexpr size_t N = vector_width<T>;
+    for (size_t i = 0; i < count; i += N)
+    {
+        const size_t n = std::min(N, count - i);
+        auto load      = [i, n](const T* values) -> vec<T, N>
+        {
+            if (n == N)
+                return read<N>(values + i);
+            // Missing lanes of the last vector repeat the last section
+            T buffer[N];
+            for (size_t j = 0; j < N; ++j)
+                buffer[j] = values[i + std::min(j, n - 1)];
+            return read<N>(buffer);
+        };
+        const biquad_lanes<vec<T, N>> r = fn(load);
+        if (out.stride == 1 && n == N)
+        {
+            write(out.a1 + i, r.a1);
+            write(out.a2 + i, r.a2);
+            write(out.b0 + i, r.b0);
+            write(out.b1 + i, r.b1);
+            write(out.b2 + i, r.b2);
+        }
+        else
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                const size_t k = (i + j) * out.stride;
+                out.a1[k]      = r.a1[j];
+                out.a2[k]      = r.a2[j];
+                out.b0[k]      = r.b0[j];
+                out.b1[k]      = r.b1[j];
+                out.b2[k]      = r.b2[j];
+            }
+        }
+        if (out.a0)
+        {
+            for (size_t j = 0; j < n; ++j)
+                out.a0[(i + j) * out.stride] = T(1);
+        }
+    }
+}
+} // namespace internal
+
+/**
+ * @brief Calculates coefficients for many low-pass biquad filters at once, same as biquad_lowpass
+ * @param out Destination of the coefficients, e.g. iir_params or separate arrays
+ * @param frequency Normalized frequency of each section
+ * @param Q Q factor of each section
+ * @param count Number of sections
+ */
+template <typename T>
+KFR_FUNCTION void biquad_lowpass(const biquad_soa<T>& out, const T* frequency, const T* Q, size_t count)
+{
+    internal::biquad_batch(out, count,
+                           [=](auto load)
+                           {
+                               const auto q    = load(Q);
+                               const auto K    = tan(c_pi<T, 1> * load(frequency));
+                               const auto K2   = K * K;
+                               const auto norm = 1 / (1 + K / q + K2);
+                               const auto a0   = K2 * norm;
+                               return internal::biquad_lanes{ 2 * (K2 - 1) * norm, (1 - K / q + K2) * norm,
+                                                              a0, 2 * a0, a0 };
+                           });
+}
+
+/**
+ * @brief Calculates coefficients for many high-pass biquad filters at once, same as biquad_highpass
+ * @copydetails biquad_lowpass(const biquad_soa<T>&, const T*, const T*, size_t)
+ */
+template <typename T>
+KFR_FUNCTION void biquad_highpass(const biquad_soa<T>& out, const T* frequency, const T* Q, size_t count)
+{
+    internal::biquad_batch(out, count,
+                           [=](auto load)
+                           {
+                               const auto q    = load(Q);
+                               const auto K    = tan(c_pi<T, 1> * load(frequency));
+                               const auto K2   = K * K;
+                               const auto norm = 1 / (1 + K / q + K2);
+                               return internal::biquad_lanes{ 2 * (K2 - 1) * norm, (1 - K / q + K2) * norm,
+                                                              norm, -2 * norm, norm };
+                           });
+}
+
+/**
+ * @brief Calculates coefficients for many band-pass biquad filters at once, same as biquad_bandpass
+ * @copydetails biquad_lowpass(const biquad_soa<T>&, const T*, const T*, size_t)
+ */
+template <typename T>
+KFR_FUNCTION void biquad_bandpass(const biquad_soa<T>& out, const T* frequency, const T* Q, size_t count)
+{
+    internal::biquad_batch(out, count,
+                           [=](auto load)
+                           {
+                               const auto q    = load(Q);
+                               const auto K    = tan(c_pi<T, 1> * load(frequency));
+                               const auto K2   = K * K;
+                               const auto norm = 1 / (1 + K / q + K2);
+                               const auto a0   = K / q * norm;
+                               return internal::biquad_lanes{ 2 * (K2 - 1) * norm, (1 - K / q + K2) * norm,
+                                                              a0, a0 * 0, -a0 };
+                           });
+}
+
+/**
+ * @brief Calculates coefficients for many notch biquad filters at once, same as biquad_notch
+ * @copydetails biquad_lowpass(const biquad_soa<T>&, const T*, const T*, size_t)
+ */
+template <typename T>
+KFR_FUNCTION void biquad_notch(const biquad_soa<T>& out, const T* frequency, const T* Q, size_t count)
+{
+    internal::biquad_batch(out, count,
+                           [=](auto load)
+                           {
+                               const auto q    = load(Q);
+                               const auto K    = tan(c_pi<T, 1> * load(frequency));
+                               const auto K2   = K * K;
+                               const auto norm = 1 / (1 + K / q + K2);
+                               const auto a0   = (1 + K2) * norm;
+                               const auto a1   = 2 * (K2 - 1) * norm;
+                               return internal::biquad_lanes{ a1, (1 - K / q + K2) * norm, a0, a1, a0 };
+                           });
+}
+
+/**
+ * @brief Calculates coefficients for many peak biquad filters at once, same as biquad_peak
+ * @param out Destination of the coefficients, e.g. iir_params or separate arrays
+ * @param frequency Normalized frequency of each section
+ * @param Q Q factor of each section
+ * @param gain Gain of each section in dB
+ * @param count Number of sections
+ */
+template <typename T>
+KFR_FUNCTION void biquad_peak(const biquad_soa<T>& out, const T* frequency, const T* Q, const T* gain,
+                              size_t count)
+{
+    internal::biquad_batch(out, count,
+                           [=](auto load)
+                           {
+                               const auto q     = load(Q);
+                               const auto g     = load(gain);
+                               const auto K     = tan(c_pi<T, 1> * load(frequency));
+                               const auto K2    = K * K;
+                               const auto V     = exp(abs(g) * T(1.0 / 20.0) * c_log_10<T>);
+                               const auto boost = g >= 0;
+                               // Boost and cut differ by the swapped V / Q and 1 / Q terms
+                               const auto zero  = select(boost, V, T(1)) / q * K;
+                               const auto pole  = select(boost, T(1), V) / q * K;
+                               const auto norm  = 1 / (1 + pole + K2);
+                               const auto a1    = 2 * (K2 - 1) * norm;
+                               const auto a2    = (1 - pole + K2) * norm;
+                               return internal::biquad_lanes{ a1, a2, (1 + zero + K2) * norm, a1,
+                                                              (1 - zero + K2) * norm };
+                           });
+}
+
+/**
+ * @brief Calculates coefficients for many low-shelf biquad filters at once, same as biquad_lowshelf
+ * @param out Destination of the coefficients, e.g. iir_params or separate arrays
+ * @param frequency Normalized frequency of each section
+ * @param gain Gain of each section in dB
+ * @param count Number of sections
+ */
+template <typename T>
+KFR_FUNCTION void biquad_lowshelf(const biquad_soa<T>& out, const T* frequency, const T* gain, size_t count)
+{
+    internal::biquad_batch(out, count,
+                           [=](auto load)
+                           {
+                               const auto g     = load(gain);
+                               const auto K     = tan(c_pi<T, 1> * load(frequency));
+                               const auto K2    = K * K;
+                               const auto V     = exp(abs(g) * T(1.0 / 20.0) * c_log_10<T>);
+                               const auto boost = g >= 0;
+                               const auto sV    = sqrt(2 * V) * K;
+                               const auto s2    = c_sqrt_2<T> * K;
+                               // Numerator of the boost is the denominator of the cut and vice versa
+                               const auto zero1 = select(boost, sV, s2);
+                               const auto zeroK = select(boost, V * K2, K2);
+                               const auto pole1 = select(boost, s2, sV);
+                               const auto poleK = select(boost, K2, V * K2);
+                               const auto norm  = 1 / (1 + pole1 + poleK);
+                               const auto a1    = 2 * (poleK - 1) * norm;
+                               const auto a2    = (1 - pole1 + poleK) * norm;
+                               const auto b0    = (1 + zero1 + zeroK) * norm;
+                               return internal::biquad_lanes{ a1, a2, b0, 2 * (zeroK - 1) * norm,
+                                                              (1 - zero1 + zeroK) * norm };
+                           });
+}
+
+/**
+ * @brief Calculates coefficients for many high-shelf biquad filters at once, same as biquad_highshelf
+ * @copydetails biquad_lowshelf(const biquad_soa<T>&, const T*, const T*, size_t)
+ */
+template <typename T>
+KFR_FUNCTION void biquad_highshelf(const biquad_soa<T>& out, const T* frequency, const T* gain, size_t count)
+{
+    internal::biquad_batch(out, count,
+                           [=](auto load)
+                           {
+                               const auto g     = load(gain);
+                               const auto K     = tan(c_pi<T, 1> * load(frequency));
+                               const auto K2    = K * K;
+                               const auto V     = exp(abs(g) * T(1.0 / 20.0) * c_log_10<T>);
+                               const auto boost = g >= 0;
+                               const auto sV    = sqrt(2 * V) * K;
+                               const auto s2    = c_sqrt_2<T> * K;
+                               // Numerator of the boost is the denominator of the cut and vice versa
+                               const auto zero1 = select(boost, sV, s2);
+                               const auto zeroV = select(boost, V, T(1));
+                               const auto pole1 = select(boost, s2, sV);
+                               const auto poleV = select(boost, T(1), V);
+                               const auto norm  = 1 / (poleV + pole1 + K2);
+                               const auto a1    = 2 * (K2 - poleV) * norm;
+                               const auto a2    = (poleV - pole1 + K2) * norm;
+                               const auto b0    = (zeroV + zero1 + K2) * norm;
+                               return internal::biquad_lanes{ a1, a2, b0, 2 * (K2 - zeroV) * norm,
+                                                              (zeroV - zero1 + K2) * norm };
+                           });
+}
 } // namespace KFR_ARCH_NAME
 } // namespace kfr
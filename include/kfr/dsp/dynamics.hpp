@@ -0,0 +1,186 @@
+/** @addtogroup dsp_extra
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#pragma once
+
+#include "../base/filter.hpp"
+#include "../base/univector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace kfr
+{
+
+enum class dynamics_mode
+{
+    compressor, ///< Gain is reduced above the threshold by the ratio
+    expander,   ///< Gain is reduced below the threshold by the ratio (downward expander)
+    limiter,    ///< Peaks never exceed the threshold (brickwall with lookahead)
+};
+
+/**
+ * @brief Parameters of dynamics_processor
+ */
+template <typename T>
+struct dynamics_params
+{
+    dynamics_mode mode = dynamics_mode::compressor;
+    T threshold        = -20;   /**< Threshold in dB relative to full scale (peak level 1). */
+    T ratio            = 4;     /**< Input to output slope ratio, not used by the limiter. */
+    T knee             = 0;     /**< Width of the soft knee in dB, not used by the limiter. */
+    T attack           = 0.005; /**< Attack time in seconds. */
+    T release          = 0.1;   /**< Release time in seconds. */
+    T lookahead        = 0;     /**< Lookahead in seconds, the output is delayed by it. */
+    T makeup           = 0;     /**< Gain in dB applied after the processing. */
+};
+
+/**
+ * @brief Compressor, expander and lookahead limiter
+ *
+ * The level of each frame is the peak absolute value, of each channel or of all channels if they are
+ * linked. With lookahead, the level is the maximum over the lookahead window and the audio is delayed by
+ * the window. The sliding maximum is the van Herk/Gil-Werman algorithm, which has no branches and runs in
+ * SIMD lanes like the smoothing. The gain computer and the conversions between dB and linear gain run over
+ * blocks of frames as vector expressions. Gain smoothing is a one-pole recursion with separate attack and
+ * release coefficients, computed for all channels of a frame at once in SIMD lanes, so unlinked processing
+ * of many channels costs a few vector operations per frame.
+ *
+ * The limiter uses instant attack with the release recursion and then averages the gain over the lookahead
+ * window, the average reaches the gain needed by a peak exactly when the peak leaves the delay line, so the
+ * output never exceeds the threshold. Its attack parameter is not used, the attack time is the lookahead.
+ *
+ * As a filter<T>, buffers are interleaved frames of channels() samples.
+ */
+template <typename T>
+class dynamics_processor : public filter<T>
+{
+public:
+    /**
+     * @param params processing parameters
+     * @param sample_rate sample rate in Hz
+     * @param channels number of channels
+     * @param linked if true, the gain is computed from the level of all channels and applied to all of them
+     */
+    dynamics_processor(const dynamics_params<T>& params, double sample_rate, size_t channels = 1,
+                       bool linked = false)
+        : params(params), channel_count(channels), detectors(linked ? 1 : channels),
+          lookahead(static_cast<size_t>(std::round(params.lookahead * sample_rate)))
+    {
+        KFR_LOGIC_CHECK(channels > 0, "dynamics_processor: no channels");
+        KFR_LOGIC_CHECK(params.ratio >= 1, "dynamics_processor: ratio must be at least 1");
+        KFR_LOGIC_CHECK(params.knee >= 0 && params.attack >= 0 && params.release >= 0 &&
+                            params.lookahead >= 0,
+                        "dynamics_processor: knee, times and lookahead must not be negative");
+        attack_coef  = coefficient(params.attack, sample_rate);
+        release_coef = coefficient(params.release, sample_rate);
+        gain.resize(detectors);
+        hold_block.resize(lookahead > 0 ? (lookahead + 1) * detectors : 0);
+        hold_suffix.resize(lookahead > 0 ? (lookahead + 2) * detectors : 0);
+        hold_prefix.resize(detectors);
+        if (params.mode == dynamics_mode::limiter)
+        {
+            average.resize(lookahead * detectors);
+            average_sum.resize(detectors);
+        }
+        delayline.resize(lookahead * channels);
+        block.resize(block_frames * channels);
+        levels.resize(block_frames * detectors);
+        reset();
+    }
+
+    /// Number of channels
+    size_t channels() const { return channel_count; }
+
+    /// True if all channels share one gain
+    bool linked() const { return detectors == 1 && channel_count > 1; }
+
+    /// Delay of the output in frames
+    size_t latency() const { return lookahead; }
+
+    const dynamics_params<T>& get_params() const { return params; }
+
+    void reset() final
+    {
+        // Unity gain: 0 dB for the compressor and the expander, 1 for the limiter
+        std::fill(gain.begin(), gain.end(), params.mode == dynamics_mode::limiter ? T(1) : T(0));
+        // Levels are not negative, so zero is the identity of max
+        std::fill(hold_block.begin(), hold_block.end(), T(0));
+        std::fill(hold_suffix.begin(), hold_suffix.end(), T(0));
+        std::fill(hold_prefix.begin(), hold_prefix.end(), T(0));
+        std::fill(average.begin(), average.end(), T(1));
+        std::fill(average_sum.begin(), average_sum.end(), T(lookahead));
+        std::fill(delayline.begin(), delayline.end(), T(0));
+        hold_cursor = average_cursor = delay_cursor = 0;
+    }
+
+    /// @brief Gain reduction of the last frame in dB (zero or negative), per channel or the shared one
+    T gain_reduction(size_t channel = 0) const
+    {
+        const T g = gain[detectors == 1 ? 0 : channel];
+        if (params.mode != dynamics_mode::limiter)
+            return g;
+        return T(20) * std::log10(std::max(g, std::numeric_limits<T>::min()));
+    }
+
+    /// @brief Processes planar channels, output may be the same as input
+    void process(T* const* output, const T* const* input, size_t frames);
+
+    /// @brief Processes interleaved channels, output may be the same as input
+    void process_interleaved(T* output, const T* input, size_t frames);
+
+protected:
+    void process_buffer(T* dest, const T* src, size_t size) final;
+    void process_expression(T* dest, const expression_handle<T, 1>& src, size_t size) final;
+
+    constexpr static size_t block_frames = 64;
+
+    static T coefficient(T time, double sample_rate)
+    {
+        return time > 0 ? static_cast<T>(1 - std::exp(-1 / (time * sample_rate))) : T(1);
+    }
+
+    dynamics_params<T> params;
+    size_t channel_count;
+    size_t detectors; /**< Number of gains, 1 if linked. */
+    size_t lookahead; /**< Lookahead in frames. */
+    T attack_coef;
+    T release_coef;
+    univector<T> gain;        /**< Smoothed gain of each detector, dB or linear (limiter). */
+    univector<T> hold_block;  /**< Levels of the current block of lookahead + 1 frames. */
+    univector<T> hold_suffix; /**< Suffix maxima of the previous block and a row of zeros. */
+    univector<T> hold_prefix; /**< Prefix maximum of the current block. */
+    univector<T> average;     /**< Last lookahead gains of each detector (limiter). */
+    univector<T> average_sum; /**< Sums of average for each detector. */
+    univector<T> delayline;   /**< Last lookahead frames of the input, interleaved. */
+    size_t hold_cursor;
+    size_t average_cursor;
+    size_t delay_cursor;
+    univector<T> block;  /**< Interleaved frames of the current block. */
+    univector<T> levels; /**< Levels and gains of the current block for each detector. */
+};
+
+} // namespace kfr
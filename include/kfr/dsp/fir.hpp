@@ -33,6 +33,8 @@
 #include "../base/state_holder.hpp"
 #include "../base/univector.hpp"
 #include "../simd/vec.hpp"
+#include <algorithm>
+#include <vector>
 
 KFR_PRAGMA_MSVC(warning(push))
 KFR_PRAGMA_MSVC(warning(disable : 4244))
@@ -399,14 +401,33 @@ template <size_t TapCount, size_t InternalTapCount = next_poweroftwo(TapCount -
 
 } // namespace KFR_ARCH_NAME
 
+/**
+ * @brief FIR filter
+ *
+ * Buffers are processed by the block kernel: several outputs are computed at once from contiguous
+ * windows of the input, only the first taps - 1 outputs are computed from a small buffer that
+ * joins the delay line with the beginning of the input. Expressions are processed sample by sample.
+ * Both share the same delay line, so calls may be mixed.
+ *
+ * The block kernel multiplies in the scalar type of the samples. If the taps are wider than the samples
+ * (fir_filter<double, float>), buffers are processed sample by sample too, so the taps are not rounded.
+ */
 template <typename T, typename U = T>
 class fir_filter : public filter<U>
 {
 public:
-    fir_filter(fir_state<T, U> state) : state(std::move(state)) {}
+    fir_filter(fir_state<T, U> state) : state(std::move(state)) { init_block(); }
 
-    void set_taps(fir_params<T> params) { state = std::move(params); }
-    void set_params(fir_params<T> params) { state = std::move(params); }
+    void set_taps(fir_params<T> params)
+    {
+        state = std::move(params);
+        init_block();
+    }
+    void set_params(fir_params<T> params)
+    {
+        state = std::move(params);
+        init_block();
+    }
 
     /// Reset internal filter state
     void reset() final
@@ -419,12 +440,242 @@ protected:
     void process_buffer(U* dest, const U* src, size_t size) final;
     void process_expression(U* dest, const expression_handle<U, 1>& src, size_t size) final;
 
+    void init_block()
+    {
+        const size_t history = state.params.taps.empty() ? 0 : state.params.taps.size() - 1;
+        if constexpr (sizeof(deep_subtype<T>) <= sizeof(deep_subtype<U>))
+            block_taps = state.params.taps;
+        block_head.resize(2 * history);
+    }
+
     fir_state<T, U> state;
+    univector<deep_subtype<U>> block_taps; /**< Reversed taps in the scalar type of the samples. */
+    univector<U> block_head;               /**< Delay line followed by the first samples of the input. */
 };
 
 template <typename T, typename U = T>
 using filter_fir = fir_filter<T, U>;
 
+/**
+ * @brief Decimating FIR filter, y[m] = Σ h[k]·x[m·factor - k]
+ *
+ * Only every factor-th output is computed. The taps are stored in polyphase order and the input is
+ * split into factor phase streams, so each phase is a short filter over a contiguous stream and
+ * several outputs are computed at once with SIMD. Input may be pushed in blocks of any size.
+ *
+ * Phases with a single nonzero tap cost one multiplication per output, so a halfband filter (see
+ * fir_halfband) decimates by 2 at about half the cost of its taps.
+ */
+template <typename T, typename U = T>
+class fir_decimator
+{
+public:
+    /// @param taps filter coefficients
+    /// @param factor decimation factor
+    fir_decimator(const univector_ref<const T>& taps, size_t factor)
+        : decimation(factor), phase_taps((taps.size() + factor - 1) / factor),
+          width(phase_taps + block_frames), phase_taps_data(phase_taps * factor, deep_subtype<U>(0)),
+          phases(width * factor)
+    {
+        KFR_LOGIC_CHECK(factor > 0 && !taps.empty(), "fir_decimator: invalid parameters");
+        // Reversed taps padded at the beginning to phase_taps * factor, split into phases
+        const size_t padded = phase_taps * factor;
+        for (size_t j = padded - taps.size(); j < padded; ++j)
+            phase_taps_data[(j % factor) * phase_taps + j / factor] = taps[padded - 1 - j];
+
+        // Phases with at most one nonzero tap before or after the range of the other phases
+        size_t first = factor, last = 0;
+        for (size_t q = 0; q < factor; ++q)
+        {
+            const auto phase = phase_taps_data.slice(q * phase_taps, phase_taps);
+            if (std::count_if(phase.begin(), phase.end(), [](auto tap) { return tap != 0; }) > 1)
+            {
+                first = std::min(first, q);
+                last  = q;
+            }
+        }
+        if (first > last)
+            first = last = 0;
+        dense_first = first;
+        dense_count = last - first + 1;
+        for (size_t q = 0; q < factor; ++q)
+        {
+            const auto phase = phase_taps_data.slice(q * phase_taps, phase_taps);
+            const auto tap   = std::find_if(phase.begin(), phase.end(), [](auto tap) { return tap != 0; });
+            if ((q < first || q > last) && tap != phase.end())
+                single_taps.push_back(q * phase_taps + (tap - phase.begin()));
+        }
+        reset();
+    }
+
+    /// Decimation factor
+    size_t factor() const { return decimation; }
+
+    /// Number of outputs produced by the next call to process for @p input_size samples
+    size_t output_size_for_input(size_t input_size) const { return (fill + input_size) / decimation; }
+
+    void reset()
+    {
+        phases  = scalar(0);
+        columns = phase_taps - 1;
+        // The first output corresponds to x[0], samples before it are zeros
+        fill = decimation - 1;
+    }
+
+    /// @brief Filters and decimates the input
+    /// @param dest output buffer, must fit output_size_for_input(size) samples
+    /// @return number of outputs written
+    size_t process(U* dest, const U* src, size_t size);
+
+    template <univector_tag Tag>
+    univector<U> process(const univector<U, Tag>& src)
+    {
+        univector<U> result(output_size_for_input(src.size()));
+        process(result.data(), src.data(), src.size());
+        return result;
+    }
+
+protected:
+    constexpr static size_t block_frames = 256;
+
+    size_t decimation;
+    size_t phase_taps;
+    size_t width;
+    univector<deep_subtype<U>> phase_taps_data; /**< Reversed taps, phase_taps per phase. */
+    univector<U> phases;                        /**< Phase streams of the input, width samples each. */
+    size_t columns;                             /**< Filled samples of each phase stream. */
+    size_t fill;                                /**< Samples of the incomplete frame. */
+    size_t dense_first;                         /**< First phase filtered by the SIMD kernel. */
+    size_t dense_count;                         /**< Number of phases filtered by the SIMD kernel. */
+    std::vector<size_t> single_taps;            /**< Index of the only tap of each remaining phase. */
+};
+
+/**
+ * @brief Interpolating FIR filter, y[n] = Σ h[k]·x_up[n - k], where x_up[m·factor] = x[m] and zero elsewhere
+ *
+ * Zeros are never multiplied: output n needs only the taps h[i·factor + n % factor]. Consecutive outputs
+ * are computed in SIMD lanes, each lane in its own phase: the taps are stored as vectors of the phase
+ * pattern for every starting phase and the input is repeated factor times, so lanes read contiguous
+ * memory. The gain is defined by the taps, multiply them by the factor to keep the amplitude.
+ */
+template <typename T, typename U = T>
+class fir_interpolator
+{
+public:
+    /// @param taps filter coefficients
+    /// @param factor interpolation factor
+    fir_interpolator(const univector_ref<const T>& taps, size_t factor)
+        : interpolation(factor), phase_taps((taps.size() + factor - 1) / factor),
+          history((phase_taps - 1) * factor),
+          expanded(history + block_inputs * factor)
+    {
+        KFR_LOGIC_CHECK(factor > 0 && !taps.empty(), "fir_interpolator: invalid parameters");
+        using S                 = deep_subtype<U>;
+        constexpr size_t width  = vector_width<S>;
+        constexpr size_t stride = sizeof(U) / sizeof(S);
+        phase_taps_data         = truncate(padded(taps), phase_taps * factor);
+        // Lane l of the vector for tap i and starting phase p is h[i·factor + (p + l / stride) % factor]
+        tables.resize(factor * phase_taps * width);
+        for (size_t p = 0; p < factor; ++p)
+            for (size_t i = 0; i < phase_taps; ++i)
+                for (size_t l = 0; l < width; ++l)
+                    tables[(p * phase_taps + i) * width + l] =
+                        phase_taps_data[i * factor + (p + l / stride) % factor];
+        reset();
+    }
+
+    /// Interpolation factor
+    size_t factor() const { return interpolation; }
+
+    /// Number of outputs produced by process for @p input_size samples
+    size_t output_size_for_input(size_t input_size) const { return input_size * interpolation; }
+
+    void reset() { expanded = scalar(0); }
+
+    /// @brief Upsamples and filters the input
+    /// @param dest output buffer of size * factor() samples
+    /// @return number of outputs written
+    size_t process(U* dest, const U* src, size_t size);
+
+    template <univector_tag Tag>
+    univector<U> process(const univector<U, Tag>& src)
+    {
+        univector<U> result(output_size_for_input(src.size()));
+        process(result.data(), src.data(), src.size());
+        return result;
+    }
+
+protected:
+    constexpr static size_t block_inputs = 128;
+
+    size_t interpolation;
+    size_t phase_taps;
+    size_t history;
+    univector<deep_subtype<U>> phase_taps_data; /**< Taps padded to phase_taps * factor. */
+    univector<deep_subtype<U>> tables;          /**< Tap vectors for each starting phase. */
+    univector<U> expanded;                      /**< History and input, each sample repeated factor times. */
+};
+
+/**
+ * @brief Interpolating halfband FIR filter, fir_interpolator with the factor 2 for halfband taps
+ *
+ * Every other tap of a halfband filter (see fir_halfband) is zero except the center one, so the outputs of
+ * one phase are the input delayed and scaled by the center tap and only the other phase is filtered, as
+ * a short filter over the contiguous input. The gain is defined by the taps, multiply them by 2 to keep
+ * the amplitude.
+ */
+template <typename T, typename U = T>
+class halfband_interpolator
+{
+public:
+    /// @param taps odd number of filter coefficients, the taps of the parity of the center are ignored
+    explicit halfband_interpolator(const univector_ref<const T>& taps)
+        : center_phase(taps.size() / 2 % 2), center_delay(taps.size() / 4),
+          phase_taps((taps.size() + center_phase) / 2), history(std::max(phase_taps, center_delay + 1) - 1),
+          center(taps.empty() ? T(0) : taps[taps.size() / 2]), phase_taps_data(phase_taps),
+          input(history + block_inputs), filtered(block_inputs)
+    {
+        KFR_LOGIC_CHECK(is_odd(taps.size()), "halfband_interpolator: number of taps must be odd");
+        // Taps of the other phase, reversed
+        for (size_t i = 0; i < phase_taps; ++i)
+            phase_taps_data[phase_taps - 1 - i] = taps[2 * i + 1 - center_phase];
+        reset();
+    }
+
+    /// Interpolation factor
+    constexpr size_t factor() const { return 2; }
+
+    /// Number of outputs produced by process for @p input_size samples
+    size_t output_size_for_input(size_t input_size) const { return input_size * 2; }
+
+    void reset() { input = scalar(0); }
+
+    /// @brief Upsamples and filters the input
+    /// @param dest output buffer of size * 2 samples
+    /// @return number of outputs written
+    size_t process(U* dest, const U* src, size_t size);
+
+    template <univector_tag Tag>
+    univector<U> process(const univector<U, Tag>& src)
+    {
+        univector<U> result(output_size_for_input(src.size()));
+        process(result.data(), src.data(), src.size());
+        return result;
+    }
+
+protected:
+    constexpr static size_t block_inputs = 256;
+
+    size_t center_phase;                        /**< Phase of the outputs copied from the input. */
+    size_t center_delay;                        /**< Delay of these outputs in input samples. */
+    size_t phase_taps;
+    size_t history;
+    T center;
+    univector<deep_subtype<U>> phase_taps_data; /**< Reversed taps of the filtered phase. */
+    univector<U> input;                         /**< History followed by the input. */
+    univector<U> filtered;                      /**< Outputs of the filtered phase. */
+};
+
 } // namespace kfr
 
 KFR_PRAGMA_MSVC(warning(pop))
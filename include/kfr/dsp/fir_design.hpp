@@ -27,6 +27,7 @@
 
 #include "../math/sin_cos.hpp"
 #include "fir.hpp"
+#include <vector>
 
 namespace kfr
 {
@@ -115,11 +116,47 @@ void fir_bandstop(univector_ref<T> taps, T frequency1, T frequency2, const expre
         taps           = taps * invsum;
     }
 }
+
+template <typename T>
+void fir_hilbert(univector_ref<T> taps, const expression_handle<T>& window)
+{
+    KFR_LOGIC_CHECK(is_odd(taps.size()), "fir_hilbert: number of taps must be odd");
+    const signed_index_t center = taps.size() / 2;
+
+    taps = window;
+    for (signed_index_t i = 0; i < static_cast<signed_index_t>(taps.size()); ++i)
+    {
+        const signed_index_t m = i - center;
+        taps[i]                = is_odd(m) ? taps[i] * T(2) / (c_pi<T> * m) : T(0);
+    }
+}
+
+template <typename T>
+void fir_halfband(univector_ref<T> taps, const expression_handle<T>& window)
+{
+    KFR_LOGIC_CHECK(is_odd(taps.size()), "fir_halfband: number of taps must be odd");
+    const signed_index_t center = taps.size() / 2;
+
+    taps = window;
+    T total = 0;
+    for (signed_index_t i = 0; i < static_cast<signed_index_t>(taps.size()); ++i)
+    {
+        const signed_index_t m = i - center;
+        taps[i]                = is_odd(m) ? taps[i] * std::sin(c_pi<T, 1, 2> * m) / (c_pi<T> * m) : T(0);
+        total += taps[i];
+    }
+    // Center tap is exactly 1/2, the other taps are normalized for the unity gain at DC
+    if (total != 0)
+        taps = taps * (T(0.5) / total);
+    taps[center] = T(0.5);
+}
 } // namespace internal
 KFR_I_FN_FULL(fir_lowpass, internal::fir_lowpass)
 KFR_I_FN_FULL(fir_highpass, internal::fir_highpass)
 KFR_I_FN_FULL(fir_bandpass, internal::fir_bandpass)
 KFR_I_FN_FULL(fir_bandstop, internal::fir_bandstop)
+KFR_I_FN_FULL(fir_hilbert, internal::fir_hilbert)
+KFR_I_FN_FULL(fir_halfband, internal::fir_halfband)
 
 /**
  * @brief Calculates coefficients for the low-pass FIR filter
@@ -181,6 +218,30 @@ KFR_INTRINSIC void fir_bandstop(univector<T, Tag>& taps, std::type_identity_t<T>
     return internal::fir_bandstop(taps.slice(), frequency1, frequency2, window, normalize);
 }
 
+/**
+ * @brief Calculates coefficients for the type III Hilbert transformer FIR filter
+ * @param taps array where computed coefficients are stored, size must be odd
+ * @param window pointer to a window function
+ * @note Every other tap (including the center one) is zero, see hilbert_fir
+ */
+template <typename T, univector_tag Tag>
+KFR_INTRINSIC void fir_hilbert(univector<T, Tag>& taps, const expression_handle<T>& window)
+{
+    return internal::fir_hilbert(taps.slice(), window);
+}
+
+/**
+ * @brief Calculates coefficients for the halfband low-pass FIR filter (cutoff at 1/4 of the sample rate)
+ * @param taps array where computed coefficients are stored, size must be odd
+ * @param window pointer to a window function
+ * @note Every other tap except the center one is zero, see fir_decimator and halfband_interpolator
+ */
+template <typename T, univector_tag Tag>
+KFR_INTRINSIC void fir_halfband(univector<T, Tag>& taps, const expression_handle<T>& window)
+{
+    return internal::fir_halfband(taps.slice(), window);
+}
+
 /**
  * @copydoc kfr::fir_lowpass
  */
@@ -222,5 +283,102 @@ KFR_INTRINSIC void fir_bandstop(const univector_ref<T>& taps, std::type_identity
 {
     return internal::fir_bandstop(taps, frequency1, frequency2, window, normalize);
 }
+
+/**
+ * @copydoc kfr::fir_hilbert
+ */
+template <typename T>
+KFR_INTRINSIC void fir_hilbert(const univector_ref<T>& taps, const expression_handle<T>& window)
+{
+    return internal::fir_hilbert(taps, window);
+}
+
+/**
+ * @copydoc kfr::fir_halfband
+ */
+template <typename T>
+KFR_INTRINSIC void fir_halfband(const univector_ref<T>& taps, const expression_handle<T>& window)
+{
+    return internal::fir_halfband(taps, window);
+}
+
+/// @brief Response of the equiripple FIR filter
+enum class remez_type
+{
+    bandpass,       ///< Symmetric taps, the gain of each band is the desired amplitude
+    differentiator, ///< Antisymmetric taps, the desired response is j·gain·f, gain = 2π for the derivative
+    hilbert         ///< Antisymmetric taps, the desired response is -j·gain (gain 1 as fir_hilbert)
+};
+
+/// @brief Band of the equiripple FIR filter specification
+struct remez_band
+{
+    double low;        ///< Lower edge, normalized frequency (frequency_Hz / samplerate_Hz), 0..0.5
+    double high;       ///< Upper edge, normalized frequency
+    double gain;       ///< Desired amplitude (slope for the differentiator)
+    double weight = 1; ///< Relative weight of the error, the deviation of the band is inversely proportional
+};
+
+/// @brief Result of the equiripple FIR filter design
+struct remez_result
+{
+    double deviation;  ///< Maximum weighted error, the error in each band is up to deviation / weight
+    size_t iterations; ///< Number of the exchange iterations
+    bool converged;    ///< false if the error wasn't equiripple after the maximum number of iterations
+};
+
+/**
+ * @brief Calculates coefficients for the optimal (minimax) FIR filter using the Parks-McClellan algorithm
+ *
+ * Minimizes the maximum of the weighted error over the bands by the Remez exchange. For the same
+ * specification an equiripple filter needs fewer taps than a windowed one, see fir_estimate_taps. Gaps
+ * between the bands are transition bands where the response is not constrained. Any number of taps is
+ * allowed, but an even number forces zero gain at 0.5 (symmetric taps) or at 0 (antisymmetric taps).
+ * @param taps array where computed coefficients are stored
+ * @param bands bands in increasing frequency order, not overlapping
+ * @param type response type
+ * @param grid_density number of points of the frequency grid per extremum
+ * @param max_iterations maximum number of the exchange iterations
+ */
+template <typename T>
+KFR_FUNCTION remez_result fir_remez(const univector_ref<T>& taps, const std::vector<remez_band>& bands,
+                                    remez_type type = remez_type::bandpass, size_t grid_density = 16,
+                                    size_t max_iterations = 40);
+
+/**
+ * @brief Calculates coefficients for the optimal halfband low-pass FIR filter (see fir_halfband)
+ *
+ * Uses the method of Vaidyanathan and Nguyen: an equiripple filter of (size + 1) / 2 taps with the single
+ * band [0, 2·passband] is interleaved with zeros and 1/2 is added at the center. The deviation in both the
+ * passband [0, passband] and the stopband [0.5 - passband, 0.5] is the returned one.
+ * @param taps array where computed coefficients are stored, size must be 4k - 1
+ * @param passband passband edge, normalized frequency below 0.25
+ */
+template <typename T>
+KFR_FUNCTION remez_result fir_remez_halfband(const univector_ref<T>& taps, double passband);
+
+/**
+ * @brief Estimates the number of taps of the equiripple low-pass or high-pass FIR filter (Kaiser formula)
+ * @param passband_ripple deviation in the passband (linear, e.g. 0.01 for ±0.087 dB)
+ * @param stopband_ripple deviation in the stopband (linear, e.g. 0.001 for -60 dB)
+ * @param transition width of the transition band, normalized frequency
+ * @note For fir_remez the ratio of the weights of the passband and the stopband is
+ * stopband_ripple / passband_ripple. The estimate is usually within a few taps, check the result.
+ */
+KFR_FUNCTION size_t fir_estimate_taps(double passband_ripple, double stopband_ripple, double transition);
+
+template <typename T, univector_tag Tag>
+KFR_INTRINSIC remez_result fir_remez(univector<T, Tag>& taps, const std::vector<remez_band>& bands,
+                                     remez_type type = remez_type::bandpass, size_t grid_density = 16,
+                                     size_t max_iterations = 40)
+{
+    return fir_remez(taps.slice(), bands, type, grid_density, max_iterations);
+}
+
+template <typename T, univector_tag Tag>
+KFR_INTRINSIC remez_result fir_remez_halfband(univector<T, Tag>& taps, double passband)
+{
+    return fir_remez_halfband(taps.slice(), passband);
+}
 } // namespace KFR_ARCH_NAME
 } // namespace kfr
@@ -0,0 +1,164 @@
+/** @addtogroup fir
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#pragma once
+
+#include "../base/reduce.hpp"
+#include "../base/univector.hpp"
+#include "../math/atan.hpp"
+#include "../simd/complex.hpp"
+#include "fir_design.hpp"
+#include "window.hpp"
+
+namespace kfr
+{
+inline namespace KFR_ARCH_NAME
+{
+
+/**
+ * @brief Streaming analytic signal generator based on the FIR Hilbert transformer
+ *
+ * Real part of the output is the input delayed by latency() samples, imaginary part is the input filtered
+ * by the type III Hilbert transformer (see fir_hilbert). Every other tap of such filter is zero, so the
+ * input is split into even and odd samples and each output sample is the dot product of the nonzero taps
+ * with one of the two sequences, halving the number of multiplications.
+ */
+template <typename T>
+class hilbert_fir
+{
+public:
+    /// @param taps odd number of taps of the Hilbert transformer
+    /// @param window window function applied to the ideal impulse response
+    hilbert_fir(size_t taps, const expression_handle<T>& window)
+    {
+        univector<T> full(taps);
+        fir_hilbert(full, window);
+        init(full);
+    }
+
+    /// Uses the Kaiser window with @c beta = 8
+    explicit hilbert_fir(size_t taps) : hilbert_fir(taps, to_handle(window_kaiser<T>(taps, T(8)))) {}
+
+    /// Group delay of the filter in samples
+    size_t latency() const { return delay.size(); }
+
+    /// Number of nonzero taps, i.e. multiplications per output sample
+    size_t nonzero_taps() const { return coefs.size(); }
+
+    void reset()
+    {
+        process(phases[0], zeros());
+        process(phases[1], zeros());
+        process(delay, zeros());
+        cursor[0]    = 0;
+        cursor[1]    = 0;
+        delay_cursor = 0;
+        parity       = 0;
+    }
+
+    /// @brief Computes the analytic signal
+    void apply(complex<T>* out, const T* in, size_t size)
+    {
+        run(in, size, [out](size_t i, T re, T im) { out[i] = complex<T>(re, im); });
+    }
+
+    /// @brief Computes the envelope (magnitude of the analytic signal)
+    void envelope(T* out, const T* in, size_t size)
+    {
+        run(in, size, [out](size_t i, T re, T im) { out[i] = std::sqrt(re * re + im * im); });
+    }
+
+    /// @brief Computes the instantaneous phase (argument of the analytic signal) in radians
+    void phase(T* out, const T* in, size_t size)
+    {
+        run(in, size, [out](size_t i, T re, T im) { out[i] = atan2(im, re); });
+    }
+
+    template <univector_tag Tag1, univector_tag Tag2>
+    void apply(univector<complex<T>, Tag1>& out, const univector<T, Tag2>& in)
+    {
+        out.resize(in.size());
+        apply(out.data(), in.data(), in.size());
+    }
+
+private:
+    void init(const univector<T>& full)
+    {
+        KFR_LOGIC_CHECK(full.size() >= 3, "hilbert_fir: at least 3 taps are required");
+        const size_t m = full.size() / 2;
+        // Nonzero taps have indices of parity p
+        p                = is_odd(m) ? 0 : 1;
+        const size_t num = (full.size() - 1 - p) / 2 + 1;
+        coefs.resize(num);
+        // Oldest sample first to match the layout of the delay line
+        for (size_t i = 0; i < num; ++i)
+            coefs[i] = full[p + 2 * (num - 1 - i)];
+        // Each delay line is stored twice, so the last num samples are always contiguous
+        phases[0].resize(2 * num);
+        phases[1].resize(2 * num);
+        delay.resize(m);
+        reset();
+    }
+
+    template <typename Fn>
+    void run(const T* in, size_t size, Fn&& fn)
+    {
+        const size_t num = coefs.size();
+        for (size_t i = 0; i < size; ++i)
+        {
+            const T x            = in[i];
+            univector<T>& buffer = phases[parity];
+            size_t& c            = cursor[parity];
+            buffer[c]            = x;
+            buffer[c + num]      = x;
+            c                    = c + 1 == num ? 0 : c + 1;
+
+            // x[n - p - 2j] are all in the same phase
+            const size_t q = parity ^ p;
+            const T im     = dotproduct(coefs, phases[q].slice(cursor[q], num));
+
+            T re = x;
+            if (!delay.empty())
+            {
+                re                  = delay[delay_cursor];
+                delay[delay_cursor] = x;
+                delay_cursor        = delay_cursor + 1 == delay.size() ? 0 : delay_cursor + 1;
+            }
+            parity ^= 1;
+            fn(i, re, im);
+        }
+    }
+
+    univector<T> coefs;
+    univector<T> phases[2];
+    univector<T> delay;
+    size_t cursor[2];
+    size_t delay_cursor;
+    size_t parity;
+    size_t p;
+};
+
+} // namespace KFR_ARCH_NAME
+} // namespace kfr
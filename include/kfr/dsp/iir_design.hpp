@@ -119,6 +119,21 @@ KFR_FUNCTION zpk iir_bandstop(const zpk& filter, double lowfreq, double highfreq
 template <typename T = double>
 KFR_FUNCTION iir_params<T> to_sos(const zpk& filter);
 
+/**
+ * @brief Converts the filter to the parallel form (partial fraction expansion) for parallel_sos_filter
+ *
+ * Each pair of complex conjugate poles or two real poles become a section with a first-order numerator,
+ * the rest of the polynomial division of the numerator by the denominator becomes the FIR direct term (one
+ * coefficient if there are as many zeros as poles). Residues are computed in double precision directly
+ * from the zeros and poles. Poles must be distinct: a residue is inversely proportional to the distances
+ * between its pole and the others, so for closely spaced poles (high order, narrow band) the outputs of
+ * the sections are large and cancel each other, and the rounding errors of T grow accordingly (for float
+ * mostly above the 10th order). Zeros and poles are padded at the origin as in to_sos, so the response
+ * is the same as the one of to_sos up to the rounding errors.
+ */
+template <typename T = double>
+KFR_FUNCTION parallel_sos<T> to_parallel_sos(const zpk& filter);
+
 /**
  * @brief Returns template expressions that applies biquad filter to the input.
  * @param e1 Input expression
@@ -0,0 +1,374 @@
+/** @addtogroup fir
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#pragma once
+
+#include "../base/basic_expressions.hpp"
+#include "../base/reduce.hpp"
+#include "../base/simd_expressions.hpp"
+#include "../base/state_holder.hpp"
+#include "../base/univector.hpp"
+#include "../simd/vec.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace kfr
+{
+
+/**
+ * @brief State of the moving maximum (IsMax = true) or minimum over the last @c length samples
+ *
+ * Monotonic deque (Lemire's algorithm): the candidates are kept in a ring buffer in the order of
+ * arrival with the values decreasing (increasing for the minimum), so each sample is pushed and
+ * removed once and the cost is O(1) amortized for any window length. Like moving_sum_state, the
+ * window is initially filled with zeros.
+ */
+template <typename U, bool IsMax>
+struct moving_extremum_state
+{
+    using value_type = U;
+
+    moving_extremum_state(size_t length)
+        : values(next_poweroftwo(length)), positions(values.size()), length(length), head(0), count(1),
+          position(length)
+    {
+        KFR_LOGIC_CHECK(length > 0, "moving_extremum_state: length must be positive");
+        // A single candidate stands for the initial zeros, the latest of them has position length - 1
+        values[0]    = U(0);
+        positions[0] = length - 1;
+    }
+
+    U push(U x)
+    {
+        const size_t mask = values.size() - 1;
+        if (positions[head] + length <= position)
+        {
+            head = (head + 1) & mask;
+            --count;
+        }
+        while (count > 0 && !(IsMax ? values[(head + count - 1) & mask] > x
+                                    : values[(head + count - 1) & mask] < x))
+            --count;
+        values[(head + count) & mask]    = x;
+        positions[(head + count) & mask] = position;
+        ++count;
+        ++position;
+        return values[head];
+    }
+
+    univector<U> values;
+    univector<size_t> positions;
+    size_t length, head, count, position;
+};
+
+template <typename U>
+using moving_max_state = moving_extremum_state<U, true>;
+
+template <typename U>
+using moving_min_state = moving_extremum_state<U, false>;
+
+/**
+ * @brief State of the moving median over the last @c length samples
+ *
+ * Two indexed heaps share one array: the max-heap of the lower (length + 1) / 2 values and the min-heap of
+ * the upper ones. Every slot of the delay line knows its place in the heaps, so the oldest value is
+ * replaced in place and each sample costs O(log length) without lazy deletion. The median of an even
+ * window is the mean of the two middle values. The window is initially filled with zeros.
+ */
+template <typename U>
+struct moving_median_state
+{
+    using value_type = U;
+
+    moving_median_state(size_t length)
+        : delayline(length, U(0)), heap(length), where(length), low((length + 1) / 2), cursor(0)
+    {
+        KFR_LOGIC_CHECK(length > 0, "moving_median_state: length must be positive");
+        // All values are equal, so any order satisfies both heaps
+        for (size_t i = 0; i < length; ++i)
+        {
+            heap[i]  = i;
+            where[i] = i;
+        }
+    }
+
+    U push(U x)
+    {
+        const size_t slot = cursor;
+        cursor            = cursor + 1 == delayline.size() ? 0 : cursor + 1;
+        delayline[slot]   = x;
+        const size_t high = delayline.size() - low;
+        if (where[slot] < low)
+        {
+            update(0, low, true, where[slot]);
+            if (high > 0 && value(low) < value(0))
+            {
+                exchange(0, low);
+                sift_down(0, low, true, 0);
+                sift_down(low, high, false, 0);
+            }
+        }
+        else
+        {
+            update(low, high, false, where[slot] - low);
+            if (value(low) < value(0))
+            {
+                exchange(0, low);
+                sift_down(0, low, true, 0);
+                sift_down(low, high, false, 0);
+            }
+        }
+        return is_odd(delayline.size()) ? value(0) : (value(0) + value(low)) * U(0.5);
+    }
+
+    univector<U> delayline;
+    // Slots of the delay line, [0, low) is the max-heap, [low, length) is the min-heap
+    univector<size_t> heap;
+    // Index in heap for every slot
+    univector<size_t> where;
+    size_t low, cursor;
+
+private:
+    U value(size_t index) const { return delayline[heap[index]]; }
+
+    // True if a must be closer to the root than b
+    static bool above(bool is_max, U a, U b) { return is_max ? a > b : a < b; }
+
+    void exchange(size_t a, size_t b)
+    {
+        std::swap(heap[a], heap[b]);
+        where[heap[a]] = a;
+        where[heap[b]] = b;
+    }
+
+    void update(size_t base, size_t size, bool is_max, size_t i)
+    {
+        if (i > 0 && above(is_max, value(base + i), value(base + (i - 1) / 2)))
+        {
+            do
+            {
+                exchange(base + i, base + (i - 1) / 2);
+                i = (i - 1) / 2;
+            } while (i > 0 && above(is_max, value(base + i), value(base + (i - 1) / 2)));
+        }
+        else
+        {
+            sift_down(base, size, is_max, i);
+        }
+    }
+
+    void sift_down(size_t base, size_t size, bool is_max, size_t i)
+    {
+        for (;;)
+        {
+            size_t top = i;
+            for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < size; ++child)
+                if (above(is_max, value(base + child), value(base + top)))
+                    top = child;
+            if (top == i)
+                break;
+            exchange(base + i, base + top);
+            i = top;
+        }
+    }
+};
+
+/**
+ * @brief State of the moving variance over the last @c length samples
+ *
+ * The mean and the sum of squared deviations are updated by the sliding window form of Welford's
+ * algorithm. Once per @c length samples both are recomputed from the delay line, so the rounding errors
+ * don't accumulate and the cost stays O(1) amortized. The result is the population variance (divided by
+ * length). The window is initially filled with zeros.
+ */
+template <typename U>
+struct moving_variance_state
+{
+    using value_type = U;
+
+    moving_variance_state(size_t length) : delayline(length, U(0)), cursor(0), mean(0), m2(0)
+    {
+        KFR_LOGIC_CHECK(length > 0, "moving_variance_state: length must be positive");
+    }
+
+    U push(U x)
+    {
+        const U length    = static_cast<U>(delayline.size());
+        const U old       = delayline[cursor];
+        delayline[cursor] = x;
+        if (++cursor == delayline.size())
+        {
+            cursor = 0;
+            mean   = kfr::mean(delayline);
+            m2     = sumsqr(delayline - mean);
+        }
+        else
+        {
+            const U old_mean = mean;
+            mean += (x - old) / length;
+            m2 += (x - old) * (x - mean + old - old_mean);
+        }
+        return std::max(m2, U(0)) / length;
+    }
+
+    univector<U> delayline;
+    size_t cursor;
+    U mean, m2;
+};
+
+inline namespace KFR_ARCH_NAME
+{
+
+template <typename State, typename E1, bool stateless = false>
+struct expression_moving_statistic : expression_with_traits<E1>
+{
+    using U          = typename State::value_type;
+    using value_type = U; // override value_type
+
+    static_assert(expression_traits<E1>::dims == 1,
+                  "expression_moving_statistic requires input with dims == 1");
+    constexpr static inline bool random_access = false;
+
+    expression_moving_statistic(E1&& e1, state_holder<State, stateless> state)
+        : expression_with_traits<E1>(std::forward<E1>(e1)), state(std::move(state))
+    {
+    }
+
+    template <size_t N>
+    KFR_INTRINSIC friend vec<U, N> get_elements(const expression_moving_statistic& self, shape<1> index,
+                                                axis_params<0, N> sh)
+    {
+        const vec<U, N> input = get_elements(self.first(), index, sh);
+        vec<U, N> output;
+        KFR_LOOP_NOUNROLL
+        for (size_t i = 0; i < N; i++)
+        {
+            output[i] = self.state->push(input[i]);
+        }
+        return output;
+    }
+    mutable state_holder<State, stateless> state;
+};
+
+/**
+ * @brief Returns template expression that computes the maximum of the last @p length samples of the input
+ * @param e1 an input expression
+ */
+template <typename E1, typename U = expression_value_type<E1>>
+KFR_INTRINSIC expression_moving_statistic<moving_max_state<U>, E1> moving_max(E1&& e1, size_t length)
+{
+    return expression_moving_statistic<moving_max_state<U>, E1>(std::forward<E1>(e1),
+                                                                moving_max_state<U>{ length });
+}
+
+/**
+ * @brief Returns template expression that computes the minimum of the last @p length samples of the input
+ * @param e1 an input expression
+ */
+template <typename E1, typename U = expression_value_type<E1>>
+KFR_INTRINSIC expression_moving_statistic<moving_min_state<U>, E1> moving_min(E1&& e1, size_t length)
+{
+    return expression_moving_statistic<moving_min_state<U>, E1>(std::forward<E1>(e1),
+                                                                moving_min_state<U>{ length });
+}
+
+/**
+ * @brief Returns template expression that computes the median of the last @p length samples of the input
+ * @param e1 an input expression
+ */
+template <typename E1, typename U = expression_value_type<E1>>
+KFR_INTRINSIC expression_moving_statistic<moving_median_state<U>, E1> moving_median(E1&& e1, size_t length)
+{
+    return expression_moving_statistic<moving_median_state<U>, E1>(std::forward<E1>(e1),
+                                                                   moving_median_state<U>{ length });
+}
+
+/**
+ * @brief Returns template expression that computes the variance of the last @p length samples of the input
+ * @param e1 an input expression
+ */
+template <typename E1, typename U = expression_value_type<E1>>
+KFR_INTRINSIC expression_moving_statistic<moving_variance_state<U>, E1> moving_variance(E1&& e1,
+                                                                                        size_t length)
+{
+    return expression_moving_statistic<moving_variance_state<U>, E1>(std::forward<E1>(e1),
+                                                                     moving_variance_state<U>{ length });
+}
+
+/**
+ * @brief Returns template expression that computes the moving maximum or minimum of the input
+ * @param e1 an input expression
+ * @param state State (taken by reference)
+ */
+template <typename E1, typename U, bool IsMax>
+KFR_INTRINSIC expression_moving_statistic<moving_extremum_state<U, IsMax>, E1, true> moving_max(
+    E1&& e1, std::reference_wrapper<moving_extremum_state<U, IsMax>> state)
+{
+    static_assert(IsMax, "moving_max: use moving_min for moving_min_state");
+    return expression_moving_statistic<moving_extremum_state<U, IsMax>, E1, true>(std::forward<E1>(e1),
+                                                                                   state);
+}
+
+/**
+ * @brief Returns template expression that computes the moving minimum of the input
+ * @param e1 an input expression
+ * @param state State (taken by reference)
+ */
+template <typename E1, typename U, bool IsMax>
+KFR_INTRINSIC expression_moving_statistic<moving_extremum_state<U, IsMax>, E1, true> moving_min(
+    E1&& e1, std::reference_wrapper<moving_extremum_state<U, IsMax>> state)
+{
+    static_assert(!IsMax, "moving_min: use moving_max for moving_max_state");
+    return expression_moving_statistic<moving_extremum_state<U, IsMax>, E1, true>(std::forward<E1>(e1),
+                                                                                   state);
+}
+
+/**
+ * @brief Returns template expression that computes the moving median of the input
+ * @param e1 an input expression
+ * @param state State (taken by reference)
+ */
+template <typename E1, typename U>
+KFR_INTRINSIC expression_moving_statistic<moving_median_state<U>, E1, true> moving_median(
+    E1&& e1, std::reference_wrapper<moving_median_state<U>> state)
+{
+    return expression_moving_statistic<moving_median_state<U>, E1, true>(std::forward<E1>(e1), state);
+}
+
+/**
+ * @brief Returns template expression that computes the moving variance of the input
+ * @param e1 an input expression
+ * @param state State (taken by reference)
+ */
+template <typename E1, typename U>
+KFR_INTRINSIC expression_moving_statistic<moving_variance_state<U>, E1, true> moving_variance(
+    E1&& e1, std::reference_wrapper<moving_variance_state<U>> state)
+{
+    return expression_moving_statistic<moving_variance_state<U>, E1, true>(std::forward<E1>(e1), state);
+}
+
+} // namespace KFR_ARCH_NAME
+
+} // namespace kfr
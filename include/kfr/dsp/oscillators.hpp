@@ -27,8 +27,14 @@
 
 #include "../base/basic_expressions.hpp"
 #include "../base/simd_expressions.hpp"
+#include "../base/univector.hpp"
 #include "../math/sin_cos.hpp"
+#include "../simd/horizontal.hpp"
+#include "../simd/read_write.hpp"
 #include "../simd/round.hpp"
+#include "../simd/select.hpp"
+#include <cmath>
+#include <vector>
 
 namespace kfr
 {
@@ -280,6 +286,212 @@ KFR_FUNCTION expression_function<fn::isawtoothnorm, E1> isawtoothnorm(E1&& x)
 {
     return { fn::isawtoothnorm(), std::forward<E1>(x) };
 }
+
+/**
+ * @brief Bank of sine oscillators (partials) summed into one output or written to one output per partial
+ *
+ * Each partial is the complex phasor rotated by e^(j·2π·frequency) every sample, its output is
+ * amplitude·sin(phase). Rotation costs 4 multiplications and 2 additions per sample instead of a sine, the
+ * only transcendental functions are evaluated in set, set_frequency and set_amplitude. Partials are
+ * processed in SIMD lanes, the phasors are renormalized every block of 64 samples to cancel the drift of
+ * the magnitude caused by rounding.
+ *
+ * Frequency and amplitude change either instantly or linearly over the ramp of the given number of samples
+ * (the rotation is multiplied by the constant step rotation during the frequency ramp).
+ */
+template <typename T>
+class oscillator_bank
+{
+public:
+    /// @param partials number of the oscillators, all have zero frequency and amplitude
+    explicit oscillator_bank(size_t partials)
+        : partials(partials), padded(align_up(partials, width)), re(padded, T(1)), im(padded, T(0)),
+          rotation_re(padded, T(1)), rotation_im(padded, T(0)), step_re(padded, T(1)), step_im(padded, T(0)),
+          frequency_left(padded, T(0)), amplitude(padded, T(0)), amplitude_step(padded, T(0)),
+          amplitude_left(padded, T(0)), target_frequency(padded, T(0)), target_amplitude(padded, T(0)),
+          frequency_ramp(padded, false), amplitude_ramp(padded, false)
+    {
+    }
+
+    /// Number of the partials
+    size_t size() const { return partials; }
+
+    /// @brief Sets the partial instantly
+    /// @param frequency normalized frequency (frequency_Hz / samplerate_Hz)
+    /// @param amplitude amplitude
+    /// @param phase phase of the sine in radians
+    void set(size_t partial, T frequency, T amplitude, T phase = 0)
+    {
+        set_frequency(partial, frequency);
+        set_amplitude(partial, amplitude);
+        re[partial] = std::cos(phase);
+        im[partial] = std::sin(phase);
+    }
+
+    /// @brief Changes the frequency of the partial linearly over @p ramp samples (instantly if 0)
+    void set_frequency(size_t partial, T frequency, size_t ramp = 0)
+    {
+        const T omega            = c_pi<T, 2> * frequency;
+        target_frequency[partial] = frequency;
+        if (ramp == 0)
+        {
+            rotation_re[partial]    = std::cos(omega);
+            rotation_im[partial]    = std::sin(omega);
+            frequency_left[partial] = 0;
+            frequency_ramp[partial] = false;
+        }
+        else
+        {
+            const T current         = std::atan2(rotation_im[partial], rotation_re[partial]);
+            step_re[partial]        = std::cos((omega - current) / ramp);
+            step_im[partial]        = std::sin((omega - current) / ramp);
+            frequency_left[partial] = T(ramp);
+            frequency_ramp[partial] = true;
+        }
+    }
+
+    /// @brief Changes the amplitude of the partial linearly over @p ramp samples (instantly if 0)
+    void set_amplitude(size_t partial, T amplitude, size_t ramp = 0)
+    {
+        target_amplitude[partial] = amplitude;
+        if (ramp == 0)
+        {
+            this->amplitude[partial] = amplitude;
+            amplitude_left[partial]  = 0;
+            amplitude_ramp[partial]  = false;
+        }
+        else
+        {
+            amplitude_step[partial] = (amplitude - this->amplitude[partial]) / ramp;
+            amplitude_left[partial] = T(ramp);
+            amplitude_ramp[partial] = true;
+        }
+    }
+
+    /// @brief Computes the sum of all partials
+    void process(T* out, size_t count)
+    {
+        for (size_t done = 0; done < count; done += block)
+        {
+            const size_t chunk = std::min(block, count - done);
+            vec<T, width> sum[block];
+            for (size_t i = 0; i < chunk; ++i)
+                sum[i] = 0;
+            for (size_t p = 0; p < padded; p += width)
+                run(p, chunk, [&](size_t i, const vec<T, width>& value) { sum[i] += value; });
+            for (size_t i = 0; i < chunk; ++i)
+                out[done + i] = hadd(sum[i]);
+            finish_block();
+        }
+    }
+
+    /// @brief Computes the partials, @p out[k] receives the partial k
+    void process(T* const* out, size_t count)
+    {
+        for (size_t done = 0; done < count; done += block)
+        {
+            const size_t chunk = std::min(block, count - done);
+            for (size_t p = 0; p < padded; p += width)
+            {
+                const size_t lanes = std::min(width, partials - p);
+                run(p, chunk,
+                    [&](size_t i, const vec<T, width>& value)
+                    {
+                        for (size_t l = 0; l < lanes; ++l)
+                            out[p + l][done + i] = value[l];
+                    });
+            }
+            finish_block();
+        }
+    }
+
+private:
+    constexpr static size_t width = vector_width<T>;
+    constexpr static size_t block = 64;
+
+    // Calls fn(i, output) for the samples of the block, the state of the lanes p..p+width stays in registers
+    template <typename Fn>
+    KFR_INTRINSIC void run(size_t p, size_t count, Fn&& fn)
+    {
+        using V   = vec<T, width>;
+        V x       = read<width>(re.data() + p);
+        V y       = read<width>(im.data() + p);
+        V a       = read<width>(amplitude.data() + p);
+        const V c = read<width>(rotation_re.data() + p);
+        const V s = read<width>(rotation_im.data() + p);
+        const V f_left = read<width>(frequency_left.data() + p);
+        const V a_left = read<width>(amplitude_left.data() + p);
+        if (KFR_LIKELY(hmax(f_left) <= 0 && hmax(a_left) <= 0))
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                fn(i, a * y);
+                const V xn = x * c - y * s;
+                y          = x * s + y * c;
+                x          = xn;
+            }
+        }
+        else
+        {
+            V rc = c, rs = s, fl = f_left, al = a_left;
+            const V sc = read<width>(step_re.data() + p);
+            const V ss = read<width>(step_im.data() + p);
+            const V da = read<width>(amplitude_step.data() + p);
+            for (size_t i = 0; i < count; ++i)
+            {
+                fn(i, a * y);
+                const V xn = x * rc - y * rs;
+                y          = x * rs + y * rc;
+                x          = xn;
+                const mask<T, width> fm = fl > 0;
+                const V rcn             = select(fm, rc * sc - rs * ss, rc);
+                rs                      = select(fm, rc * ss + rs * sc, rs);
+                rc                      = rcn;
+                fl                      = fl - 1;
+                a                       = select(al > 0, a + da, a);
+                al                      = al - 1;
+            }
+            write(rotation_re.data() + p, rc);
+            write(rotation_im.data() + p, rs);
+            write(frequency_left.data() + p, max(fl, T(0)));
+            write(amplitude_left.data() + p, max(al, T(0)));
+        }
+        write(re.data() + p, x);
+        write(im.data() + p, y);
+        write(amplitude.data() + p, a);
+    }
+
+    // Renormalizes the phasors, completed ramps are snapped to the exact targets
+    void finish_block()
+    {
+        for (size_t p = 0; p < padded; p += width)
+        {
+            const vec<T, width> x = read<width>(re.data() + p);
+            const vec<T, width> y = read<width>(im.data() + p);
+            // One step of Newton's method for 1 / sqrt(x² + y²), which is close to 1
+            const vec<T, width> k = (T(3) - (x * x + y * y)) * T(0.5);
+            write(re.data() + p, x * k);
+            write(im.data() + p, y * k);
+        }
+        for (size_t i = 0; i < partials; ++i)
+        {
+            if (frequency_ramp[i] && frequency_left[i] <= 0)
+                set_frequency(i, target_frequency[i]);
+            if (amplitude_ramp[i] && amplitude_left[i] <= 0)
+                set_amplitude(i, target_amplitude[i]);
+        }
+    }
+
+    size_t partials;
+    size_t padded;
+    univector<T> re, im;
+    univector<T> rotation_re, rotation_im;
+    univector<T> step_re, step_im;
+    univector<T> frequency_left;
+    univector<T> amplitude, amplitude_step, amplitude_left;
+    univector<T> target_frequency, target_amplitude;
+    std::vector<bool> frequency_ramp, amplitude_ramp; /**< Ramps not yet snapped to the targets. */
+};
 } // namespace KFR_ARCH_NAME
 
 } // namespace kfr
@@ -32,7 +32,9 @@
 #include "../math/sqrt.hpp"
 #include "../simd/impl/function.hpp"
 #include "../simd/vec.hpp"
+#include "fir.hpp"
 #include "window.hpp"
+#include <vector>
 
 namespace kfr
 {
@@ -275,13 +277,100 @@ public:
     size_t order; /**< Filter order. */
     itype interpolation_factor; /**< Interpolation factor. */
     itype decimation_factor; /**< Decimation factor. */
-    univector<T> filter; /**< Filter coefficients. */
+    univector<T> filter; /**< Filter coefficients, taps of each phase are contiguous. */
     univector<T> delay; /**< Delay line buffer. */
+    univector<itype> phase_input; /**< First input sample of each of interpolation_factor outputs. */
+    univector<itype> phase_offset; /**< Offset of the taps of each of interpolation_factor outputs. */
+    univector<T> joined; /**< Delay line joined with the beginning or the end of the input. */
 
 protected:
     itype input_position; /**< Current input position. */
     itype output_position; /**< Current output position. */
 
+    /**
+     * @brief Number of outputs of each phase processed before moving on to the next phase.
+     */
+    constexpr static itype phase_block = 32;
+
+    /**
+     * @brief Returns the first input sample read by an output, relative to the input position.
+     * @param output_index Index of the output in the current block. The result is nondecreasing in it.
+     */
+    KFR_MEM_INTRINSIC itype window_start(itype output_index) const
+    {
+        const std::lldiv_t n = floor_div(output_position + output_index, interpolation_factor);
+        return phase_input[size_t(n.rem)] + n.quot * decimation_factor - input_position;
+    }
+
+    /**
+     * @brief Returns the index of the first of output_size outputs whose window starts at or after position.
+     */
+    itype first_output(itype position, itype output_size) const
+    {
+        itype lo = 0, hi = output_size;
+        while (lo < hi)
+        {
+            const itype mid = lo + (hi - lo) / 2;
+            if (window_start(mid) < position)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    /**
+     * @brief Visits the outputs from..to grouped by phase.
+     *
+     * Calls fn(index, count, window_start(index), taps) for each phase, where the outputs index,
+     * index + interpolation_factor, ... (count of them) share the taps. Outputs are visited in blocks of
+     * phase_block outputs per phase, so the taps of a phase are reused while they are in cache.
+     */
+    template <typename Fn>
+    void for_each_phase(itype from, itype to, Fn&& fn) const
+    {
+        const itype phases = interpolation_factor;
+        for (itype block = from; block < to; block += phase_block * phases)
+        {
+            const itype block_end = std::min(to, block + phase_block * phases);
+            for (itype i = block; i < std::min(block_end, block + phases); ++i)
+            {
+                const itype r = floor_div(output_position + i, phases).rem;
+                fn(i, (block_end - i + phases - 1) / phases, window_start(i),
+                   filter.data() + phase_offset[size_t(r)]);
+            }
+        }
+    }
+
+    /**
+     * @brief Splits output_size outputs by the location of their windows.
+     *
+     * Windows that overlap the delay line or run past the end of the input are read from joined after
+     * fill(offset) has stored there 2·depth samples of the delay line followed by the input, starting at
+     * the input sample offset - depth (zeros past the end of the input). Calls run(from, to, shift, joined)
+     * for the outputs from..to whose windows start at window_start(i) + shift in joined or in the input.
+     * @return Number of outputs processed, the windows of the remaining outputs are past the input.
+     */
+    template <typename Fill, typename Run>
+    itype process_windows(itype output_size, itype input_size, Fill&& fill, Run&& run) const
+    {
+        const itype head_end = first_output(0, output_size);
+        const itype body_end = std::max(head_end, first_output(input_size - depth + 1, output_size));
+        const itype tail_end = std::max(head_end, first_output(input_size, output_size));
+        if (head_end > 0)
+        {
+            fill(itype(0));
+            run(itype(0), head_end, depth, true);
+        }
+        run(head_end, body_end, itype(0), false);
+        if (tail_end > body_end)
+        {
+            fill(input_size);
+            run(body_end, tail_end, depth - input_size, true);
+        }
+        return tail_end;
+    }
+
     /**
      * @brief Internal implementation of the process function.
      * @param output Output buffer slice.
@@ -291,6 +380,294 @@ protected:
     size_t process_impl(univector_ref<T> output, univector_ref<const T> input);
 };
 
+/**
+ * @class multichannel_samplerate_converter
+ * @brief Sample rate converter for several channels sharing the same ratio.
+ *
+ * The phase and the taps of each output are computed once and applied to all channels. Interleaved input
+ * is processed with the channels in the SIMD lanes. Only real sample types are supported.
+ *
+ * @tparam T The data type of the audio samples (float or double).
+ */
+template <typename T>
+struct multichannel_samplerate_converter : public samplerate_converter<T>
+{
+    using itype = typename samplerate_converter<T>::itype;
+    using ftype = typename samplerate_converter<T>::ftype;
+
+    /**
+     * @brief Constructs a multichannel sample rate converter.
+     * @param quality The desired conversion quality.
+     * @param interpolation_factor Factor by which to interpolate the input signal.
+     * @param decimation_factor Factor by which to decimate the output signal.
+     * @param channels Number of channels.
+     * @param scale Scaling factor for the output (default: 1).
+     * @param cutoff Cutoff frequency as a fraction of the Nyquist frequency (default: 0.5).
+     */
+    multichannel_samplerate_converter(sample_rate_conversion_quality quality, itype interpolation_factor,
+                                      itype decimation_factor, size_t channels, ftype scale = ftype(1),
+                                      ftype cutoff = 0.5f)
+        : samplerate_converter<T>(quality, interpolation_factor, decimation_factor, scale, cutoff),
+          channels(channels), scratch_outputs(channels), scratch_inputs(channels)
+    {
+        this->delay  = univector<T>(size_t(this->depth) * channels, T());
+        this->joined = univector<T>(size_t(2 * this->depth) * channels, T());
+    }
+
+    multichannel_samplerate_converter() = default;
+    multichannel_samplerate_converter(multichannel_samplerate_converter&&) noexcept = default;
+    multichannel_samplerate_converter& operator=(multichannel_samplerate_converter&&) noexcept = default;
+
+    /**
+     * @brief Processes planar channels (pull or push method).
+     * @param output Pointers to the output channels, output_size samples each.
+     * @param output_size Number of output samples per channel.
+     * @param input Pointers to the input channels.
+     * @param input_size Number of samples available in each input channel.
+     * @return Number of input samples per channel processed.
+     */
+    size_t process(T* const* output, size_t output_size, const T* const* input, size_t input_size);
+
+    /**
+     * @brief Processes interleaved channels (pull or push method).
+     * @param output Interleaved output, output_size frames.
+     * @param output_size Number of output frames.
+     * @param input Interleaved input.
+     * @param input_size Number of frames available in the input.
+     * @return Number of input frames processed.
+     */
+    size_t process_interleaved(T* output, size_t output_size, const T* input, size_t input_size);
+
+    size_t skip(size_t output_size, univector_ref<const T> input) = delete;
+
+    size_t channels = 0;                  /**< Number of channels, delay holds their history interleaved. */
+    univector<T> scratch;                 /**< Deinterleaved channels if they don't fill the vectors. */
+    std::vector<T*> scratch_outputs;      /**< Output channels in scratch, one pointer per channel. */
+    std::vector<const T*> scratch_inputs; /**< Input channels in scratch, one pointer per channel. */
+};
+
+/**
+ * @enum sinc_interpolation
+ * @brief Interpolation of the filter coefficients between the phases of the oversampled sinc table.
+ */
+enum class sinc_interpolation
+{
+    linear, /**< Linear interpolation, 2 multiply-adds per tap. */
+    cubic /**< 4-point Lagrange interpolation, 4 multiply-adds per tap, needs far fewer phases. */
+};
+
+/**
+ * @class variable_samplerate_converter
+ * @brief Asynchronous sample rate converter with a ratio that may change at any time.
+ *
+ * Each output is computed at an arbitrary fractional input position with the windowed sinc filter
+ * interpolated from a table oversampled by the given number of phases, so the cost per output is fixed
+ * by the quality and changing the ratio does not allocate or recompute anything. The cutoff is set for
+ * the ratio passed to the constructor; lower ratios set later alias more.
+ *
+ * Input is pushed in blocks of any size, each output is delayed by latency() input samples.
+ *
+ * @tparam T The data type of the audio samples (float or double).
+ */
+template <typename T>
+struct variable_samplerate_converter
+{
+    using itype = i64; /**< Integer type for positions. */
+
+    /**
+     * @brief Constructs a variable sample rate converter.
+     * @param quality The desired conversion quality, sets the number of taps.
+     * @param ratio Initial output to input sample rate ratio, also sets the cutoff.
+     * @param interpolation Interpolation of the coefficients between the phases.
+     * @param phases Number of phases of the table, 0 selects 512 for linear and 64 for cubic interpolation.
+     */
+    variable_samplerate_converter(sample_rate_conversion_quality quality, double ratio,
+                                  sinc_interpolation interpolation = sinc_interpolation::cubic,
+                                  size_t phases = 0);
+
+    variable_samplerate_converter()                                                    = default;
+    variable_samplerate_converter(variable_samplerate_converter&&) noexcept            = default;
+    variable_samplerate_converter& operator=(variable_samplerate_converter&&) noexcept = default;
+
+    /**
+     * @brief Changes the output to input sample rate ratio, takes effect from the next output.
+     */
+    void set_ratio(double ratio)
+    {
+        KFR_LOGIC_CHECK(ratio > 0, "variable_samplerate_converter: ratio must be positive");
+        step = 1.0 / ratio;
+    }
+
+    /**
+     * @brief Returns the current output to input sample rate ratio.
+     */
+    double ratio() const { return 1.0 / step; }
+
+    /**
+     * @brief Number of input samples after the time of an output that must be pushed to produce it.
+     *
+     * The output k is the input interpolated at the time Σ 1/ratio of all previous outputs, there is no
+     * delay other than this lookahead.
+     */
+    size_t latency() const { return depth / 2; }
+
+    /**
+     * @brief Returns the maximum number of outputs produced by pushing input_size samples at the current
+     * ratio.
+     */
+    size_t max_output_size(size_t input_size) const
+    {
+        const double span = double(filled + input_size) - double(depth / 2) - position;
+        return span > 0 ? static_cast<size_t>(std::ceil(span / step)) + 1 : 0;
+    }
+
+    /**
+     * @brief Clears the history.
+     */
+    void reset()
+    {
+        std::fill(history.begin(), history.end(), T(0));
+        filled   = depth / 2 - 1;
+        position = filled;
+    }
+
+    /**
+     * @brief Pushes the input and writes all the outputs that can be computed.
+     * @param output Output buffer of at least max_output_size(input_size) samples.
+     * @param input Input samples.
+     * @param input_size Number of input samples.
+     * @return Number of outputs written.
+     */
+    size_t process(T* output, const T* input, size_t input_size);
+
+    /**
+     * @brief Pushes the input and appends the outputs to a univector.
+     * @return Number of outputs appended.
+     */
+    template <univector_tag Tag>
+    size_t process(univector<T, Tag>& output, univector_ref<const T> input)
+    {
+        const size_t size = output.size();
+        output.resize(size + max_output_size(input.size()));
+        const size_t count = process(output.data() + size, input.data(), input.size());
+        output.resize(size + count);
+        return count;
+    }
+
+    size_t depth = 0; /**< Number of taps. */
+    size_t phases = 0; /**< Number of phases of the table. */
+    sinc_interpolation interpolation = sinc_interpolation::cubic; /**< Interpolation between phases. */
+    univector<T> table; /**< Polynomial coefficients of the taps for each phase. */
+    univector<T> history; /**< Last input samples. */
+
+protected:
+    double step     = 1; /**< Input samples per output. */
+    double position = 0; /**< Position of the next output in history, in input samples. */
+    size_t filled   = 0; /**< Number of samples in history. */
+
+    void init(sample_rate_conversion_quality quality, double ratio);
+};
+
+/**
+ * @class multistage_samplerate_converter
+ * @brief Sample rate converter for large ratios, a cascade of halfband stages and one fractional stage.
+ *
+ * The ratio is factored into powers of two, each converted by a halfband filter (every other tap is
+ * zero), and the remaining ratio between 1 and 2, converted by samplerate_converter. Decimation runs the
+ * halfband stages first, interpolation runs them last, so each halfband filter only has to keep the
+ * band of the lower sample rate free of aliases or images: the transition is wide at the high rates and
+ * the filters are short. The length of each stage is estimated for the attenuation of the quality.
+ *
+ * @tparam T The data type of the audio samples (float or double).
+ */
+template <typename T>
+struct multistage_samplerate_converter
+{
+    using itype = i64; /**< Integer type for the factors. */
+
+    /**
+     * @brief Constructs a multistage converter.
+     * @param quality The desired conversion quality.
+     * @param interpolation_factor Factor by which to interpolate the input signal.
+     * @param decimation_factor Factor by which to decimate the output signal.
+     */
+    multistage_samplerate_converter(sample_rate_conversion_quality quality, itype interpolation_factor,
+                                    itype decimation_factor);
+
+    multistage_samplerate_converter()                                                      = default;
+    multistage_samplerate_converter(multistage_samplerate_converter&&) noexcept            = default;
+    multistage_samplerate_converter& operator=(multistage_samplerate_converter&&) noexcept = default;
+
+    /**
+     * @brief Returns the number of outputs produced by the next call to process for input_size samples.
+     */
+    size_t output_size_for_input(size_t input_size) const
+    {
+        size_t size = input_size;
+        for (const fir_decimator<T>& stage : decimators)
+            size = stage.output_size_for_input(size);
+        if (fractional)
+            size = fractional_output_size(pending_size + size);
+        return size << interpolators.size();
+    }
+
+    /**
+     * @brief Converts the input (push method).
+     * @param output Output buffer of at least output_size_for_input(input_size) samples.
+     * @return Number of outputs written.
+     */
+    size_t process(T* output, const T* input, size_t input_size);
+
+    /**
+     * @brief Converts the input and returns the output (push method).
+     */
+    univector<T> process(univector_ref<const T> input)
+    {
+        univector<T> output(output_size_for_input(input.size()));
+        process(output.data(), input.data(), input.size());
+        return output;
+    }
+
+    /**
+     * @brief Gets the delay of the cascade in output samples.
+     */
+    double get_fractional_delay() const { return delay; }
+
+    std::vector<size_t> halfband_taps; /**< Number of taps of each halfband stage, in processing order. */
+    std::vector<fir_decimator<T>> decimators; /**< Halfband decimators, run before the converter. */
+    std::vector<halfband_interpolator<T>> interpolators; /**< Halfband interpolators, run after it. */
+    samplerate_converter<T> converter; /**< Fractional stage. */
+    bool fractional = false; /**< Whether the fractional stage is used. */
+
+protected:
+    univector<T> buffers[2]; /**< Outputs of the intermediate stages. */
+    univector<T> pending; /**< Input of the fractional stage, not consumed yet. */
+    size_t pending_size = 0; /**< Number of samples in pending. */
+    double delay = 0; /**< Delay in output samples. */
+
+    /**
+     * @brief Delay of the fractional stage in its output samples, the center of its filter is half an
+     * intermediate sample before (taps - 1) / 2.
+     */
+    double fractional_delay() const
+    {
+        return converter.get_fractional_delay() - 0.5 / converter.decimation_factor;
+    }
+
+    /**
+     * @brief Number of outputs of the fractional stage computable from input_size samples.
+     */
+    size_t fractional_output_size(size_t input_size) const
+    {
+        itype count = converter.output_size_for_input(itype(input_size)) + 1;
+        while (count > 0 && converter.input_size_for_output(count) > itype(input_size))
+            --count;
+        return size_t(count);
+    }
+
+    void init(sample_rate_conversion_quality quality, itype interpolation_factor, itype decimation_factor);
+};
+
 inline namespace KFR_ARCH_NAME
 {
 
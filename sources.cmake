@@ -21,10 +21,14 @@ set(
     ${PROJECT_SOURCE_DIR}/include/kfr/config.h
     ${PROJECT_SOURCE_DIR}/include/kfr/kfr.h
     ${PROJECT_SOURCE_DIR}/include/kfr/multiarch.h
+    ${PROJECT_SOURCE_DIR}/include/kfr/audio/biquad.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/audio/data.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/audio/decoder.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/audio/dynamics.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/audio/encoder.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/audio/io.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/audio/mixer.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/audio/resampler.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/base/basic_expressions.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/base/conversion.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/base/endianness.hpp
@@ -48,21 +52,28 @@ set(
     ${PROJECT_SOURCE_DIR}/include/kfr/base/transpose.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/base/univector.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/base/impl/static_array.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/dft/analytic.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dft/cache.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dft/convolution.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dft/fft.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/dft/fir_auto.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/dft/minimum_phase.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/dft/psd.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dft/reference_dft.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/biquad.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/biquad_design.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/dcremove.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/delay.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/dsp/dynamics.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/ebu.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/fir.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/fir_design.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/goertzel.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/dsp/hilbert.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/iir.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/iir_design.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/mixdown.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/dsp/moving_stats.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/oscillators.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/sample_rate_conversion.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/speaker.hpp
@@ -265,13 +276,16 @@ set(
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/biquad_design.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/dcremove.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/delay.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/dsp/dynamics.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/ebu.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/fir.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/fir_design.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/goertzel.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/dsp/hilbert.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/iir.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/iir_design.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/mixdown.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/dsp/moving_stats.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/oscillators.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/sample_rate_conversion.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/dsp/speaker.hpp
@@ -294,10 +308,14 @@ set(
     
 set(
     KFR_AUDIO_HDR
+    ${PROJECT_SOURCE_DIR}/include/kfr/audio/biquad.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/audio/data.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/audio/decoder.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/audio/dynamics.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/audio/encoder.hpp
     ${PROJECT_SOURCE_DIR}/include/kfr/audio/io.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/audio/mixer.hpp
+    ${PROJECT_SOURCE_DIR}/include/kfr/audio/resampler.hpp
 )
 
     
@@ -323,7 +341,9 @@ set(
 set(
     KFR_DSP_SRC
     ${PROJECT_SOURCE_DIR}/src/dsp/biquad.cpp
+    ${PROJECT_SOURCE_DIR}/src/dsp/dynamics.cpp
     ${PROJECT_SOURCE_DIR}/src/dsp/fir.cpp
+    ${PROJECT_SOURCE_DIR}/src/dsp/fir_design.cpp
     ${PROJECT_SOURCE_DIR}/src/dsp/iir_design.cpp
     ${PROJECT_SOURCE_DIR}/src/dsp/sample_rate_conversion.cpp
     ${PROJECT_SOURCE_DIR}/src/dsp/speaker.cpp
@@ -381,10 +401,12 @@ set(
     ${PROJECT_SOURCE_DIR}/tests/unit/dsp/dcremove.cpp
     ${PROJECT_SOURCE_DIR}/tests/unit/dsp/delay.cpp
     ${PROJECT_SOURCE_DIR}/tests/unit/dsp/dsp.cpp
+    ${PROJECT_SOURCE_DIR}/tests/unit/dsp/dynamics.cpp
     ${PROJECT_SOURCE_DIR}/tests/unit/dsp/ebu.cpp
     ${PROJECT_SOURCE_DIR}/tests/unit/dsp/fir.cpp
     ${PROJECT_SOURCE_DIR}/tests/unit/dsp/goertzel.cpp
     ${PROJECT_SOURCE_DIR}/tests/unit/dsp/mixdown.cpp
+    ${PROJECT_SOURCE_DIR}/tests/unit/dsp/moving_stats.cpp
     ${PROJECT_SOURCE_DIR}/tests/unit/dsp/oscillators.cpp
     ${PROJECT_SOURCE_DIR}/tests/unit/dsp/sample_rate_conversion.cpp
     ${PROJECT_SOURCE_DIR}/tests/unit/dsp/units.cpp
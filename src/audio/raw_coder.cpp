@@ -98,7 +98,7 @@ expected<size_t, audiofile_error> RawDecoder::read_to(const audio_data_interleav
     if (!m_reader)
         return unexpected(audiofile_error::closed);
     // borrowed from RIFF::readPCMAudio
-    size_t framesToRead = default_audio_frames_to_read;
+    size_t framesToRead = data.size;
 
     kfr::univector<std::byte> interleaved(framesToRead * m_format->bytes_per_pcm_frame());
     size_t sz         = m_reader->read(interleaved.data(), interleaved.size());
@@ -568,14 +568,43 @@ KFR_API_SPEC KFR_FILTER_F32* kfr_filter_create_fir_plan_f32(const kfr_f32* taps,
 {
     return try_fn(
         [&]()
-        { return reinterpret_cast<KFR_FILTER_F32*>(new fir_filter<float>(make_univector(taps, size))); },
+        {
+            return reinterpret_cast<KFR_FILTER_F32*>(
+                new fir_auto_filter<float>(make_univector(taps, size), 0, fir_method::automatic));
+        },
         nullptr);
 }
 KFR_API_SPEC KFR_FILTER_F64* kfr_filter_create_fir_plan_f64(const kfr_f64* taps, size_t size)
 {
     return try_fn(
         [&]()
-        { return reinterpret_cast<KFR_FILTER_F64*>(new fir_filter<double>(make_univector(taps, size))); },
+        {
+            return reinterpret_cast<KFR_FILTER_F64*>(
+                new fir_auto_filter<double>(make_univector(taps, size), 0, fir_method::automatic));
+        },
+        nullptr);
+}
+
+KFR_API_SPEC KFR_FILTER_F32* kfr_filter_create_fir_plan_method_f32(const kfr_f32* taps, size_t size,
+                                                                   size_t call_size, KFR_FIR_METHOD method)
+{
+    return try_fn(
+        [&]()
+        {
+            return reinterpret_cast<KFR_FILTER_F32*>(new fir_auto_filter<float>(
+                make_univector(taps, size), call_size, static_cast<fir_method>(method)));
+        },
+        nullptr);
+}
+KFR_API_SPEC KFR_FILTER_F64* kfr_filter_create_fir_plan_method_f64(const kfr_f64* taps, size_t size,
+                                                                   size_t call_size, KFR_FIR_METHOD method)
+{
+    return try_fn(
+        [&]()
+        {
+            return reinterpret_cast<KFR_FILTER_F64*>(new fir_auto_filter<double>(
+                make_univector(taps, size), call_size, static_cast<fir_method>(method)));
+        },
         nullptr);
 }
 
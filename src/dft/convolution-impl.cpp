@@ -26,8 +26,10 @@
 #include <kfr/cident.h>
 #if !defined KFR_SKIP_IF_NON_X86 || defined(KFR_ARCH_X86)
 
+#include <kfr/base/reduce.hpp>
 #include <kfr/base/simd_expressions.hpp>
 #include <kfr/dft/convolution.hpp>
+#include <kfr/math/complex_math.hpp>
 #include <kfr/simd/complex.hpp>
 #include <kfr/multiarch.h>
 
@@ -35,17 +37,19 @@ namespace kfr
 {
 
 template <typename T>
-convolve_filter<T>::convolve_filter(size_t size_, size_t block_size_)
+convolve_filter<T>::convolve_filter(size_t size_, size_t block_size_, bool progressive_)
     : data_size(size_), block_size(next_poweroftwo(block_size_)), fft(2 * block_size), temp(fft.temp_size),
       segments((data_size + block_size - 1) / block_size), position(0), ir_segments(segments.size()),
       saved_input(block_size), input_position(0), premul(fft.csize()), cscratch(fft.csize()),
-      scratch1(fft.size), scratch2(fft.size), overlap(block_size)
+      scratch1(fft.size), scratch2(fft.size), overlap(block_size), progressive(progressive_),
+      premul_next(progressive ? fft.csize() : 0), premul_next_count(0), premul_cost(0)
 {
 }
 
 template <typename T>
-convolve_filter<T>::convolve_filter(const univector_ref<const T>& data, size_t block_size_)
-    : convolve_filter(data.size(), block_size_)
+convolve_filter<T>::convolve_filter(const univector_ref<const T>& data, size_t block_size_,
+                                    bool progressive_)
+    : convolve_filter(data.size(), block_size_, progressive_)
 {
     set_data(data);
 }
@@ -81,6 +85,9 @@ void convolve_filter<T>::reset()
     process(saved_input, zeros());
     input_position = 0;
     process(overlap, zeros());
+    process(premul_next, zeros());
+    // Older history is all zeros, so the products for the first block are already complete.
+    premul_next_count = segments.size() > 2 ? segments.size() - 2 : 0;
 }
 
 //-------------------------------------------------------------------------------------
@@ -94,6 +101,11 @@ KFR_MULTI_PROTO(namespace impl {
     {
     public:
         void process_buffer_impl(T* output, const T* input, size_t size);
+        bool progressive_step_for_impl(std::chrono::nanoseconds budget);
+
+    private:
+        size_t premul_next_total() const { return this->segments.size() > 2 ? this->segments.size() - 2 : 0; }
+        void premul_next_accumulate(size_t target);
     };
 })
 
@@ -131,6 +143,114 @@ template univector<f64> convolve<f64>(const univector_ref<const f64>&, const uni
 template univector<c32> convolve<c32>(const univector_ref<const c32>&, const univector_ref<const c32>&, bool);
 template univector<c64> convolve<c64>(const univector_ref<const c64>&, const univector_ref<const c64>&, bool);
 
+template <typename T>
+univector<T> correlate(const univector_ref<const T>& src1, const univector_ref<const T>& src2, size_t maxlag,
+                       correlation_weighting weighting)
+{
+    const size_t lags = 2 * maxlag + 1;
+    univector<T> result(lags, T(0));
+    if (src1.empty() || src2.empty())
+        return result;
+
+    // result[maxlag + l] = sum src1[i + l] * src2[i]
+    const std::ptrdiff_t size1         = src1.size();
+    const std::ptrdiff_t size2         = src2.size();
+    const std::ptrdiff_t maxlag_signed = maxlag;
+    if (weighting == correlation_weighting::none && lags <= 64)
+    {
+        for (size_t k = 0; k < lags; ++k)
+        {
+            const std::ptrdiff_t l     = static_cast<std::ptrdiff_t>(k) - maxlag_signed;
+            const std::ptrdiff_t first = std::max(std::ptrdiff_t(0), -l);
+            const std::ptrdiff_t last  = std::min(size2, size1 - l);
+            if (first < last)
+                result[k] = dotproduct(src1.slice(first + l, last - first), src2.slice(first, last - first));
+        }
+        return result;
+    }
+
+    // Each block of src2 is correlated with the block of src1 extended by maxlag on both sides,
+    // spectra are accumulated and transformed back once
+    const size_t size  = std::max(next_poweroftwo(4 * (lags - 1)), size_t(64));
+    const size_t block = size - (lags - 1);
+
+    dft_plan_real_ptr<T> dft = dft_cache::instance().getreal(ctype_t<T>(), size);
+    univector<u8> temp(dft->temp_size);
+    univector<T> segment(size);
+    univector<T> padded(size, T(0));
+    univector<complex<T>> spectrum1(size / 2 + 1);
+    univector<complex<T>> spectrum2(size / 2 + 1);
+    univector<complex<T>> accum(size / 2 + 1, complex<T>(0));
+
+    for (size_t offset = 0; offset < src2.size(); offset += block)
+    {
+        const size_t count     = std::min(block, src2.size() - offset);
+        padded.slice(0, count) = src2.slice(offset, count);
+        if (count < block)
+            padded.slice(count, block - count) = zeros();
+
+        // src1[offset - maxlag ... offset + block + maxlag), zero outside
+        const std::ptrdiff_t start = static_cast<std::ptrdiff_t>(offset) - maxlag_signed;
+        const std::ptrdiff_t first = std::max(start, std::ptrdiff_t(0));
+        const std::ptrdiff_t last  = std::min(start + static_cast<std::ptrdiff_t>(size), size1);
+        process(segment, zeros());
+        if (first < last)
+            segment.slice(first - start, last - first) = src1.slice(first, last - first);
+
+        dft->execute(spectrum1, segment, temp);
+        dft->execute(spectrum2, padded, temp);
+        accum = accum + spectrum1 * cconj(spectrum2);
+    }
+    if (weighting == correlation_weighting::phat)
+    {
+        for (complex<T>& x : accum)
+        {
+            const T magnitude = cabs(x);
+            x                 = magnitude > std::numeric_limits<T>::min() ? x / magnitude : complex<T>(0);
+        }
+    }
+    dft->execute(segment, accum, temp);
+    result = segment.slice(0, lags) * reciprocal(static_cast<T>(size));
+    return result;
+}
+template univector<f32> correlate<f32>(const univector_ref<const f32>&, const univector_ref<const f32>&, size_t,
+                                       correlation_weighting);
+template univector<f64> correlate<f64>(const univector_ref<const f64>&, const univector_ref<const f64>&, size_t,
+                                       correlation_weighting);
+
+template <typename T>
+void convolve_filter<T>::premul_next_accumulate(size_t target)
+{
+    const dft_pack_format fft_multiply_pack = this->real_fft ? dft_pack_format::Perm : dft_pack_format::CCs;
+
+    // Y_(k+1-i,i) = H_i * X_(k+1-i) for i=2,...,N
+    // X_(k+1-i) is stored at (position - 1 + i) and stays intact while block k is being filled.
+    for (; this->premul_next_count < target; ++this->premul_next_count)
+    {
+        const size_t i = this->premul_next_count + 2;
+        const size_t n = (this->position + i - 1) % this->segments.size();
+        fft_multiply_accumulate(this->premul_next, this->ir_segments[i], this->segments[n], fft_multiply_pack);
+    }
+}
+
+template <typename T>
+bool convolve_filter<T>::progressive_step_for_impl(std::chrono::nanoseconds budget)
+{
+    using clock = std::chrono::steady_clock;
+    if (!this->progressive || this->premul_next_count >= premul_next_total())
+        return false;
+    return internal_generic::progressive_run_for(
+        budget,
+        [&]()
+        {
+            const clock::time_point start = clock::now();
+            premul_next_accumulate(this->premul_next_count + 1);
+            this->premul_cost = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+            return this->premul_next_count < premul_next_total();
+        },
+        [&]() { return this->premul_cost; });
+}
+
 template <typename T>
 void convolve_filter<T>::process_buffer_impl(T* output, const T* input, size_t size)
 {
@@ -173,7 +293,19 @@ void convolve_filter<T>::process_buffer_impl(T* output, const T* input, size_t s
         else
         {
             // More than one segment/block of history so this is more involved.
-            if (this->input_position == 0)
+            if (this->input_position == 0 && this->progressive)
+            {
+                // Products for i=2,...,N were accumulated while the previous block was being filled,
+                // only the most recent block of history is left.
+
+                // premul = premul_next + H_1 * X_(k-1)
+                fft_multiply_accumulate(this->premul, this->premul_next, this->ir_segments[1],
+                                        this->segments[(this->position + 1) % this->segments.size()],
+                                        fft_multiply_pack);
+                process(this->premul_next, zeros());
+                this->premul_next_count = 0;
+            }
+            else if (this->input_position == 0)
             {
                 // At the start of an input block, we premultiply the history from
                 // previous input blocks with the extended filter blocks.
@@ -206,6 +338,13 @@ void convolve_filter<T>::process_buffer_impl(T* output, const T* input, size_t s
         this->input_position += processing;
         processed += processing;
 
+        if (this->progressive)
+        {
+            // Spread the products for the next block evenly over the current block.
+            premul_next_accumulate((premul_next_total() * this->input_position + this->block_size - 1) /
+                                   this->block_size);
+        }
+
         // If a whole block was processed, prepare for next block.
         if (this->input_position == this->block_size)
         {
@@ -250,6 +389,18 @@ template univector<f64> convolve<f64>(const univector_ref<const f64>&, const uni
 template univector<c32> convolve<c32>(const univector_ref<const c32>&, const univector_ref<const c32>&, bool);
 template univector<c64> convolve<c64>(const univector_ref<const c64>&, const univector_ref<const c64>&, bool);
 
+template <typename T>
+univector<T> correlate(const univector_ref<const T>& src1, const univector_ref<const T>& src2, size_t maxlag,
+                       correlation_weighting weighting)
+{
+    KFR_MULTI_GATE(return ns::impl::correlate(src1, src2, maxlag, weighting));
+}
+
+template univector<f32> correlate<f32>(const univector_ref<const f32>&, const univector_ref<const f32>&, size_t,
+                                       correlation_weighting);
+template univector<f64> correlate<f64>(const univector_ref<const f64>&, const univector_ref<const f64>&, size_t,
+                                       correlation_weighting);
+
 } // namespace internal_generic
 
 template <typename T>
@@ -259,6 +410,13 @@ void convolve_filter<T>::process_buffer(T* output, const T* input, size_t size)
         reinterpret_cast<ns::impl::convolve_filter<T>*>(this)->process_buffer_impl(output, input, size));
 }
 
+template <typename T>
+bool convolve_filter<T>::progressive_step_for(std::chrono::nanoseconds budget)
+{
+    KFR_MULTI_GATE(
+        return reinterpret_cast<ns::impl::convolve_filter<T>*>(this)->progressive_step_for_impl(budget));
+}
+
 template class convolve_filter<float>;
 template class convolve_filter<double>;
 template class convolve_filter<complex<float>>;
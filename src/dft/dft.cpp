@@ -28,6 +28,9 @@
 
 #include <kfr/dft/fft.hpp>
 #include <kfr/multiarch.h>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 namespace kfr
 {
@@ -47,6 +50,36 @@ size_t dft_plan<T>::progressive_total_steps() const
     return stages[0].size();
 }
 
+template <typename T>
+void dft_plan<T>::progressive_calibrate(size_t iterations)
+{
+    using clock = std::chrono::steady_clock;
+    if (!is_initialized())
+        return;
+    univector<complex<T>> buffer(size + 1, complex<T>(0));
+    univector<u8> temp(temp_size);
+    for (bool inverse : { false, true })
+    {
+        const size_t steps = stages[inverse].size();
+        std::vector<std::chrono::nanoseconds> costs(steps, std::chrono::nanoseconds::max());
+        for (size_t iter = 0; iter < std::max(iterations, size_t(1)); ++iter)
+        {
+            progressive prog{};
+            internal_generic::dft_progressive_start(*this, prog, inverse, buffer.data(), buffer.data(),
+                                                    temp.data());
+            for (size_t i = 0; i < steps; ++i)
+            {
+                const clock::time_point start = clock::now();
+                internal_generic::dft_progressive_step(*this, prog);
+                ++prog.step;
+                costs[i] = std::min(costs[i],
+                                    std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start));
+            }
+        }
+        progressive_cost[inverse] = std::move(costs);
+    }
+}
+
 template <typename T>
 void dft_plan<T>::calc_disposition()
 {
@@ -212,6 +245,33 @@ template void dft_progressive_step(const dft_plan<float>& plan,
 template void dft_progressive_step(const dft_plan<double>& plan,
                                    typename dft_plan<double>::progressive& progressive);
 
+template <typename T>
+std::shared_ptr<u8> dft_shared_stage_data(const char* id, size_t key, size_t data_size,
+                                          const std::function<void(u8*)>& init)
+{
+    using store_key = std::tuple<std::string, size_t, size_t>;
+    static std::mutex mutex;
+    static std::map<store_key, std::weak_ptr<u8>> store;
+
+    std::lock_guard<std::mutex> guard(mutex);
+    std::weak_ptr<u8>& entry = store[store_key(id, key, data_size)];
+    if (std::shared_ptr<u8> existing = entry.lock())
+        return existing;
+
+    std::shared_ptr<u8> data(aligned_allocate<u8>(data_size), details::aligned_deleter<u8>());
+    init(data.get());
+    entry = data;
+    // Forget data released by all plans
+    for (auto it = store.begin(); it != store.end();)
+        it = it->second.expired() ? store.erase(it) : std::next(it);
+    return data;
+}
+
+template std::shared_ptr<u8> dft_shared_stage_data<float>(const char*, size_t, size_t,
+                                                          const std::function<void(u8*)>&);
+template std::shared_ptr<u8> dft_shared_stage_data<double>(const char*, size_t, size_t,
+                                                           const std::function<void(u8*)>&);
+
 } // namespace internal_generic
 
 #endif
@@ -855,6 +855,9 @@ struct fft_stage_impl : dft_stage<T>
         this->recursion  = true;
         this->data_size =
             align_up(sizeof(complex<T>) * stage_size / 4 * 3, platform<>::native_cache_alignment);
+        // Twiddles don't depend on the template parameters
+        this->shared_data_id  = dft_name(static_cast<fft_stage_impl<T, false, false>*>(nullptr));
+        this->shared_data_key = stage_size;
     }
 
     constexpr static bool prefetch = fft_config<T>::prefetch;
@@ -895,6 +898,8 @@ struct fft_final_stage_impl : dft_stage<T>
         this->repeats    = 4;
         this->recursion  = true;
         this->data_size  = align_up(sizeof(complex<T>) * size * 3 / 2, platform<>::native_cache_alignment);
+        this->shared_data_id  = this->name;
+        this->shared_data_key = size;
     }
 
     constexpr static size_t width  = fft_config<T>::process_width;
@@ -1017,6 +1022,11 @@ struct fft_autosort_stage_impl : dft_stage<T>
         {
             this->data_size =
                 align_up(sizeof(complex<T>) * stage_size / 4 * 3, platform<>::native_cache_alignment);
+            // Twiddles depend only on the number of blocks, so the stages of plans of different sizes share
+            // them. The id names the type, is_first, the radix 4 and the architecture, which fixes the width
+            this->shared_data_id  = dft_name(
+                static_cast<fft_autosort_stage_impl<T, is_first, false, false>*>(nullptr));
+            this->shared_data_key = this->blocks;
         }
     }
 
@@ -1725,11 +1735,33 @@ KFR_INTRINSIC void initialize_data_stage(dft_plan<T>* self, const dft_stage_ptr<
 template <typename T>
 KFR_INTRINSIC size_t initialize_data(dft_plan<T>* self)
 {
-    self->data    = autofree<u8>(self->data_size);
+    // Twiddles that depend only on the stage parameters are stored once for all plans
+    self->data_size = 0;
+    for (dft_stage_ptr<T>& stage : self->all_stages)
+    {
+        if (!stage->shared_data_id)
+            self->data_size += stage->data_size;
+    }
+    self->data = autofree<u8>(self->data_size);
+    self->shared_data.clear();
     size_t offset = 0;
     for (dft_stage_ptr<T>& stage : self->all_stages)
     {
-        initialize_data_stage(self, stage, offset);
+        if (stage->shared_data_id && stage->data_size > 0)
+        {
+            self->shared_data.push_back(internal_generic::dft_shared_stage_data<T>(
+                stage->shared_data_id, stage->shared_data_key, stage->data_size,
+                [&](u8* data)
+                {
+                    stage->data = data;
+                    stage->initialize(self->size);
+                }));
+            stage->data = self->shared_data.back().get();
+        }
+        else
+        {
+            initialize_data_stage(self, stage, offset);
+        }
     }
     return offset;
 }
@@ -28,6 +28,10 @@
 
 #include <kfr/multiarch.h>
 #include <kfr/dsp/biquad.hpp>
+#include <kfr/simd/horizontal.hpp>
+#include <cmath>
+#include <limits>
+#include <thread>
 
 namespace kfr
 {
@@ -35,6 +39,37 @@ namespace kfr
 KFR_MULTI_PROTO(namespace impl {
     template <typename T>
     expression_handle<T, 1> create_iir_filter(const iir_params<T>& params);
+
+    template <typename T>
+    void update_iir_filter(expression_handle<T, 1>& handle, const biquad_section<T>* sections, size_t count);
+
+    template <typename T>
+    class multichannel_biquad : public kfr::multichannel_biquad<T>
+    {
+    public:
+        void process(T* const* output, const T* const* input, size_t frames);
+        void process_interleaved(T* output, const T* input, size_t frames);
+
+    protected:
+        template <typename Load, typename Store>
+        void process_groups(size_t frames, Load&& load, Store&& store);
+    };
+
+    template <typename T>
+    class iir_block_filter : public kfr::iir_block_filter<T>
+    {
+    public:
+        void process_buffer_impl(T* dest, const T* src, size_t size);
+        void process_expression_impl(T* dest, const expression_handle<T, 1>& src, size_t size);
+    };
+
+    template <typename T>
+    class parallel_sos_filter : public kfr::parallel_sos_filter<T>
+    {
+    public:
+        void process_buffer_impl(T* dest, const T* src, size_t size);
+        void process_expression_impl(T* dest, const expression_handle<T, 1>& src, size_t size);
+    };
 } // namespace impl
 )
 
@@ -49,6 +84,278 @@ expression_handle<T, 1> create_iir_filter(const iir_params<T>& params)
 }
 template expression_handle<float, 1> create_iir_filter<float>(const iir_params<float>& params);
 template expression_handle<double, 1> create_iir_filter<double>(const iir_params<double>& params);
+
+template <typename T>
+void update_iir_filter(expression_handle<T, 1>& handle, const biquad_section<T>* sections, size_t count)
+{
+    // Same dispatch as in iir(), so the type of the expression is known
+    cswitch(internal_generic::biquad_sizes, next_poweroftwo(count),
+            [&](auto x)
+            {
+                constexpr size_t filters = x;
+                using expression         = expression_iir<filters, T, decltype(placeholder<T>())>;
+                static_cast<expression*>(handle.instance)->state->params =
+                    iir_params<T, filters>(sections, count);
+            });
+}
+template void update_iir_filter<float>(expression_handle<float, 1>&, const biquad_section<float>*, size_t);
+template void update_iir_filter<double>(expression_handle<double, 1>&, const biquad_section<double>*, size_t);
+
+/// Applies the sections to frames of N channels, in place: x[f·stride + l] is the sample of the lane l
+/// Each section runs over all frames before the next one, so its coefficients and state stay in registers
+template <size_t N, typename T>
+KFR_INTRINSIC void multichannel_biquad_kernel(T* x, size_t stride, size_t frames, const T* coefs, T* state,
+                                              size_t sections)
+{
+    for (size_t s = 0; s < sections; ++s, coefs += 5 * N, state += 2 * N)
+    {
+        const vec<T, N> a1 = read<N>(coefs);
+        const vec<T, N> a2 = read<N>(coefs + N);
+        const vec<T, N> b0 = read<N>(coefs + 2 * N);
+        const vec<T, N> b1 = read<N>(coefs + 3 * N);
+        const vec<T, N> b2 = read<N>(coefs + 4 * N);
+        vec<T, N> s1       = read<N>(state);
+        vec<T, N> s2       = read<N>(state + N);
+        T* p               = x;
+        for (size_t f = 0; f < frames; ++f, p += stride)
+        {
+            const vec<T, N> in  = read<N>(p);
+            const vec<T, N> out = fmadd(b0, in, s1);
+            s1                  = fmadd(b1, in, s2) - a1 * out;
+            s2                  = b2 * in - a2 * out;
+            write(p, out);
+        }
+        write(state, s1);
+        write(state + N, s2);
+    }
+}
+
+template <typename T>
+template <typename Load, typename Store>
+void multichannel_biquad<T>::process_groups(size_t frames, Load&& load, Store&& store)
+{
+    const size_t lanes    = this->lanes;
+    const size_t sections = this->section_count;
+    for (size_t offset = 0; offset < frames; offset += this->block_frames)
+    {
+        const size_t count = std::min(frames - offset, size_t(this->block_frames));
+        for (size_t first = 0; first < this->channel_count; first += lanes)
+        {
+            const size_t group = first / lanes;
+            const size_t used  = std::min(lanes, this->channel_count - first);
+            T* x               = load(this->block.data(), offset, count, first, used);
+            const T* coefs     = this->coefs.data() + group * sections * 5 * lanes;
+            T* state           = this->state.data() + group * sections * 2 * lanes;
+            const size_t step  = x == this->block.data() ? lanes : this->channel_count;
+            cswitch(csizes<2, 4, 8, 16, 32, 64>, lanes,
+                    [&](auto n)
+                    {
+                        constexpr size_t N = val_of(decltype(n)());
+                        multichannel_biquad_kernel<N>(x, step, count, coefs, state, sections);
+                    });
+            store(x, offset, count, first, used);
+        }
+    }
+}
+
+template <typename T>
+void multichannel_biquad<T>::process(T* const* output, const T* const* input, size_t frames)
+{
+    const size_t lanes = this->lanes;
+    process_groups(
+        frames,
+        [&](T* block, size_t offset, size_t count, size_t first, size_t used)
+        {
+            for (size_t c = 0; c < used; ++c)
+                for (size_t f = 0; f < count; ++f)
+                    block[f * lanes + c] = input[first + c][offset + f];
+            return block;
+        },
+        [&](const T* block, size_t offset, size_t count, size_t first, size_t used)
+        {
+            for (size_t c = 0; c < used; ++c)
+                for (size_t f = 0; f < count; ++f)
+                    output[first + c][offset + f] = block[f * lanes + c];
+        });
+}
+
+template <typename T>
+void multichannel_biquad<T>::process_interleaved(T* output, const T* input, size_t frames)
+{
+    const size_t lanes    = this->lanes;
+    const size_t channels = this->channel_count;
+    process_groups(
+        frames,
+        [&](T* block, size_t offset, size_t count, size_t first, size_t used) -> T*
+        {
+            // Complete groups are filtered in the output
+            if (used == lanes)
+            {
+                T* x = output + offset * channels + first;
+                if (output != input)
+                    for (size_t f = 0; f < count; ++f)
+                        std::copy_n(input + (offset + f) * channels + first, lanes, x + f * channels);
+                return x;
+            }
+            for (size_t f = 0; f < count; ++f)
+                std::copy_n(input + (offset + f) * channels + first, used, block + f * lanes);
+            return block;
+        },
+        [&](const T* x, size_t offset, size_t count, size_t first, size_t used)
+        {
+            if (used == lanes)
+                return;
+            for (size_t f = 0; f < count; ++f)
+                std::copy_n(x + f * lanes, used, output + (offset + f) * channels + first);
+        });
+}
+
+template class multichannel_biquad<float>;
+template class multichannel_biquad<double>;
+
+/// Applies one section to x in place, N samples at a time, the remainder of size one by one
+template <size_t N, typename T>
+KFR_INTRINSIC void iir_block_kernel(T* x, size_t size, const biquad_section<T>& bq, const T* m, const T* p,
+                                    T* state)
+{
+    const vec<T, N> r1 = read<N>(m);
+    const vec<T, N> r2 = read<N>(m + N);
+    T s1               = state[0];
+    T s2               = state[1];
+    size_t i           = 0;
+    for (; i + N <= size; i += N)
+    {
+        T* b = x + i;
+        // Response to the input, independent of the state
+        vec<T, N> acc0 = read<N>(m + 2 * N) * b[0];
+        vec<T, N> acc1 = read<N>(m + 3 * N) * b[1];
+        for (size_t j = 2; j < N; j += 2)
+        {
+            acc0 = fmadd(read<N>(m + (2 + j) * N), b[j], acc0);
+            acc1 = fmadd(read<N>(m + (3 + j) * N), b[j + 1], acc1);
+        }
+        const vec<T, N> acc = acc0 + acc1;
+        // Contribution of the input to the state at the end of the block
+        const T u1 = b[N - 2];
+        const T u2 = b[N - 1];
+        const T y1 = acc[N - 2];
+        const T y2 = acc[N - 1];
+        const T g1 = bq.b2 * u1 + bq.b1 * u2 - bq.a2 * y1 - bq.a1 * y2;
+        const T g2 = bq.b2 * u2 - bq.a2 * y2;
+        write(b, acc + r1 * s1 + r2 * s2);
+        const T next = p[0] * s1 + p[1] * s2 + g1;
+        s2           = p[2] * s1 + p[3] * s2 + g2;
+        s1           = next;
+    }
+    for (; i < size; ++i)
+    {
+        const T in  = x[i];
+        const T out = bq.b0 * in + s1;
+        s1          = s2 + bq.b1 * in - bq.a1 * out;
+        s2          = bq.b2 * in - bq.a2 * out;
+        x[i]        = out;
+    }
+    state[0] = s1;
+    state[1] = s2;
+}
+
+template <typename T>
+void iir_block_filter<T>::process_buffer_impl(T* dest, const T* src, size_t size)
+{
+    // Chunks stay in the L1 cache while all sections are applied
+    constexpr size_t chunk = 1024;
+    const size_t stride    = (this->block + 2) * this->block;
+    for (size_t offset = 0; offset < size; offset += chunk)
+    {
+        const size_t count = std::min(chunk, size - offset);
+        T* x               = dest + offset;
+        if (dest != src)
+            std::copy_n(src + offset, count, x);
+        for (size_t i = 0; i < this->biquads.size(); ++i)
+        {
+            const T* m = this->matrices.data() + i * stride;
+            const T* p = this->transitions.data() + i * 4;
+            T* state   = this->state.data() + i * 2;
+            cswitch(csizes<8, 16>, this->block,
+                    [&](auto n)
+                    {
+                        constexpr size_t N = val_of(decltype(n)());
+                        iir_block_kernel<N>(x, count, this->biquads[i], m, p, state);
+                    });
+        }
+    }
+}
+
+template <typename T>
+void iir_block_filter<T>::process_expression_impl(T* dest, const expression_handle<T, 1>& src,
+                                                  size_t size)
+{
+    process(make_univector(dest, size), src, shape<1>(0), shape<1>(size));
+    process_buffer_impl(dest, dest, size);
+}
+
+template class iir_block_filter<float>;
+template class iir_block_filter<double>;
+
+/// Applies all sections (N lanes) to x and sums their outputs and the direct term, x[-1]... are the
+/// previous inputs
+template <size_t N, typename T>
+KFR_INTRINSIC void parallel_sos_kernel(T* dest, const T* x, size_t size, const T* coefs, T* state,
+                                       const T* direct, size_t taps)
+{
+    const vec<T, N> a1 = read<N>(coefs);
+    const vec<T, N> a2 = read<N>(coefs + N);
+    const vec<T, N> b0 = read<N>(coefs + 2 * N);
+    const vec<T, N> b1 = read<N>(coefs + 3 * N);
+    const vec<T, N> b2 = read<N>(coefs + 4 * N);
+    vec<T, N> s1       = read<N>(state);
+    vec<T, N> s2       = read<N>(state + N);
+    for (size_t i = 0; i < size; ++i)
+    {
+        const T in        = x[i];
+        const vec<T, N> y = fmadd(b0, in, s1);
+        s1                = fmadd(b1, in, s2) - a1 * y;
+        s2                = b2 * in - a2 * y;
+        T out             = hadd(y) + direct[0] * in;
+        for (size_t k = 1; k < taps; ++k)
+            out += direct[k] * x[i - k];
+        dest[i] = out;
+    }
+    write(state, s1);
+    write(state + N, s2);
+}
+
+template <typename T>
+void parallel_sos_filter<T>::process_buffer_impl(T* dest, const T* src, size_t size)
+{
+    const size_t history = this->direct.size() - 1;
+    T* x                 = this->buffer.data() + history;
+    for (size_t offset = 0; offset < size; offset += this->chunk)
+    {
+        const size_t count = std::min(this->chunk, size - offset);
+        // Input is copied, so dest may be the same as src
+        std::copy_n(src + offset, count, x);
+        cswitch(csizes<4, 8, 16, 32, 64>, this->lanes,
+                [&](auto n)
+                {
+                    constexpr size_t N = val_of(decltype(n)());
+                    parallel_sos_kernel<N>(dest + offset, x, count, this->coefs.data(), this->state.data(),
+                                           this->direct.data(), this->direct.size());
+                });
+        std::copy_n(x + count - history, history, this->buffer.data());
+    }
+}
+
+template <typename T>
+void parallel_sos_filter<T>::process_expression_impl(T* dest, const expression_handle<T, 1>& src,
+                                                     size_t size)
+{
+    process(make_univector(dest, size), src, shape<1>(0), shape<1>(size));
+    process_buffer_impl(dest, dest, size);
+}
+
+template class parallel_sos_filter<float>;
+template class parallel_sos_filter<double>;
 } // namespace impl
 } // namespace KFR_ARCH_NAME
 
@@ -56,12 +363,215 @@ template expression_handle<double, 1> create_iir_filter<double>(const iir_params
 
 template <typename T>
 iir_filter<T>::iir_filter(const iir_params<T>& params)
+    : active(params.begin(), params.end()), start(params.size()), target(params.begin(), params.end())
 {
     KFR_MULTI_GATE(this->filter_expr = ns::impl::create_iir_filter<T>(params));
 }
 
+template <typename T>
+void iir_filter<T>::update(const biquad_section<T>* sections)
+{
+    KFR_MULTI_GATE(ns::impl::update_iir_filter<T>(this->filter_expr, sections, active.size()));
+}
+
 template iir_filter<float>::iir_filter(const iir_params<float>&);
 template iir_filter<double>::iir_filter(const iir_params<double>&);
+template void iir_filter<float>::update(const biquad_section<float>*);
+template void iir_filter<double>::update(const biquad_section<double>*);
+
+template <typename T>
+void multichannel_biquad<T>::process(T* const* output, const T* const* input, size_t frames)
+{
+    KFR_MULTI_GATE(static_cast<ns::impl::multichannel_biquad<T>*>(this)->process(output, input, frames));
+}
+
+template <typename T>
+void multichannel_biquad<T>::process_interleaved(T* output, const T* input, size_t frames)
+{
+    KFR_MULTI_GATE(
+        static_cast<ns::impl::multichannel_biquad<T>*>(this)->process_interleaved(output, input, frames));
+}
+
+template class multichannel_biquad<float>;
+template class multichannel_biquad<double>;
+
+template <typename T>
+void iir_block_filter<T>::process_buffer(T* dest, const T* src, size_t size)
+{
+    KFR_MULTI_GATE(static_cast<ns::impl::iir_block_filter<T>*>(this)->process_buffer_impl(dest, src, size));
+}
+
+template <typename T>
+void iir_block_filter<T>::process_expression(T* dest, const expression_handle<T, 1>& src, size_t size)
+{
+    KFR_MULTI_GATE(
+        static_cast<ns::impl::iir_block_filter<T>*>(this)->process_expression_impl(dest, src, size));
+}
+
+template class iir_block_filter<float>;
+template class iir_block_filter<double>;
+
+template <typename T>
+void parallel_sos_filter<T>::process_buffer(T* dest, const T* src, size_t size)
+{
+    KFR_MULTI_GATE(
+        static_cast<ns::impl::parallel_sos_filter<T>*>(this)->process_buffer_impl(dest, src, size));
+}
+
+template <typename T>
+void parallel_sos_filter<T>::process_expression(T* dest, const expression_handle<T, 1>& src, size_t size)
+{
+    KFR_MULTI_GATE(
+        static_cast<ns::impl::parallel_sos_filter<T>*>(this)->process_expression_impl(dest, src, size));
+}
+
+template class parallel_sos_filter<float>;
+template class parallel_sos_filter<double>;
+
+/// Calls fn(0) ... fn(count - 1) in parallel, fn(0) in the calling thread
+template <typename Fn>
+static void iir_run_parallel(size_t count, Fn&& fn)
+{
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < count; ++i)
+        workers.emplace_back(std::ref(fn), i);
+    fn(size_t(0));
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+/// Multiplies square matrices of size n, row-major
+static std::vector<double> iir_matrix_multiply(const std::vector<double>& a, const std::vector<double>& b,
+                                               size_t n)
+{
+    std::vector<double> result(n * n, 0.0);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t k = 0; k < n; ++k)
+            for (size_t j = 0; j < n; ++j)
+                result[i * n + j] += a[i * n + k] * b[k * n + j];
+    return result;
+}
+
+/// Transition matrix of the cascade for the given number of samples of zero input, s1 and s2 of each section
+template <typename T>
+static std::vector<double> iir_transition_matrix(const iir_params<T>& params, size_t samples)
+{
+    const size_t n = params.size() * 2;
+    std::vector<double> step(n * n);
+    for (size_t j = 0; j < n; ++j)
+    {
+        std::vector<double> state(n, 0.0);
+        state[j] = 1.0;
+        double x = 0.0;
+        for (size_t k = 0; k < params.size(); ++k)
+        {
+            const biquad_section<double> bq = biquad_section<double>(params[k]).normalized_a0();
+            const double y                  = bq.b0 * x + state[2 * k];
+            state[2 * k]                    = state[2 * k + 1] + bq.b1 * x - bq.a1 * y;
+            state[2 * k + 1]                = bq.b2 * x - bq.a2 * y;
+            x                               = y;
+        }
+        for (size_t i = 0; i < n; ++i)
+            step[i * n + j] = state[i];
+    }
+    std::vector<double> result(n * n, 0.0);
+    for (size_t i = 0; i < n; ++i)
+        result[i * n + i] = 1.0;
+    for (; samples; samples >>= 1)
+    {
+        if (samples & 1)
+            result = iir_matrix_multiply(result, step, n);
+        if (samples > 1)
+            step = iir_matrix_multiply(step, step, n);
+    }
+    return result;
+}
+
+template <typename T>
+void iir_parallel(T* data, size_t size, const iir_params<T>& params, size_t threads)
+{
+    constexpr size_t min_chunk = 1024;
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t chunks = std::max(std::min(threads, size / min_chunk), size_t(1));
+    const iir_block_filter<T> prototype(params);
+    std::vector<iir_block_filter<T>> filters(chunks, prototype);
+    if (chunks == 1)
+    {
+        filters[0].apply(data, size);
+        return;
+    }
+    auto start = [&](size_t c) { return size * c / chunks; };
+
+    // Zero-state responses
+    iir_run_parallel(chunks, [&](size_t c) { filters[c].apply(data + start(c), start(c + 1) - start(c)); });
+
+    // Initial states of the chunks, chunks differ in length by one sample at most
+    const size_t n                      = params.size() * 2;
+    const size_t short_length           = size / chunks;
+    const std::vector<double> short_pow = iir_transition_matrix(params, short_length);
+    const std::vector<double> long_pow  = iir_transition_matrix(params, short_length + 1);
+    std::vector<univector<T>> initial(chunks, univector<T>(n, T(0)));
+    std::vector<double> state(n, 0.0);
+    for (size_t c = 1; c < chunks; ++c)
+    {
+        const std::vector<double>& pow = start(c) - start(c - 1) == short_length ? short_pow : long_pow;
+        const univector<T>& zero_state = filters[c - 1].get_state();
+        std::vector<double> next(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double sum = zero_state[i];
+            for (size_t j = 0; j < n; ++j)
+                sum += pow[i * n + j] * state[j];
+            next[i] = sum;
+        }
+        state = std::move(next);
+        std::copy(state.begin(), state.end(), initial[c].begin());
+    }
+
+    // Responses to the initial states, until they decay below the rounding errors
+    iir_run_parallel(chunks - 1,
+                     [&](size_t i)
+                     {
+                         const size_t c   = i + 1;
+                         T* x             = data + start(c);
+                         const size_t len = start(c + 1) - start(c);
+                         T threshold      = 0;
+                         for (T v : initial[c])
+                             threshold = std::max(threshold, std::abs(v));
+                         threshold *= std::numeric_limits<T>::epsilon();
+                         iir_block_filter<T>& filter = filters[c];
+                         filter.set_state(initial[c]);
+                         univector<T> block(min_chunk);
+                         for (size_t offset = 0; offset < len && threshold > 0; offset += block.size())
+                         {
+                             const size_t count = std::min(block.size(), len - offset);
+                             std::fill(block.begin(), block.end(), T(0));
+                             filter.apply(block.data(), count);
+                             for (size_t j = 0; j < count; ++j)
+                                 x[offset + j] += block[j];
+                             T remaining = 0;
+                             for (T v : filter.get_state())
+                                 remaining = std::max(remaining, std::abs(v));
+                             if (remaining < threshold)
+                                 break;
+                         }
+                     });
+}
+
+template <typename T>
+void filtfilt_parallel(T* data, size_t size, const iir_params<T>& params, size_t threads)
+{
+    iir_parallel(data, size, params, threads);
+    std::reverse(data, data + size);
+    iir_parallel(data, size, params, threads);
+    std::reverse(data, data + size);
+}
+
+template void iir_parallel<float>(float*, size_t, const iir_params<float>&, size_t);
+template void iir_parallel<double>(double*, size_t, const iir_params<double>&, size_t);
+template void filtfilt_parallel<float>(float*, size_t, const iir_params<float>&, size_t);
+template void filtfilt_parallel<double>(double*, size_t, const iir_params<double>&, size_t);
 
 #endif
 
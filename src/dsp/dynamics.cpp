@@ -0,0 +1,329 @@
+/** @addtogroup dsp_extra
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#include <kfr/cident.h>
+#if !defined KFR_SKIP_IF_NON_X86 || defined(KFR_ARCH_X86)
+
+#include <kfr/multiarch.h>
+#include <kfr/base/reduce.hpp>
+#include <kfr/base/simd_expressions.hpp>
+#include <kfr/dsp/dynamics.hpp>
+#include <kfr/math/log_exp.hpp>
+#include <algorithm>
+
+namespace kfr
+{
+
+KFR_MULTI_PROTO(namespace impl {
+    template <typename T>
+    class dynamics_processor : public kfr::dynamics_processor<T>
+    {
+    public:
+        void process(T* const* output, const T* const* input, size_t frames);
+        void process_interleaved(T* output, const T* input, size_t frames);
+        void process_expression_impl(T* dest, const expression_handle<T, 1>& src, size_t size);
+
+    protected:
+        void process_block(size_t count);
+        void hold(T* level, size_t frames);
+        void smooth(T* target, size_t frames);
+        void smooth_limiter(T* target, size_t frames);
+    };
+} // namespace impl
+)
+
+inline namespace KFR_ARCH_NAME
+{
+namespace impl
+{
+
+/// Maximum of the levels over the last lookahead + 1 frames by the van Herk/Gil-Werman algorithm: the
+/// window ending at the position p of the current block is the suffix from p + 1 of the previous block and
+/// the prefix up to p of the current one. Suffix maxima are computed when a block is complete.
+template <typename T>
+void dynamics_processor<T>::hold(T* level, size_t frames)
+{
+    const size_t detectors = this->detectors;
+    const size_t width     = this->lookahead + 1;
+    T* prefix              = this->hold_prefix.data();
+    for (size_t f = 0; f < frames; ++f, level += detectors)
+    {
+        T* current      = this->hold_block.data() + this->hold_cursor * detectors;
+        const T* suffix = this->hold_suffix.data() + (this->hold_cursor + 1) * detectors;
+        block_process(detectors, csizes<vector_width<T>, 1>,
+                      [&](size_t d, auto w)
+                      {
+                          constexpr size_t N = val_of(decltype(w)());
+                          const vec<T, N> x  = read<N>(level + d);
+                          const vec<T, N> p  = max(read<N>(prefix + d), x);
+                          write(current + d, x);
+                          write(prefix + d, p);
+                          write(level + d, max(p, read<N>(suffix + d)));
+                      });
+        if (++this->hold_cursor == width)
+        {
+            this->hold_cursor = 0;
+            for (size_t j = width; j-- > 0;)
+            {
+                univector_ref<T> row = this->hold_suffix.slice(j * detectors, detectors);
+                row = max(this->hold_block.slice(j * detectors, detectors),
+                          this->hold_suffix.slice((j + 1) * detectors, detectors));
+            }
+            std::fill(this->hold_prefix.begin(), this->hold_prefix.end(), T(0));
+        }
+    }
+}
+
+/// One-pole recursion of the gains in dB for all detectors of each frame, target is replaced by the result
+template <typename T>
+void dynamics_processor<T>::smooth(T* target, size_t frames)
+{
+    const size_t detectors = this->detectors;
+    const bool expander    = this->params.mode == dynamics_mode::expander;
+    const T attack         = this->attack_coef;
+    const T release        = this->release_coef;
+    T* gain                = this->gain.data();
+    for (size_t f = 0; f < frames; ++f, target += detectors)
+    {
+        block_process(detectors, csizes<vector_width<T>, 1>,
+                      [&](size_t d, auto w)
+                      {
+                          constexpr size_t N    = val_of(decltype(w)());
+                          const vec<T, N> t     = read<N>(target + d);
+                          const vec<T, N> g     = read<N>(gain + d);
+                          // Attack when the gain follows a rising level
+                          const mask<T, N> rise = expander ? t > g : t < g;
+                          const vec<T, N> next  = fmadd(select(rise, vec<T, N>(attack), vec<T, N>(release)),
+                                                        t - g, g);
+                          write(gain + d, next);
+                          write(target + d, next);
+                      });
+    }
+}
+
+/// Instant attack and one-pole release of the linear gains, then their average over the lookahead window
+template <typename T>
+void dynamics_processor<T>::smooth_limiter(T* target, size_t frames)
+{
+    const size_t detectors = this->detectors;
+    const size_t lookahead = this->lookahead;
+    const T release        = this->release_coef;
+    const T scale          = lookahead > 0 ? T(1) / lookahead : T(1);
+    T* gain                = this->gain.data();
+    T* sum                 = this->average_sum.data();
+    for (size_t f = 0; f < frames; ++f, target += detectors)
+    {
+        T* slot = this->average.data() + this->average_cursor * detectors;
+        block_process(detectors, csizes<vector_width<T>, 1>,
+                      [&](size_t d, auto w)
+                      {
+                          constexpr size_t N   = val_of(decltype(w)());
+                          const vec<T, N> t    = read<N>(target + d);
+                          const vec<T, N> g    = read<N>(gain + d);
+                          const vec<T, N> next = min(t, fmadd(vec<T, N>(release), t - g, g));
+                          write(gain + d, next);
+                          if (lookahead == 0)
+                          {
+                              write(target + d, next);
+                              return;
+                          }
+                          const vec<T, N> s = read<N>(sum + d) + next - read<N>(slot + d);
+                          write(slot + d, next);
+                          write(sum + d, s);
+                          write(target + d, s * scale);
+                      });
+        if (lookahead > 0 && ++this->average_cursor == lookahead)
+        {
+            // Sums are recomputed once per window, so the rounding errors don't accumulate
+            this->average_cursor  = 0;
+            univector_ref<T> sums = this->average_sum.slice();
+            sums                  = this->average.slice(0, detectors);
+            for (size_t k = 1; k < lookahead; ++k)
+                sums = sums + this->average.slice(k * detectors, detectors);
+        }
+    }
+}
+
+template <typename T>
+void dynamics_processor<T>::process_block(size_t count)
+{
+    const dynamics_params<T>& p = this->params;
+    const size_t channels       = this->channel_count;
+    const size_t detectors      = this->detectors;
+    T* x                        = this->block.data();
+    T* level                    = this->levels.data();
+    univector_ref<T> levels     = this->levels.slice(0, count * detectors);
+
+    // Peak level of each channel or of the frame
+    if (detectors == channels)
+        levels = abs(make_univector(x, count * channels));
+    else
+        for (size_t f = 0; f < count; ++f)
+            level[f] = absmaxof(make_univector(x + f * channels, channels));
+    if (this->lookahead > 0)
+        hold(level, count);
+
+    if (p.mode == dynamics_mode::limiter)
+    {
+        const T ceiling = std::pow(T(10), p.threshold / 20);
+        levels          = min(T(1), ceiling / max(levels, std::numeric_limits<T>::min()));
+        smooth_limiter(level, count);
+        if (p.makeup != 0)
+            levels = levels * std::pow(T(10), p.makeup / 20);
+    }
+    else
+    {
+        // Gain computer in dB with the quadratic soft knee, levels below -120 dB are taken as -120 dB
+        const bool compressor = p.mode == dynamics_mode::compressor;
+        const T half          = p.knee / 2;
+        const T scale         = p.knee > 0 ? 1 / (2 * p.knee) : T(0);
+        const T slope         = compressor ? 1 / p.ratio - 1 : p.ratio - 1;
+        block_process(count * detectors, csizes<vector_width<T>, 1>,
+                      [&](size_t i, auto w)
+                      {
+                          constexpr size_t N = val_of(decltype(w)());
+                          const vec<T, N> x =
+                              T(20) * log10(max(read<N>(level + i), T(1e-6))) - p.threshold;
+                          vec<T, N> g;
+                          if (compressor)
+                              g = select(x > half, x, select(x < -half, T(0), sqr(x + half) * scale));
+                          else
+                              g = select(x < -half, x, select(x > half, T(0), -sqr(x - half) * scale));
+                          write(level + i, g * slope);
+                      });
+        smooth(level, count);
+        block_process(count * detectors, csizes<vector_width<T>, 1>,
+                      [&](size_t i, auto w)
+                      {
+                          constexpr size_t N = val_of(decltype(w)());
+                          write(level + i, exp10((read<N>(level + i) + p.makeup) * T(0.05)));
+                      });
+    }
+
+    if (this->lookahead > 0)
+    {
+        T* delayline = this->delayline.data();
+        for (size_t f = 0; f < count; ++f)
+        {
+            std::swap_ranges(x + f * channels, x + (f + 1) * channels,
+                             delayline + this->delay_cursor * channels);
+            if (++this->delay_cursor == this->lookahead)
+                this->delay_cursor = 0;
+        }
+    }
+    if (detectors == channels)
+    {
+        make_univector(x, count * channels) = make_univector(x, count * channels) * levels;
+    }
+    else
+    {
+        for (size_t f = 0; f < count; ++f)
+        {
+            univector_ref<T> frame = make_univector(x + f * channels, channels);
+            frame                  = frame * level[f];
+        }
+    }
+}
+
+template <typename T>
+void dynamics_processor<T>::process(T* const* output, const T* const* input, size_t frames)
+{
+    const size_t channels = this->channel_count;
+    T* x                  = this->block.data();
+    for (size_t offset = 0; offset < frames; offset += this->block_frames)
+    {
+        const size_t count = std::min(this->block_frames, frames - offset);
+        for (size_t c = 0; c < channels; ++c)
+            for (size_t f = 0; f < count; ++f)
+                x[f * channels + c] = input[c][offset + f];
+        process_block(count);
+        for (size_t c = 0; c < channels; ++c)
+            for (size_t f = 0; f < count; ++f)
+                output[c][offset + f] = x[f * channels + c];
+    }
+}
+
+template <typename T>
+void dynamics_processor<T>::process_interleaved(T* output, const T* input, size_t frames)
+{
+    const size_t channels = this->channel_count;
+    for (size_t offset = 0; offset < frames; offset += this->block_frames)
+    {
+        const size_t count = std::min(this->block_frames, frames - offset);
+        std::copy_n(input + offset * channels, count * channels, this->block.data());
+        process_block(count);
+        std::copy_n(this->block.data(), count * channels, output + offset * channels);
+    }
+}
+
+template <typename T>
+void dynamics_processor<T>::process_expression_impl(T* dest, const expression_handle<T, 1>& src, size_t size)
+{
+    kfr::process(make_univector(dest, size), src, shape<1>(0), shape<1>(size));
+    this->process_buffer(dest, dest, size);
+}
+
+template class dynamics_processor<float>;
+template class dynamics_processor<double>;
+} // namespace impl
+} // namespace KFR_ARCH_NAME
+
+#ifdef KFR_MULTI_NEEDS_GATE
+
+template <typename T>
+void dynamics_processor<T>::process(T* const* output, const T* const* input, size_t frames)
+{
+    KFR_MULTI_GATE(static_cast<ns::impl::dynamics_processor<T>*>(this)->process(output, input, frames));
+}
+
+template <typename T>
+void dynamics_processor<T>::process_interleaved(T* output, const T* input, size_t frames)
+{
+    KFR_MULTI_GATE(
+        static_cast<ns::impl::dynamics_processor<T>*>(this)->process_interleaved(output, input, frames));
+}
+
+template <typename T>
+void dynamics_processor<T>::process_buffer(T* dest, const T* src, size_t size)
+{
+    KFR_LOGIC_CHECK(size % channel_count == 0, "dynamics_processor: size must be a multiple of channels");
+    process_interleaved(dest, src, size / channel_count);
+}
+
+template <typename T>
+void dynamics_processor<T>::process_expression(T* dest, const expression_handle<T, 1>& src, size_t size)
+{
+    KFR_MULTI_GATE(
+        static_cast<ns::impl::dynamics_processor<T>*>(this)->process_expression_impl(dest, src, size));
+}
+
+template class dynamics_processor<float>;
+template class dynamics_processor<double>;
+
+#endif
+
+} // namespace kfr
+
+#endif
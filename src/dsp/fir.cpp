@@ -28,6 +28,7 @@
 
 #include <kfr/dsp/fir.hpp>
 #include <kfr/multiarch.h>
+#include <algorithm>
 
 namespace kfr
 {
@@ -42,6 +43,33 @@ KFR_MULTI_PROTO(namespace impl {
         void process_buffer_impl(U* dest, const U* src, size_t size);
         void process_expression_impl(U* dest, const expression_handle<U, 1>& src, size_t size);
     };
+
+    template <typename T, typename U>
+    class fir_decimator : public kfr::fir_decimator<T, U>
+    {
+    public:
+        using kfr::fir_decimator<T, U>::fir_decimator;
+
+        size_t process_impl(U* dest, const U* src, size_t size);
+    };
+
+    template <typename T, typename U>
+    class fir_interpolator : public kfr::fir_interpolator<T, U>
+    {
+    public:
+        using kfr::fir_interpolator<T, U>::fir_interpolator;
+
+        size_t process_impl(U* dest, const U* src, size_t size);
+    };
+
+    template <typename T, typename U>
+    class halfband_interpolator : public kfr::halfband_interpolator<T, U>
+    {
+    public:
+        using kfr::halfband_interpolator<T, U>::halfband_interpolator;
+
+        size_t process_impl(U* dest, const U* src, size_t size);
+    };
 } // namespace impl
 )
 
@@ -50,10 +78,104 @@ inline namespace KFR_ARCH_NAME
 namespace impl
 {
 
+/// out[j] = Σ taps[q·tapcount + k]·x[q·pitch + j + k·stride] for 0 <= j < count, q < phases
+/// Each tap is broadcast once per tile of R vectors of outputs, so the loads of the input are contiguous
+/// and the accumulators stay in registers. Outputs are computed from the end, so out may alias
+/// x + (tapcount - 1) * stride, i.e. the single phase filter may be applied in place
+template <typename S>
+KFR_INTRINSIC void fir_block_kernel(S* out, const S* x, const S* taps, size_t tapcount, size_t count,
+                                    size_t stride, size_t phases = 1, size_t pitch = 0)
+{
+    constexpr size_t width = vector_width<S>;
+    constexpr size_t tile  = 4;
+
+    size_t j = count;
+    for (; j % width != 0; --j)
+    {
+        S acc = 0;
+        for (size_t q = 0; q < phases; ++q)
+            for (size_t k = 0; k < tapcount; ++k)
+                acc += taps[q * tapcount + k] * x[q * pitch + j - 1 + k * stride];
+        out[j - 1] = acc;
+    }
+    for (; j % (width * tile) != 0; j -= width)
+    {
+        vec<S, width> acc = 0;
+        const S* t        = taps;
+        for (size_t q = 0; q < phases; ++q)
+        {
+            const S* p = x + q * pitch + j - width;
+            for (size_t k = 0; k < tapcount; ++k, p += stride)
+                acc = fmadd(read<width>(p), vec<S, width>(*t++), acc);
+        }
+        write(out + j - width, acc);
+    }
+    for (; j > 0; j -= width * tile)
+    {
+        vec<S, width> acc[tile];
+        for (size_t r = 0; r < tile; ++r)
+            acc[r] = 0;
+        const S* t = taps;
+        for (size_t q = 0; q < phases; ++q)
+        {
+            const S* p = x + q * pitch + j - width * tile;
+            for (size_t k = 0; k < tapcount; ++k, p += stride)
+            {
+                const vec<S, width> tap = *t++;
+                for (size_t r = 0; r < tile; ++r)
+                    acc[r] = fmadd(read<width>(p + r * width), tap, acc[r]);
+            }
+        }
+        for (size_t r = 0; r < tile; ++r)
+            write(out + j - width * tile + r * width, acc[r]);
+    }
+}
+
 template <typename T, typename U>
 void fir_filter<T, U>::process_buffer_impl(U* dest, const U* src, size_t size)
 {
-    make_univector(dest, size) = fir(make_univector(src, size), std::ref(this->state));
+    using S                 = deep_subtype<U>;
+    constexpr size_t stride = sizeof(U) / sizeof(S);
+    fir_state<T, U>& state  = this->state;
+    const size_t tapcount   = state.params.taps.size();
+    if (tapcount == 0)
+    {
+        std::fill_n(dest, size, U(0));
+        return;
+    }
+    if constexpr (sizeof(deep_subtype<T>) > sizeof(S))
+    {
+        // The block kernel works in the type of the samples, so wider taps keep their precision in the
+        // expression path
+        make_univector(dest, size) = fir(make_univector(src, size), std::ref(state));
+        return;
+    }
+    const size_t history = tapcount - 1;
+
+    // The last history samples, oldest first, followed by the beginning of the input
+    U* head       = this->block_head.data();
+    size_t cursor = state.delayline_cursor;
+    state.delayline.ringbuf_step(cursor, 1);
+    state.delayline.ringbuf_read(cursor, head, history);
+    const size_t head_count = std::min(size, history);
+    std::copy_n(src, head_count, head + history);
+
+    // Update the delay line before src is overwritten
+    if (size >= tapcount)
+    {
+        std::copy_n(src + size - tapcount, tapcount, state.delayline.data());
+        state.delayline_cursor = 0;
+    }
+    else
+    {
+        state.delayline.ringbuf_write(state.delayline_cursor, src, size);
+    }
+
+    const S* taps = this->block_taps.data();
+    if (size > history)
+        fir_block_kernel(ptr_cast<S>(dest + history), ptr_cast<S>(src), taps, tapcount,
+                         (size - history) * stride, stride);
+    fir_block_kernel(ptr_cast<S>(dest), ptr_cast<S>(head), taps, tapcount, head_count * stride, stride);
 }
 template <typename T, typename U>
 void fir_filter<T, U>::process_expression_impl(U* dest, const expression_handle<U, 1>& src, size_t size)
@@ -61,6 +183,173 @@ void fir_filter<T, U>::process_expression_impl(U* dest, const expression_handle<
     make_univector(dest, size) = fir(src, std::ref(this->state));
 }
 
+/// out[n] = Σ taps[i·factor + n % factor]·e[n - i·factor] for 0 <= n < count
+/// Lanes of a vector are consecutive outputs, each in its own phase. tables holds the tap vectors for every
+/// starting phase and e holds each input sample repeated factor times, so all loads are contiguous
+template <typename S>
+KFR_INTRINSIC void fir_interpolator_kernel(S* out, const S* e, const S* tables, const S* taps, size_t factor,
+                                           size_t phase_taps, size_t count, size_t stride)
+{
+    constexpr size_t width = vector_width<S>;
+    constexpr size_t tile  = 4;
+    const size_t step      = width / stride;
+    const size_t pitch     = factor * stride;
+
+    size_t n = 0;
+    for (; n + step * tile <= count; n += step * tile)
+    {
+        vec<S, width> acc[tile];
+        const S* t[tile];
+        for (size_t r = 0; r < tile; ++r)
+        {
+            acc[r] = 0;
+            t[r]   = tables + (n + r * step) % factor * phase_taps * width;
+        }
+        const S* p = e + n * stride;
+        for (size_t i = 0; i < phase_taps; ++i, p -= pitch)
+        {
+            for (size_t r = 0; r < tile; ++r)
+                acc[r] = fmadd(read<width>(p + r * width), read<width, true>(t[r] + i * width), acc[r]);
+        }
+        for (size_t r = 0; r < tile; ++r)
+            write(out + n * stride + r * width, acc[r]);
+    }
+    for (; n + step <= count; n += step)
+    {
+        vec<S, width> acc = 0;
+        const S* t        = tables + n % factor * phase_taps * width;
+        const S* p        = e + n * stride;
+        for (size_t i = 0; i < phase_taps; ++i, p -= pitch)
+            acc = fmadd(read<width>(p), read<width, true>(t + i * width), acc);
+        write(out + n * stride, acc);
+    }
+    for (; n < count; ++n)
+    {
+        for (size_t c = 0; c < stride; ++c)
+        {
+            S acc      = 0;
+            const S* p = e + n * stride + c;
+            for (size_t i = 0; i < phase_taps; ++i, p -= pitch)
+                acc += taps[i * factor + n % factor] * *p;
+            out[n * stride + c] = acc;
+        }
+    }
+}
+
+template <typename T, typename U>
+size_t fir_decimator<T, U>::process_impl(U* dest, const U* src, size_t size)
+{
+    using S                 = deep_subtype<U>;
+    constexpr size_t stride = sizeof(U) / sizeof(S);
+    const size_t factor     = this->decimation;
+    const size_t history    = this->phase_taps - 1;
+    U* out                  = dest;
+
+    // Computes outputs for the complete frames and keeps the history and the incomplete frame
+    auto flush = [&]()
+    {
+        const size_t count = this->columns - history;
+        const size_t first = this->dense_first;
+        fir_block_kernel(ptr_cast<S>(out), ptr_cast<S>(this->phases.data() + first * this->width),
+                         this->phase_taps_data.data() + first * this->phase_taps, this->phase_taps,
+                         count * stride, stride, this->dense_count, this->width * stride);
+        for (size_t index : this->single_taps)
+        {
+            const size_t q = index / this->phase_taps;
+            const S tap    = this->phase_taps_data[index];
+            make_univector(out, count) +=
+                make_univector(this->phases.data() + q * this->width + index % this->phase_taps, count) * tap;
+        }
+        out += count;
+        for (size_t q = 0; q < factor; ++q)
+        {
+            U* phase = this->phases.data() + q * this->width;
+            std::copy_n(phase + count, history + 1, phase);
+        }
+        this->columns = history;
+    };
+
+    const size_t width = this->width;
+    for (size_t i = 0; i < size;)
+    {
+        // Samples up to the end of the block of frames
+        const size_t frames = history + this->block_frames - this->columns;
+        const size_t count  = std::min(size - i, frames * factor - this->fill);
+        U* column           = this->phases.data() + this->columns;
+        size_t fill         = this->fill;
+        for (size_t j = 0; j < count; ++j)
+        {
+            column[fill * width] = src[i + j];
+            if (++fill == factor)
+            {
+                fill = 0;
+                ++column;
+            }
+        }
+        i += count;
+        this->columns = column - this->phases.data();
+        this->fill    = fill;
+        if (this->columns == history + this->block_frames)
+            flush();
+    }
+    if (this->columns > history)
+        flush();
+    return out - dest;
+}
+
+template <typename T, typename U>
+size_t fir_interpolator<T, U>::process_impl(U* dest, const U* src, size_t size)
+{
+    using S                 = deep_subtype<U>;
+    constexpr size_t stride = sizeof(U) / sizeof(S);
+    const size_t factor     = this->interpolation;
+    U* const expanded       = this->expanded.data();
+    U* const input          = expanded + this->history;
+
+    for (size_t offset = 0; offset < size; offset += this->block_inputs)
+    {
+        const size_t count = std::min(size_t(this->block_inputs), size - offset);
+        for (size_t i = 0; i < count; ++i)
+            std::fill_n(input + i * factor, factor, src[offset + i]);
+        fir_interpolator_kernel(ptr_cast<S>(dest + offset * factor), ptr_cast<S>(input),
+                                this->tables.data(), this->phase_taps_data.data(), factor, this->phase_taps,
+                                count * factor, stride);
+        std::copy_n(input + count * factor - this->history, this->history, expanded);
+    }
+    return size * factor;
+}
+
+template <typename T, typename U>
+size_t halfband_interpolator<T, U>::process_impl(U* dest, const U* src, size_t size)
+{
+    using S                 = deep_subtype<U>;
+    constexpr size_t stride = sizeof(U) / sizeof(S);
+    const size_t history    = this->history;
+    const size_t filtered   = 1 - this->center_phase;
+    U* const input          = this->input.data() + history;
+
+    for (size_t offset = 0; offset < size; offset += this->block_inputs)
+    {
+        const size_t count = std::min(size_t(this->block_inputs), size - offset);
+        std::copy_n(src + offset, count, input);
+        if (this->phase_taps > 0)
+            fir_block_kernel(ptr_cast<S>(this->filtered.data()), ptr_cast<S>(input - (this->phase_taps - 1)),
+                             this->phase_taps_data.data(), this->phase_taps, count * stride, stride);
+        else
+            std::fill_n(this->filtered.data(), count, U(0));
+        U* out           = dest + offset * 2;
+        const U* delayed = input - this->center_delay;
+        const T center   = this->center;
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[2 * i + filtered]     = this->filtered[i];
+            out[2 * i + 1 - filtered] = delayed[i] * center;
+        }
+        std::copy_n(input + count - history, history, this->input.data());
+    }
+    return size * 2;
+}
+
 template class fir_filter<float, float>;
 template class fir_filter<double, double>;
 template class fir_filter<float, double>;
@@ -68,6 +357,21 @@ template class fir_filter<double, float>;
 template class fir_filter<float, complex<float>>;
 template class fir_filter<double, complex<double>>;
 
+template class fir_decimator<float, float>;
+template class fir_decimator<double, double>;
+template class fir_decimator<float, complex<float>>;
+template class fir_decimator<double, complex<double>>;
+
+template class fir_interpolator<float, float>;
+template class fir_interpolator<double, double>;
+template class fir_interpolator<float, complex<float>>;
+template class fir_interpolator<double, complex<double>>;
+
+template class halfband_interpolator<float, float>;
+template class halfband_interpolator<double, double>;
+template class halfband_interpolator<float, complex<float>>;
+template class halfband_interpolator<double, complex<double>>;
+
 } // namespace impl
 } // namespace KFR_ARCH_NAME
 
@@ -76,7 +380,7 @@ template class fir_filter<double, complex<double>>;
 template <typename T, typename U>
 void fir_filter<T, U>::process_buffer(U* dest, const U* src, size_t size)
 {
-    make_univector(dest, size) = fir(make_univector(src, size), std::ref(this->state));
+    KFR_MULTI_GATE(static_cast<ns::impl::fir_filter<T, U>*>(this)->process_buffer_impl(dest, src, size));
 }
 template <typename T, typename U>
 void fir_filter<T, U>::process_expression(U* dest, const expression_handle<U, 1>& src, size_t size)
@@ -90,6 +394,38 @@ template class fir_filter<double, float>;
 template class fir_filter<float, complex<float>>;
 template class fir_filter<double, complex<double>>;
 
+template <typename T, typename U>
+size_t fir_decimator<T, U>::process(U* dest, const U* src, size_t size)
+{
+    KFR_MULTI_GATE(return static_cast<ns::impl::fir_decimator<T, U>*>(this)->process_impl(dest, src, size));
+}
+template class fir_decimator<float, float>;
+template class fir_decimator<double, double>;
+template class fir_decimator<float, complex<float>>;
+template class fir_decimator<double, complex<double>>;
+
+template <typename T, typename U>
+size_t fir_interpolator<T, U>::process(U* dest, const U* src, size_t size)
+{
+    KFR_MULTI_GATE(
+        return static_cast<ns::impl::fir_interpolator<T, U>*>(this)->process_impl(dest, src, size));
+}
+template class fir_interpolator<float, float>;
+template class fir_interpolator<double, double>;
+template class fir_interpolator<float, complex<float>>;
+template class fir_interpolator<double, complex<double>>;
+
+template <typename T, typename U>
+size_t halfband_interpolator<T, U>::process(U* dest, const U* src, size_t size)
+{
+    KFR_MULTI_GATE(
+        return static_cast<ns::impl::halfband_interpolator<T, U>*>(this)->process_impl(dest, src, size));
+}
+template class halfband_interpolator<float, float>;
+template class halfband_interpolator<double, double>;
+template class halfband_interpolator<float, complex<float>>;
+template class halfband_interpolator<double, complex<double>>;
+
 #endif
 
 } // namespace kfr
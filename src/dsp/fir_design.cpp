@@ -0,0 +1,314 @@
+/** @addtogroup fir
+ *  @{
+ */
+/*
+  Copyright (C) 2016-2025 Dan Casarin (https://www.kfrlib.com)
+  This file is part of KFR
+
+  KFR is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  KFR is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with KFR.
+
+  If GPL is not suitable for your project, you must purchase a commercial license to use KFR.
+  Buying a commercial license is mandatory as soon as you develop commercial activities without
+  disclosing the source code of your own applications.
+  See https://www.kfrlib.com for details.
+ */
+#include <kfr/cident.h>
+#if !defined KFR_SKIP_IF_NON_X86 || defined(KFR_ARCH_X86)
+
+#include <kfr/dsp/fir_design.hpp>
+#include <kfr/test/assert.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace kfr
+{
+inline namespace KFR_ARCH_NAME
+{
+
+namespace internal
+{
+
+// Amplitude of the linear phase filter is Q(f)·P(f), P being the cosine polynomial fitted by the exchange:
+// Q = 1 (odd size, symmetric), cos(πf) (even, symmetric), sin(2πf) (odd, antisymmetric), sin(πf) (even,
+// antisymmetric)
+static double remez_factor(bool symmetric, bool odd, double f)
+{
+    if (symmetric)
+        return odd ? 1.0 : std::cos(c_pi<double> * f);
+    return odd ? std::sin(2 * c_pi<double> * f) : std::sin(c_pi<double> * f);
+}
+
+// Barycentric weights of the nodes, each difference is doubled to keep the products in range
+static void remez_barycentric(std::vector<double>& weights, const std::vector<double>& x, size_t count)
+{
+    weights.resize(count);
+    for (size_t k = 0; k < count; ++k)
+    {
+        double product = 1;
+        for (size_t j = 0; j < count; ++j)
+            if (j != k)
+                product *= 2 * (x[k] - x[j]);
+        weights[k] = 1 / product;
+    }
+}
+
+// Keeps the larger of the adjacent extrema of the same sign
+static void remez_merge(std::vector<size_t>& extrema, const std::vector<double>& error)
+{
+    size_t last = 0;
+    for (size_t i = 1; i < extrema.size(); ++i)
+    {
+        if ((error[extrema[i]] > 0) == (error[extrema[last]] > 0))
+        {
+            if (std::abs(error[extrema[i]]) > std::abs(error[extrema[last]]))
+                extrema[last] = extrema[i];
+        }
+        else
+        {
+            extrema[++last] = extrema[i];
+        }
+    }
+    extrema.resize(std::min(extrema.size(), last + 1));
+}
+
+} // namespace internal
+
+template <typename T>
+KFR_FUNCTION remez_result fir_remez(const univector_ref<T>& taps, const std::vector<remez_band>& bands,
+                                    remez_type type, size_t grid_density, size_t max_iterations)
+{
+    const size_t size = taps.size();
+    KFR_LOGIC_CHECK(size >= 3, "fir_remez: at least 3 taps are required");
+    KFR_LOGIC_CHECK(!bands.empty(), "fir_remez: no bands");
+    KFR_LOGIC_CHECK(grid_density >= 1, "fir_remez: grid density must be positive");
+    for (size_t b = 0; b < bands.size(); ++b)
+    {
+        KFR_LOGIC_CHECK(bands[b].low >= 0 && bands[b].low <= bands[b].high && bands[b].high <= 0.5,
+                        "fir_remez: band edges must be in 0..0.5");
+        KFR_LOGIC_CHECK(b == 0 || bands[b].low >= bands[b - 1].high, "fir_remez: bands must not overlap");
+        KFR_LOGIC_CHECK(bands[b].weight > 0, "fir_remez: weights must be positive");
+    }
+
+    const bool symmetric = type == remez_type::bandpass;
+    const bool odd       = is_odd(size);
+    // Number of coefficients of P
+    const size_t r = symmetric ? (size + 1) / 2 : size / 2;
+
+    // Dense grid without the points where Q is zero
+    const double spacing = 0.5 / (grid_density * r);
+    std::vector<double> x, desired, weight;
+    std::vector<size_t> band_end;
+    for (const remez_band& band : bands)
+    {
+        double low  = band.low;
+        double high = band.high;
+        if (!symmetric)
+            low = std::max(low, spacing);
+        if (symmetric != odd)
+            high = std::min(high, 0.5 - spacing);
+        if (low > high)
+            continue;
+        const size_t points = std::max(size_t(std::ceil((high - low) / spacing)), size_t(1)) + 1;
+        for (size_t i = 0; i < points; ++i)
+        {
+            const double f = low + (high - low) * i / (points - 1);
+            const double q = internal::remez_factor(symmetric, odd, f);
+            double d       = band.gain;
+            double w       = band.weight;
+            if (type == remez_type::differentiator)
+            {
+                // Relative error in the bands with nonzero slope
+                d *= f;
+                if (band.gain != 0)
+                    w /= f;
+            }
+            x.push_back(std::cos(2 * c_pi<double> * f));
+            desired.push_back(d / q);
+            weight.push_back(w * q);
+        }
+        band_end.push_back(x.size());
+    }
+    const size_t grid = x.size();
+    KFR_LOGIC_CHECK(grid > r, "fir_remez: bands are too narrow for the number of taps");
+    // Level of the rounding errors, deviations below it can't be resolved
+    double noise = 0;
+    for (size_t i = 0; i < grid; ++i)
+        noise = std::max(noise, 1e-12 * std::abs(weight[i] * desired[i]));
+
+    std::vector<size_t> extrema(r + 1);
+    for (size_t k = 0; k <= r; ++k)
+        extrema[k] = k * (grid - 1) / r;
+
+    std::vector<double> xe(r + 1), c(r + 1), bary, error(grid);
+    std::vector<size_t> found;
+    auto evaluate = [&](double value)
+    {
+        double n = 0, d = 0;
+        for (size_t k = 0; k < r; ++k)
+        {
+            const double diff = value - xe[k];
+            if (diff == 0)
+                return c[k];
+            n += bary[k] * c[k] / diff;
+            d += bary[k] / diff;
+        }
+        return n / d;
+    };
+    remez_result result{ 0, 0, false };
+    for (;;)
+    {
+        // Deviation and values of P at the extremal points with the alternating error
+        for (size_t k = 0; k <= r; ++k)
+            xe[k] = x[extrema[k]];
+        internal::remez_barycentric(bary, xe, r + 1);
+        double num = 0, den = 0;
+        for (size_t k = 0; k <= r; ++k)
+        {
+            const double sign = is_odd(k) ? -1.0 : 1.0;
+            num += bary[k] * desired[extrema[k]];
+            den += bary[k] * sign / weight[extrema[k]];
+        }
+        const double deviation = num / den;
+        for (size_t k = 0; k <= r; ++k)
+            c[k] = desired[extrema[k]] - (is_odd(k) ? -1.0 : 1.0) * deviation / weight[extrema[k]];
+
+        // P is the Lagrange interpolation through the first r points
+        internal::remez_barycentric(bary, xe, r);
+        for (size_t i = 0; i < grid; ++i)
+            error[i] = weight[i] * (desired[i] - evaluate(x[i]));
+
+        ++result.iterations;
+        if (result.converged || result.iterations > max_iterations)
+            break;
+
+        // Local extrema of the error not smaller than the deviation, band edges included
+        found.clear();
+        size_t start = 0;
+        for (size_t end : band_end)
+        {
+            for (size_t i = start; i < end; ++i)
+            {
+                const double e = error[i];
+                if (std::abs(e) < std::abs(deviation) * (1 - 1e-9) - noise)
+                    continue;
+                const bool left  = i == start || (e > 0 ? e >= error[i - 1] : e <= error[i - 1]);
+                const bool right = i + 1 == end || (e > 0 ? e >= error[i + 1] : e <= error[i + 1]);
+                if (left && right)
+                    found.push_back(i);
+            }
+            start = end;
+        }
+        internal::remez_merge(found, error);
+        while (found.size() > r + 1)
+        {
+            if (found.size() == r + 2)
+            {
+                // One too many, the alternation is kept by dropping the smaller of the outer ones
+                if (std::abs(error[found.front()]) < std::abs(error[found.back()]))
+                    found.erase(found.begin());
+                else
+                    found.pop_back();
+            }
+            else
+            {
+                size_t smallest = 0;
+                for (size_t i = 1; i < found.size(); ++i)
+                    if (std::abs(error[found[i]]) < std::abs(error[found[smallest]]))
+                        smallest = i;
+                found.erase(found.begin() + smallest);
+                internal::remez_merge(found, error);
+            }
+        }
+        if (found.size() < r + 1)
+            break;
+
+        double largest = 0, lowest = std::numeric_limits<double>::max();
+        for (size_t i : found)
+        {
+            largest = std::max(largest, std::abs(error[i]));
+            lowest  = std::min(lowest, std::abs(error[i]));
+        }
+        // Equiripple: the next iteration recomputes P from the final extremal set
+        result.converged = largest - lowest <= 1e-6 * largest + noise;
+        extrema          = found;
+    }
+    result.deviation = 0;
+    for (double e : error)
+        result.deviation = std::max(result.deviation, std::abs(e));
+
+    // Taps from N samples of the frequency response, which define the filter of N taps exactly:
+    // H(f) = e^(-jπf(N-1))·A(f) (symmetric) or e^(-jπf(N-1))·j·A(f) (antisymmetric)
+    std::vector<double> amplitude(size);
+    for (size_t j = 0; j < size; ++j)
+    {
+        const double f = double(j) / size;
+        amplitude[j]   = internal::remez_factor(symmetric, odd, f) * evaluate(std::cos(2 * c_pi<double> * f));
+    }
+    // Standard Hilbert transformer is -j in the positive frequencies
+    const double scale = (type == remez_type::hilbert ? -1.0 : 1.0) / size;
+    for (size_t n = 0; n < size; ++n)
+    {
+        double sum = 0;
+        for (size_t j = 0; j < size; ++j)
+        {
+            const double phase = 2 * c_pi<double> * j * (n - (size - 1) * 0.5) / size;
+            sum += amplitude[j] * (symmetric ? std::cos(phase) : -std::sin(phase));
+        }
+        taps[n] = static_cast<T>(sum * scale);
+    }
+    return result;
+}
+
+template <typename T>
+KFR_FUNCTION remez_result fir_remez_halfband(const univector_ref<T>& taps, double passband)
+{
+    KFR_LOGIC_CHECK(taps.size() % 4 == 3, "fir_remez_halfband: number of taps must be 4k - 1");
+    KFR_LOGIC_CHECK(passband > 0 && passband < 0.25, "fir_remez_halfband: passband edge must be below 0.25");
+    // H(z) = (z^-(2k-1) + G(z^2)) / 2, G has 2k taps and the gain 1 in [0, 2·passband]
+    const size_t half = (taps.size() + 1) / 2;
+    univector<double> g(half);
+    remez_result result = fir_remez(g.slice(), { remez_band{ 0, 2 * passband, 1 } });
+    for (size_t i = 0; i < half; ++i)
+    {
+        taps[2 * i] = static_cast<T>(g[i] * 0.5);
+        if (2 * i + 1 < taps.size())
+            taps[2 * i + 1] = 0;
+    }
+    taps[half - 1] = T(0.5);
+    result.deviation *= 0.5;
+    return result;
+}
+
+KFR_FUNCTION size_t fir_estimate_taps(double passband_ripple, double stopband_ripple, double transition)
+{
+    KFR_LOGIC_CHECK(passband_ripple > 0 && stopband_ripple > 0 && transition > 0,
+                    "fir_estimate_taps: ripples and transition width must be positive");
+    const double attenuation = -20 * std::log10(std::sqrt(passband_ripple * stopband_ripple));
+    const double order       = (attenuation - 13) / (14.6 * transition);
+    return std::max(size_t(std::ceil(order)) + 1, size_t(3));
+}
+
+template remez_result fir_remez<float>(const univector_ref<float>&, const std::vector<remez_band>&,
+                                       remez_type, size_t, size_t);
+template remez_result fir_remez<double>(const univector_ref<double>&, const std::vector<remez_band>&,
+                                        remez_type, size_t, size_t);
+template remez_result fir_remez_halfband<float>(const univector_ref<float>&, double);
+template remez_result fir_remez_halfband<double>(const univector_ref<double>&, double);
+
+} // namespace KFR_ARCH_NAME
+} // namespace kfr
+
+#endif
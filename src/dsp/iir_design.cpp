@@ -1330,6 +1330,111 @@ KFR_FUNCTION iir_params<T> to_sos(const zpk& filter)
 template iir_params<float> to_sos(const zpk& filter);
 template iir_params<double> to_sos(const zpk& filter);
 
+template <typename T>
+KFR_FUNCTION parallel_sos<T> to_parallel_sos(const zpk& filter)
+{
+    // H(w) = B(w) / A(w), w = 1/z, B(w) = k·∏(1 - z_i·w), A(w) = ∏(1 - p_j·w),
+    // zeros and poles at the origin contribute nothing after the padding.
+    // Complex roots are replaced by exact conjugate pairs, as in to_sos: designs may produce pairs that
+    // differ by the rounding errors, and residues of close poles are very sensitive to that
+    auto nonzero = [](const univector<complex<double>>& roots)
+    {
+        univector<complex<double>> result;
+        for (complex<double> r : roots)
+        {
+            if (isreal(r) && r.real() != 0)
+            {
+                result.push_back(r);
+            }
+            else if (r.imag() > 0)
+            {
+                result.push_back(r);
+                result.push_back(cconj(r));
+            }
+        }
+        return result;
+    };
+    const univector<complex<double>> zeros = nonzero(filter.z);
+    const univector<complex<double>> poles = nonzero(filter.p);
+
+    auto expand = [](const univector<complex<double>>& roots, double k)
+    {
+        univector<complex<double>> poly(roots.size() + 1, complex<double>(0));
+        poly[0] = k;
+        for (size_t i = 0; i < roots.size(); ++i)
+            for (size_t j = i + 1; j > 0; --j)
+                poly[j] -= roots[i] * poly[j - 1];
+        return poly;
+    };
+
+    parallel_sos<T> result;
+    if (zeros.size() >= poles.size())
+    {
+        // Quotient of the polynomial division
+        univector<complex<double>> b = expand(zeros, filter.k);
+        univector<complex<double>> a = expand(poles, 1.0);
+        result.direct.resize(zeros.size() - poles.size() + 1);
+        for (size_t d = zeros.size() + 1; d-- > poles.size();)
+        {
+            const complex<double> q = b[d] / a[poles.size()];
+            for (size_t j = 0; j <= poles.size(); ++j)
+                b[d - poles.size() + j] -= q * a[j];
+            result.direct[d - poles.size()] = static_cast<T>(q.real());
+        }
+    }
+
+    // Residue of the pole p_j: B(1/p_j) / ∏(1 - p_i/p_j), i ≠ j
+    auto residue = [&](const complex<double>& pole)
+    {
+        complex<double> num = filter.k, den = 1;
+        for (complex<double> z : zeros)
+            num *= 1.0 - z / pole;
+        for (complex<double> p : poles)
+            if (p != pole)
+                den *= 1.0 - p / pole;
+        return num / den;
+    };
+
+    // Each conjugate pair gives a section, real poles are paired
+    univector<complex<double>> real;
+    for (complex<double> p : poles)
+    {
+        if (isreal(p))
+        {
+            real.push_back(p);
+        }
+        else if (p.imag() > 0)
+        {
+            // r / (1 - p·w) + conj(r) / (1 - conj(p)·w)
+            const complex<double> r = residue(p);
+            result.sections.push_back(biquad_section<T>(
+                1, static_cast<T>(-2 * p.real()), static_cast<T>(cabssqr(p)), static_cast<T>(2 * r.real()),
+                static_cast<T>(-2 * (r * cconj(p)).real()), 0));
+        }
+    }
+    for (size_t i = 0; i < real.size(); i += 2)
+    {
+        const double p1 = real[i].real();
+        const double r1 = residue(real[i]).real();
+        if (i + 1 == real.size())
+        {
+            result.sections.push_back(
+                biquad_section<T>(1, static_cast<T>(-p1), 0, static_cast<T>(r1), 0, 0));
+            break;
+        }
+        // r1 / (1 - p1·w) + r2 / (1 - p2·w)
+        const double p2 = real[i + 1].real();
+        const double r2 = residue(real[i + 1]).real();
+        result.sections.push_back(biquad_section<T>(1, static_cast<T>(-(p1 + p2)), static_cast<T>(p1 * p2),
+                                                    static_cast<T>(r1 + r2),
+                                                    static_cast<T>(-(r1 * p2 + r2 * p1)), 0));
+    }
+    return result;
+}
+
+template parallel_sos<float> to_parallel_sos(const zpk& filter);
+template parallel_sos<double> to_parallel_sos(const zpk& filter);
+
 zpk iir_lowpass(const zpk& filter, double frequency, double fs)
 {
     double warped = internal::warp_freq(frequency, fs);
@@ -26,6 +26,7 @@
 #include <kfr/cident.h>
 #if !defined KFR_SKIP_IF_NON_X86 || defined(KFR_ARCH_X86)
 
+#include <kfr/dsp/fir_design.hpp>
 #include <kfr/dsp/sample_rate_conversion.hpp>
 #include <kfr/multiarch.h>
 
@@ -42,6 +43,32 @@ KFR_MULTI_PROTO(namespace impl {
                   subtype<T> scale, subtype<T> cutoff);
         size_t process_impl(univector_ref<T> output, univector_ref<const T> input);
     };
+
+    template <typename T>
+    struct multichannel_samplerate_converter : public kfr::multichannel_samplerate_converter<T>
+    {
+    public:
+        size_t process(T* const* output, size_t output_size, const T* const* input, size_t input_size);
+        size_t process_interleaved(T* output, size_t output_size, const T* input, size_t input_size);
+    };
+
+    template <typename T>
+    struct variable_samplerate_converter : public kfr::variable_samplerate_converter<T>
+    {
+    public:
+        void init(sample_rate_conversion_quality quality, double ratio);
+        size_t process(T* output, const T* input, size_t input_size);
+    };
+
+    template <typename T>
+    struct multistage_samplerate_converter : public kfr::multistage_samplerate_converter<T>
+    {
+    public:
+        using itype = typename kfr::multistage_samplerate_converter<T>::itype;
+        void init(sample_rate_conversion_quality quality, itype interpolation_factor,
+                  itype decimation_factor);
+        size_t process(T* output, const T* input, size_t input_size);
+    };
 } // namespace impl
 )
 
@@ -50,6 +77,205 @@ inline namespace KFR_ARCH_NAME
 namespace impl
 {
 
+template <typename S, size_t N>
+KFR_INTRINSIC vec<S, N> samplerate_read_taps(ctype_t<S>, const S* taps)
+{
+    return read<N>(taps);
+}
+/// Taps of the complex converter are real, both parts of the sample are multiplied by the real part
+template <typename S, size_t N>
+KFR_INTRINSIC vec<S, N> samplerate_read_taps(ctype_t<complex<S>>, const S* taps)
+{
+    return dupeven(read<N>(taps));
+}
+template <typename S, size_t N>
+KFR_INTRINSIC S samplerate_sum(ctype_t<S>, const vec<S, N>& acc)
+{
+    return hadd(acc);
+}
+template <typename S, size_t N>
+KFR_INTRINSIC complex<S> samplerate_sum(ctype_t<complex<S>>, const vec<S, N>& acc)
+{
+    return complex<S>(hadd(even(acc)), hadd(odd(acc)));
+}
+
+/// out[j·out_step] = Σ taps[k]·x[j·x_step + k] for 0 <= j < count, 0 <= k < depth
+/// All outputs share the taps of one phase, so each tap vector is loaded once for the whole tile
+template <typename T>
+KFR_INTRINSIC void samplerate_phase_kernel(T* out, size_t out_step, const T* x, size_t x_step, const T* taps,
+                                           size_t depth, size_t count)
+{
+    using S                 = deep_subtype<T>;
+    constexpr size_t width  = vector_width<S>;
+    constexpr size_t tile   = 4;
+    constexpr size_t stride = sizeof(T) / sizeof(S);
+    const size_t length     = depth * stride;
+    const size_t vlength    = length / width * width;
+    const S* t              = ptr_cast<S>(taps);
+
+    for (size_t j = 0; j < count; j += tile)
+    {
+        // Lanes past the end repeat the last output
+        const S* p[tile];
+        vec<S, width> acc[tile];
+        for (size_t r = 0; r < tile; ++r)
+        {
+            p[r]   = ptr_cast<S>(x + std::min(j + r, count - 1) * x_step);
+            acc[r] = 0;
+        }
+        for (size_t k = 0; k < vlength; k += width)
+        {
+            const vec<S, width> tap = samplerate_read_taps<S, width>(ctype<T>, t + k);
+            for (size_t r = 0; r < tile; ++r)
+                acc[r] = fmadd(read<width>(p[r] + k), tap, acc[r]);
+        }
+        for (size_t r = 0; r < tile && j + r < count; ++r)
+        {
+            T sum = samplerate_sum(ctype<T>, acc[r]);
+            for (size_t k = vlength / stride; k < depth; ++k)
+                sum += ptr_cast<T>(p[r])[k] * taps[k];
+            out[(j + r) * out_step] = sum;
+        }
+    }
+}
+
+template <typename T, size_t N, size_t... indices>
+KFR_INTRINSIC vec<T, N * 2> samplerate_dup(const vec<T, N>& x, csizes_t<indices...>)
+{
+    return repeat<2>(x).shuffle(csizes<(indices / 2)...>);
+}
+/// Taps t[0], ..., t[N / C - 1], each repeated C times
+template <size_t C, size_t N, typename T>
+KFR_INTRINSIC vec<T, N> samplerate_repeat(const T* t)
+{
+    if constexpr (C == 1)
+        return read<N>(t);
+    else if constexpr (C == 2)
+        return samplerate_dup(read<N / 2>(t), csizeseq<N>);
+    else if constexpr (N == C)
+        return vec<T, N>(t[0]);
+    else
+        return concat(samplerate_repeat<C, N / 2>(t), samplerate_repeat<C, N / 2>(t + N / 2 / C));
+}
+template <size_t C, typename T, size_t N>
+KFR_INTRINSIC vec<T, C> samplerate_fold(const vec<T, N>& x)
+{
+    if constexpr (N == C)
+        return x;
+    else
+        return samplerate_fold<C>(low(x) + high(x));
+}
+
+/// Same as samplerate_phase_kernel for C interleaved channels, C divides the vector width.
+/// Window is read as a whole, lane l of the accumulator belongs to the channel l % C
+template <size_t C, typename T>
+KFR_INTRINSIC void samplerate_folded_kernel(T* out, size_t out_step, const T* x, size_t x_step,
+                                            const T* taps, size_t depth, size_t count)
+{
+    constexpr size_t width = vector_width<T>;
+    constexpr size_t tile  = 4;
+    const size_t length    = depth * C;
+    const size_t vlength   = length / width * width;
+
+    for (size_t j = 0; j < count; j += tile)
+    {
+        const T* p[tile];
+        vec<T, width> acc[tile];
+        for (size_t r = 0; r < tile; ++r)
+        {
+            p[r]   = x + std::min(j + r, count - 1) * x_step * C;
+            acc[r] = 0;
+        }
+        for (size_t k = 0; k < vlength; k += width)
+        {
+            const vec<T, width> tap = samplerate_repeat<C, width>(taps + k / C);
+            for (size_t r = 0; r < tile; ++r)
+                acc[r] = fmadd(read<width>(p[r] + k), tap, acc[r]);
+        }
+        for (size_t r = 0; r < tile && j + r < count; ++r)
+        {
+            vec<T, C> sum = samplerate_fold<C>(acc[r]);
+            for (size_t k = vlength / C; k < depth; ++k)
+                sum = fmadd(read<C>(p[r] + k * C), vec<T, C>(taps[k]), sum);
+            write(out + (j + r) * out_step * C, sum);
+        }
+    }
+}
+
+/// Same as samplerate_phase_kernel for interleaved channels, channels is a multiple of the vector width.
+/// Each vector holds width channels of one frame
+template <typename T>
+KFR_INTRINSIC void samplerate_channel_kernel(T* out, size_t out_step, const T* x, size_t x_step,
+                                             const T* taps, size_t depth, size_t count, size_t channels)
+{
+    constexpr size_t width = vector_width<T>;
+    constexpr size_t tile  = 4;
+    for (size_t c = 0; c < channels; c += width)
+    {
+        for (size_t j = 0; j < count; j += tile)
+        {
+            const T* p[tile];
+            vec<T, width> acc[tile];
+            for (size_t r = 0; r < tile; ++r)
+            {
+                p[r]   = x + std::min(j + r, count - 1) * x_step * channels + c;
+                acc[r] = 0;
+            }
+            for (size_t k = 0; k < depth; ++k)
+            {
+                const vec<T, width> tap = taps[k];
+                for (size_t r = 0; r < tile; ++r)
+                    acc[r] = fmadd(read<width>(p[r] + k * channels), tap, acc[r]);
+            }
+            for (size_t r = 0; r < tile && j + r < count; ++r)
+                write(out + (j + r) * out_step * channels + c, acc[r]);
+        }
+    }
+}
+
+/// Whether the interleaved channels fill the vectors, otherwise they are processed as planar channels
+template <typename T>
+KFR_INTRINSIC bool samplerate_channels_in_lanes(size_t channels)
+{
+    constexpr size_t width = vector_width<T>;
+    return channels < width ? width % channels == 0 : channels % width == 0;
+}
+
+template <typename T>
+KFR_INTRINSIC void samplerate_interleaved_kernel(T* out, size_t out_step, const T* x, size_t x_step,
+                                                 const T* taps, size_t depth, size_t count, size_t channels)
+{
+    constexpr size_t width = vector_width<T>;
+    if (channels % width == 0)
+        samplerate_channel_kernel(out, out_step, x, x_step, taps, depth, count, channels);
+    else if (channels == 1)
+        samplerate_folded_kernel<1>(out, out_step, x, x_step, taps, depth, count);
+    else if (channels == 2)
+        samplerate_folded_kernel<2>(out, out_step, x, x_step, taps, depth, count);
+    else if constexpr (width > 4)
+    {
+        if (channels == 4)
+            samplerate_folded_kernel<4>(out, out_step, x, x_step, taps, depth, count);
+        else if constexpr (width > 8)
+            samplerate_folded_kernel<8>(out, out_step, x, x_step, taps, depth, count);
+    }
+}
+
+/// dest[j] = s[offset + j] for 0 <= j < length, where s is depth samples of the delay line followed by
+/// input_size samples of the input and zeros. dest may be the delay line itself
+template <typename T>
+void samplerate_concat(T* dest, size_t dest_stride, i64 length, i64 offset, const T* delay,
+                       size_t delay_stride, const T* input, size_t input_stride, i64 depth, i64 input_size)
+{
+    i64 j = 0;
+    for (; j < length && offset + j < depth; ++j)
+        dest[j * dest_stride] = delay[(offset + j) * delay_stride];
+    for (; j < length && offset + j - depth < input_size; ++j)
+        dest[j * dest_stride] = input[(offset + j - depth) * input_stride];
+    for (; j < length; ++j)
+        dest[j * dest_stride] = T(0);
+}
+
 template <typename T>
 void samplerate_converter<T>::init(sample_rate_conversion_quality quality, itype interpolation_factor,
                                    itype decimation_factor, subtype<T> scale, subtype<T> cutoff)
@@ -88,68 +314,481 @@ void samplerate_converter<T>::init(sample_rate_conversion_quality quality, itype
 
     const T s    = reciprocal(sum(this->filter)) * static_cast<ftype>(interpolation_factor * scale);
     this->filter = this->filter * s;
+
+    // Output n = q·interpolation_factor + r reads depth inputs starting from
+    // phase_input[r] + q·decimation_factor with the taps at phase_offset[r]
+    this->phase_input  = univector<itype>(size_t(interpolation_factor));
+    this->phase_offset = univector<itype>(size_t(interpolation_factor));
+    for (itype r = 0; r < interpolation_factor; ++r)
+    {
+        const std::lldiv_t input_pos =
+            floor_div(r * decimation_factor - this->taps + interpolation_factor, interpolation_factor);
+        this->phase_input[size_t(r)]  = input_pos.quot;
+        this->phase_offset[size_t(r)] = (interpolation_factor - 1 - input_pos.rem) * this->depth;
+    }
+    this->joined = univector<T>(size_t(2 * this->depth), T());
 }
 
 template <typename T>
 size_t samplerate_converter<T>::process_impl(univector_ref<T> output, univector_ref<const T> input)
 {
     const itype required_input_size = this->input_size_for_output(output.size());
+    const itype input_size          = input.size();
+    const itype depth               = this->depth;
+
+    const itype processed = this->process_windows(
+        output.size(), input_size,
+        [&](itype offset)
+        {
+            samplerate_concat(this->joined.data(), 1, 2 * depth, offset, this->delay.data(), 1, input.data(),
+                              1, depth, input_size);
+        },
+        [&](itype from, itype to, itype shift, bool joined)
+        {
+            const T* source = joined ? this->joined.data() : input.data();
+            this->for_each_phase(
+                from, to,
+                [&](itype i, itype count, itype start, const T* taps)
+                {
+                    samplerate_phase_kernel(output.data() + i, size_t(this->interpolation_factor),
+                                            source + start + shift, size_t(this->decimation_factor), taps,
+                                            size_t(depth), size_t(count));
+                });
+        });
+    output.slice(size_t(processed)) = zeros();
 
-    const itype input_size = input.size();
-    for (size_t i = 0; i < output.size(); i++)
+    samplerate_concat(this->delay.data(), 1, depth, required_input_size, this->delay.data(), 1, input.data(),
+                      1, depth, input_size);
+
+    this->input_position += required_input_size;
+    this->output_position += output.size();
+
+    return required_input_size;
+}
+
+template struct samplerate_converter<float>;
+template struct samplerate_converter<double>;
+template struct samplerate_converter<complex<float>>;
+template struct samplerate_converter<complex<double>>;
+
+template <typename T>
+size_t multichannel_samplerate_converter<T>::process(T* const* output, size_t output_size,
+                                                     const T* const* input, size_t input_size)
+{
+    using itype                     = typename kfr::samplerate_converter<T>::itype;
+    const itype required_input_size = this->input_size_for_output(output_size);
+    const itype depth               = this->depth;
+    const size_t channels           = this->channels;
+
+    const itype processed = this->process_windows(
+        output_size, input_size,
+        [&](itype offset)
+        {
+            for (size_t c = 0; c < channels; ++c)
+                samplerate_concat(this->joined.data() + c * 2 * depth, 1, 2 * depth, offset,
+                                  this->delay.data() + c, channels, input[c], 1, depth, itype(input_size));
+        },
+        [&](itype from, itype to, itype shift, bool joined)
+        {
+            this->for_each_phase(
+                from, to,
+                [&](itype i, itype count, itype start, const T* taps)
+                {
+                    for (size_t c = 0; c < channels; ++c)
+                    {
+                        const T* source = joined ? this->joined.data() + c * 2 * depth : input[c];
+                        samplerate_phase_kernel(output[c] + i, size_t(this->interpolation_factor),
+                                                source + start + shift, size_t(this->decimation_factor), taps,
+                                                size_t(depth), size_t(count));
+                    }
+                });
+        });
+
+    for (size_t c = 0; c < channels; ++c)
     {
-        const itype intermediate_index =
-            this->output_position_to_intermediate(static_cast<itype>(i) + this->output_position);
-        const itype intermediate_start = intermediate_index - this->taps + 1;
-        const std::lldiv_t input_pos =
-            floor_div(intermediate_start + this->interpolation_factor - 1, this->interpolation_factor);
-        const itype input_start        = input_pos.quot; // first input sample
-        const itype tap_start          = this->interpolation_factor - 1 - input_pos.rem;
-        const univector_ref<T> tap_ptr = this->filter.slice(static_cast<size_t>(tap_start * this->depth));
+        make_univector(output[c] + processed, output_size - processed) = zeros();
+        samplerate_concat(this->delay.data() + c, channels, depth, required_input_size,
+                          this->delay.data() + c, channels, input[c], 1, depth, itype(input_size));
+    }
+
+    this->input_position += required_input_size;
+    this->output_position += output_size;
+
+    return required_input_size;
+}
+
+template <typename T>
+size_t multichannel_samplerate_converter<T>::process_interleaved(T* output, size_t output_size,
+                                                                 const T* input, size_t input_size)
+{
+    using itype                     = typename kfr::samplerate_converter<T>::itype;
+    const itype required_input_size = this->input_size_for_output(output_size);
+    const itype depth               = this->depth;
+    const size_t channels           = this->channels;
 
-        if (input_start >= this->input_position + input_size)
+    if (!samplerate_channels_in_lanes<T>(channels))
+    {
+        // Input samples that are read and the output are deinterleaved to scratch
+        const size_t used = std::min(input_size, size_t(std::max(required_input_size, itype(0))));
+        if (this->scratch.size() < channels * (used + output_size))
+            this->scratch.resize(channels * (used + output_size));
+        T** outputs      = this->scratch_outputs.data();
+        const T** inputs = this->scratch_inputs.data();
+        for (size_t c = 0; c < channels; ++c)
         {
-            output[i] = T(0);
+            T* in = this->scratch.data() + c * used;
+            for (size_t i = 0; i < used; ++i)
+                in[i] = input[i * channels + c];
+            inputs[c]  = in;
+            outputs[c] = this->scratch.data() + channels * used + c * output_size;
         }
-        else if (input_start >= this->input_position)
+        process(outputs, output_size, inputs, used);
+        for (size_t c = 0; c < channels; ++c)
+            for (size_t i = 0; i < output_size; ++i)
+                output[i * channels + c] = outputs[c][i];
+        return required_input_size;
+    }
+
+    const itype processed = this->process_windows(
+        output_size, input_size,
+        [&](itype offset)
+        {
+            for (size_t c = 0; c < channels; ++c)
+                samplerate_concat(this->joined.data() + c, channels, 2 * depth, offset,
+                                  this->delay.data() + c, channels, input + c, channels, depth,
+                                  itype(input_size));
+        },
+        [&](itype from, itype to, itype shift, bool joined)
         {
-            output[i] = dotproduct(
-                truncate(padded(input.slice(input_start - this->input_position, this->depth)), this->depth),
-                tap_ptr.truncate(this->depth));
+            const T* source = joined ? this->joined.data() : input;
+            this->for_each_phase(from, to,
+                                 [&](itype i, itype count, itype start, const T* taps)
+                                 {
+                                     samplerate_interleaved_kernel(
+                                         output + i * channels, size_t(this->interpolation_factor),
+                                         source + (start + shift) * channels,
+                                         size_t(this->decimation_factor), taps, size_t(depth), size_t(count),
+                                         channels);
+                                 });
+        });
+
+    make_univector(output + processed * channels, (output_size - processed) * channels) = zeros();
+    for (size_t c = 0; c < channels; ++c)
+        samplerate_concat(this->delay.data() + c, channels, depth, required_input_size,
+                          this->delay.data() + c, channels, input + c, channels, depth, itype(input_size));
+
+    this->input_position += required_input_size;
+    this->output_position += output_size;
+
+    return required_input_size;
+}
+
+template struct multichannel_samplerate_converter<float>;
+template struct multichannel_samplerate_converter<double>;
+
+/// out[j] = Σ h_k(t[j])·x[start[j] + k] for 0 <= j < count, 0 <= k < depth, where the taps h_k(t) are
+/// polynomials in t with Terms coefficients, stored as Terms rows of depth values at coefs[j]
+template <size_t Terms, typename T>
+KFR_INTRINSIC void variable_samplerate_kernel(T* out, const T* x, const size_t* start, const T* const* coefs,
+                                              const T* t, size_t depth, size_t count)
+{
+    constexpr size_t width = vector_width<T>;
+    constexpr size_t tile  = 4;
+    const size_t vlength   = depth / width * width;
+
+    for (size_t j = 0; j < count; j += tile)
+    {
+        // Lanes past the end repeat the last output
+        const T* p[tile];
+        const T* c[tile];
+        T f[tile];
+        vec<T, width> acc[tile];
+        for (size_t r = 0; r < tile; ++r)
+        {
+            const size_t i = std::min(j + r, count - 1);
+            p[r]           = x + start[i];
+            c[r]           = coefs[i];
+            f[r]           = t[i];
+            acc[r]         = 0;
+        }
+        for (size_t k = 0; k < vlength; k += width)
+        {
+            for (size_t r = 0; r < tile; ++r)
+            {
+                vec<T, width> tap = read<width>(c[r] + (Terms - 1) * depth + k);
+                cforeach(csizeseq<Terms - 1, Terms - 2, -1>,
+                         [&](auto n) { tap = fmadd(tap, f[r], read<width>(c[r] + val_of(n) * depth + k)); });
+                acc[r] = fmadd(read<width>(p[r] + k), tap, acc[r]);
+            }
         }
-        else
+        for (size_t r = 0; r < tile && j + r < count; ++r)
         {
-            const itype prev_count = this->input_position - input_start;
-            output[i]              = dotproduct(this->delay.slice(size_t(this->depth - prev_count)),
-                                                tap_ptr.truncate(prev_count)) +
-                        dotproduct(truncate(padded(input.truncate(size_t(this->depth - prev_count))),
-                                            size_t(this->depth - prev_count)),
-                                   tap_ptr.slice(size_t(prev_count), size_t(this->depth - prev_count)));
+            T sum = hadd(acc[r]);
+            for (size_t k = vlength; k < depth; ++k)
+            {
+                T tap = c[r][(Terms - 1) * depth + k];
+                for (size_t n = Terms - 1; n > 0; --n)
+                    tap = tap * f[r] + c[r][(n - 1) * depth + k];
+                sum += p[r][k] * tap;
+            }
+            out[j + r] = sum;
         }
     }
+}
+
+template <typename T>
+void variable_samplerate_converter<T>::init(sample_rate_conversion_quality quality, double ratio)
+{
+    using base          = kfr::samplerate_converter<T>;
+    const size_t depth  = base::filter_order(quality);
+    const size_t phases = this->phases;
+    const size_t terms  = this->interpolation == sinc_interpolation::cubic ? 4 : 2;
+    const double beta   = base::window_param(quality);
+    const double cutoff = (0.5 - base::transition_width(quality) / c_pi<double, 4>) * std::min(1.0, ratio);
 
-    if (required_input_size >= this->depth)
+    this->depth   = depth;
+    this->table   = univector<T>(terms * depth * phases);
+    this->history = univector<T>(depth + 1024);
+    this->set_ratio(ratio);
+    this->reset();
+
+    // Taps for the output at the fraction p / phases of the input sample interval, normalized to unity gain
+    auto compute = [&](univector<double>& taps, double p)
     {
-        this->delay.slice(0, this->delay.size()) =
-            padded(input.slice(size_t(required_input_size - this->depth)));
+        for (size_t k = 0; k < depth; ++k)
+        {
+            const double t = double(k) - double(depth / 2) + 1 - p / phases;
+            const double n = (t + depth / 2) / depth;
+            taps[k] = n <= 0 || n >= 1 ? 0.0
+                                       : sinc(c_pi<double, 2> * cutoff * t) *
+                                             modzerobessel(beta * std::sqrt(1 - sqr(2 * n - 1)));
+        }
+        taps = taps * reciprocal(sum(taps));
+    };
+
+    // Linear interpolation uses the taps at p and p + 1, cubic uses the taps at p - 1, ..., p + 2
+    const double first = terms == 4 ? -1 : 0;
+    univector<double> y[4];
+    for (size_t i = 0; i < terms; ++i)
+    {
+        y[i].resize(depth);
+        if (i + 1 < terms)
+            compute(y[i], first + i);
     }
-    else
+    for (size_t p = 0; p < phases; ++p)
     {
-        this->delay.truncate(size_t(this->depth - required_input_size)) =
-            this->delay.slice(size_t(required_input_size));
-        this->delay.slice(size_t(this->depth - required_input_size)) = padded(input);
+        compute(y[terms - 1], first + p + terms - 1);
+        T* row = this->table.data() + p * terms * depth;
+        for (size_t k = 0; k < depth; ++k)
+        {
+            if (terms == 2)
+            {
+                row[k]         = static_cast<T>(y[0][k]);
+                row[depth + k] = static_cast<T>(y[1][k] - y[0][k]);
+            }
+            else
+            {
+                const double ym = y[0][k], y0 = y[1][k], y1 = y[2][k], y2 = y[3][k];
+                row[k]             = static_cast<T>(y0);
+                row[depth + k]     = static_cast<T>(-ym / 3 - y0 / 2 + y1 - y2 / 6);
+                row[2 * depth + k] = static_cast<T>((ym + y1) / 2 - y0);
+                row[3 * depth + k] = static_cast<T>((y2 - ym) / 6 + (y0 - y1) / 2);
+            }
+        }
+        std::rotate(y, y + 1, y + terms);
     }
+}
 
-    this->input_position += required_input_size;
-    this->output_position += output.size();
+template <typename T>
+size_t variable_samplerate_converter<T>::process(T* output, const T* input, size_t input_size)
+{
+    constexpr size_t block = 64;
+    const size_t depth     = this->depth;
+    const size_t half      = depth / 2;
+    const size_t phases    = this->phases;
+    const size_t terms     = this->interpolation == sinc_interpolation::cubic ? 4 : 2;
+    T* history             = this->history.data();
 
-    return required_input_size;
+    size_t start[block];
+    const T* coefs[block];
+    T fraction[block];
+
+    size_t produced = 0;
+    while (input_size > 0)
+    {
+        const size_t chunk = std::min(input_size, this->history.size() - this->filled);
+        std::copy(input, input + chunk, history + this->filled);
+        this->filled += chunk;
+        input += chunk;
+        input_size -= chunk;
+
+        // The output at the position x reads depth samples starting from floor(x) - half + 1
+        const double limit = double(this->filled - half);
+        while (this->position < limit)
+        {
+            size_t count = 0;
+            for (; count < block && this->position < limit; ++count)
+            {
+                const double index = std::floor(this->position);
+                const double phase = (this->position - index) * phases;
+                const double row   = std::floor(phase);
+                start[count]       = size_t(index) + 1 - half;
+                coefs[count]       = this->table.data() + size_t(row) * terms * depth;
+                fraction[count]    = static_cast<T>(phase - row);
+                this->position += this->step;
+            }
+            if (terms == 4)
+                variable_samplerate_kernel<4>(output + produced, history, start, coefs, fraction, depth,
+                                              count);
+            else
+                variable_samplerate_kernel<2>(output + produced, history, start, coefs, fraction, depth,
+                                              count);
+            produced += count;
+        }
+
+        // Keep the samples read by the next output
+        const size_t drop = std::min(this->filled, size_t(this->position) + 1 - half);
+        std::copy(history + drop, history + this->filled, history);
+        this->filled -= drop;
+        this->position -= double(drop);
+    }
+    return produced;
 }
 
-template struct samplerate_converter<float>;
-template struct samplerate_converter<double>;
-template struct samplerate_converter<complex<float>>;
-template struct samplerate_converter<complex<double>>;
+template struct variable_samplerate_converter<float>;
+template struct variable_samplerate_converter<double>;
+
+template <typename T>
+void multistage_samplerate_converter<T>::init(sample_rate_conversion_quality quality,
+                                              itype interpolation_factor, itype decimation_factor)
+{
+    using base = kfr::samplerate_converter<T>;
+    KFR_LOGIC_CHECK(interpolation_factor > 0 && decimation_factor > 0,
+                    "multistage_samplerate_converter: factors must be positive");
+    const itype gcf = std::gcd(interpolation_factor, decimation_factor);
+    const itype L   = interpolation_factor / gcf;
+    const itype D   = decimation_factor / gcf;
+
+    const double attenuation = base::sidelobe_attenuation(quality);
+    const double beta        = base::window_param(quality);
+    // Passband edge relative to the lower of the input and output rates
+    const double passband = 0.5 - base::transition_width(quality) / c_pi<double, 4>;
+
+    // Halfband filter of a stage whose rate is the lower rate divided by relative, the stopband starts
+    // where the aliases or images of the passband begin
+    auto design = [&](double relative)
+    {
+        const double transition = 0.5 - 2 * passband * relative;
+        const size_t estimate =
+            size_t(std::ceil((attenuation - 8) / (2.285 * c_pi<double, 2> * transition))) + 1;
+        univector<T> taps(std::max(estimate, size_t(3)) / 4 * 4 + 3);
+        fir_halfband(taps, to_handle(window_kaiser<T>(taps.size(), T(beta))));
+        this->halfband_taps.push_back(taps.size());
+        return taps;
+    };
+
+    int stages = 0;
+    if (D > L)
+    {
+        while ((L << (stages + 1)) <= D)
+            ++stages;
+        for (int k = 0; k < stages; ++k)
+        {
+            const double relative   = double(L << k) / D;
+            const univector<T> taps = design(relative);
+            this->decimators.emplace_back(taps, 2);
+            this->delay += (taps.size() - 1) * 0.5 * relative;
+        }
+        if ((L << stages) != D)
+        {
+            const itype g    = std::gcd(L << stages, D);
+            this->converter  = kfr::samplerate_converter<T>(quality, (L << stages) / g, D / g);
+            this->fractional = true;
+            this->delay += this->fractional_delay();
+        }
+    }
+    else if (L > D)
+    {
+        while ((D << (stages + 1)) <= L)
+            ++stages;
+        if ((D << stages) != L)
+        {
+            const itype g    = std::gcd(L, D << stages);
+            this->converter  = kfr::samplerate_converter<T>(quality, L / g, (D << stages) / g);
+            this->fractional = true;
+            this->delay += this->fractional_delay() * (1 << stages);
+        }
+        for (int k = stages - 1; k >= 0; --k)
+        {
+            const univector<T> taps = design(double(D << k) / L) * T(2);
+            this->interpolators.emplace_back(taps);
+            this->delay += (taps.size() - 1) * 0.5 * (1 << k);
+        }
+    }
+}
+
+template <typename T>
+size_t multistage_samplerate_converter<T>::process(T* output, const T* input, size_t input_size)
+{
+    constexpr size_t block = 4096;
+    const size_t stages    = this->decimators.size() + this->fractional + this->interpolators.size();
+    size_t produced        = 0;
+
+    for (size_t offset = 0; offset < input_size; offset += block)
+    {
+        const T* in  = input + offset;
+        size_t size  = std::min(block, input_size - offset);
+        size_t stage = 0;
+        // The last stage writes to the output, the others to the buffers in turn
+        auto next = [&](size_t count) -> T*
+        {
+            if (++stage == stages)
+                return output + produced;
+            univector<T>& buffer = this->buffers[stage % 2];
+            if (buffer.size() < count)
+                buffer.resize(count);
+            return buffer.data();
+        };
+
+        for (fir_decimator<T>& decimator : this->decimators)
+        {
+            T* out = next(decimator.output_size_for_input(size));
+            size   = decimator.process(out, in, size);
+            in     = out;
+        }
+        if (this->fractional)
+        {
+            // Samples after the input of the last output are kept for the next call
+            univector<T>& pending = this->pending;
+            size_t& pending_size  = this->pending_size;
+            if (pending.size() < pending_size + size)
+                pending.resize(pending_size + size);
+            std::copy_n(in, size, pending.data() + pending_size);
+            pending_size += size;
+
+            const size_t count   = this->fractional_output_size(pending_size);
+            univector_ref<T> out = make_univector(next(count), count);
+            const size_t used    = this->converter.process(out, make_univector(pending.data(), pending_size));
+            std::copy(pending.data() + used, pending.data() + pending_size, pending.data());
+            pending_size -= used;
+            in   = out.data();
+            size = count;
+        }
+        for (halfband_interpolator<T>& interpolator : this->interpolators)
+        {
+            T* out = next(interpolator.output_size_for_input(size));
+            size   = interpolator.process(out, in, size);
+            in     = out;
+        }
+        if (stages == 0)
+            std::copy_n(in, size, output + produced);
+        produced += size;
+    }
+    return produced;
+}
+
+template struct multistage_samplerate_converter<float>;
+template struct multistage_samplerate_converter<double>;
 
 } // namespace impl
 } // namespace KFR_ARCH_NAME
@@ -177,6 +816,67 @@ template struct samplerate_converter<double>;
 template struct samplerate_converter<complex<float>>;
 template struct samplerate_converter<complex<double>>;
 
+template <typename T>
+size_t multichannel_samplerate_converter<T>::process(T* const* output, size_t output_size,
+                                                     const T* const* input, size_t input_size)
+{
+    KFR_MULTI_GATE(return reinterpret_cast<ns::impl::multichannel_samplerate_converter<T>*>(this)->process(
+        output, output_size, input, input_size));
+}
+
+template <typename T>
+size_t multichannel_samplerate_converter<T>::process_interleaved(T* output, size_t output_size,
+                                                                 const T* input, size_t input_size)
+{
+    KFR_MULTI_GATE(
+        return reinterpret_cast<ns::impl::multichannel_samplerate_converter<T>*>(this)->process_interleaved(
+            output, output_size, input, input_size));
+}
+
+template struct multichannel_samplerate_converter<float>;
+template struct multichannel_samplerate_converter<double>;
+
+template <typename T>
+variable_samplerate_converter<T>::variable_samplerate_converter(sample_rate_conversion_quality quality,
+                                                                double ratio,
+                                                                sinc_interpolation interpolation,
+                                                                size_t phases)
+    : phases(phases ? phases : interpolation == sinc_interpolation::cubic ? 64 : 512),
+      interpolation(interpolation)
+{
+    KFR_LOGIC_CHECK(ratio > 0, "variable_samplerate_converter: ratio must be positive");
+    KFR_MULTI_GATE(reinterpret_cast<ns::impl::variable_samplerate_converter<T>*>(this)->init(quality, ratio));
+}
+
+template <typename T>
+size_t variable_samplerate_converter<T>::process(T* output, const T* input, size_t input_size)
+{
+    KFR_MULTI_GATE(return reinterpret_cast<ns::impl::variable_samplerate_converter<T>*>(this)->process(
+        output, input, input_size));
+}
+
+template struct variable_samplerate_converter<float>;
+template struct variable_samplerate_converter<double>;
+
+template <typename T>
+multistage_samplerate_converter<T>::multistage_samplerate_converter(sample_rate_conversion_quality quality,
+                                                                    itype interpolation_factor,
+                                                                    itype decimation_factor)
+{
+    KFR_MULTI_GATE(reinterpret_cast<ns::impl::multistage_samplerate_converter<T>*>(this)->init(
+        quality, interpolation_factor, decimation_factor));
+}
+
+template <typename T>
+size_t multistage_samplerate_converter<T>::process(T* output, const T* input, size_t input_size)
+{
+    KFR_MULTI_GATE(return reinterpret_cast<ns::impl::multistage_samplerate_converter<T>*>(this)->process(
+        output, input, input_size));
+}
+
+template struct multistage_samplerate_converter<float>;
+template struct multistage_samplerate_converter<double>;
+
 #endif
 
 } // namespace kfr
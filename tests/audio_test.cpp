@@ -6,11 +6,17 @@
 
 #include <thread>
 
+#include <kfr/dsp/biquad_design.hpp>
+#include <kfr/dsp/iir_design.hpp>
 #include <kfr/dsp/oscillators.hpp>
 #include <kfr/dsp/units.hpp>
 #include <kfr/test/test.hpp>
+#include <kfr/audio/biquad.hpp>
 #include <kfr/audio/decoder.hpp>
+#include <kfr/audio/dynamics.hpp>
 #include <kfr/audio/encoder.hpp>
+#include <kfr/audio/mixer.hpp>
+#include <kfr/audio/resampler.hpp>
 
 namespace Catch
 {
@@ -1165,6 +1171,227 @@ TEST_CASE("encode and decode")
     }
 }
 
+TEST_CASE("audio_resampler")
+{
+    const size_t channels = 3;
+    audio_data_planar input(channels, 4410);
+    for (size_t ch = 0; ch < channels; ++ch)
+        input.channel(ch) = truncate(sin(counter(0.0, 0.01 * (ch + 1))), input.size);
+
+    audio_resampler planar(resample_quality::normal, 44100, 48000, channels);
+    audio_resampler interleaved(resample_quality::normal, 44100, 48000, channels);
+    const audio_data_planar output = planar.process(input);
+    const audio_data_planar output_interleaved(interleaved.process(audio_data_interleaved(input)));
+    REQUIRE(output.size == 4800);
+    REQUIRE(output_interleaved.size == 4800);
+
+    for (size_t ch = 0; ch < channels; ++ch)
+    {
+        auto reference = sample_rate_converter<fbase>(resample_quality::normal, 48000, 44100);
+        univector<fbase> expected(output.size);
+        reference.process(expected, input.channel(ch));
+        CHECK(rms(output.channel(ch) - expected) < 1e-6);
+        CHECK(rms(output_interleaved.channel(ch) - expected) < 1e-6);
+    }
+}
+
+TEST_CASE("audio_biquad")
+{
+    const size_t channels = 5;
+    audio_data_planar input(channels, 1000);
+    for (size_t ch = 0; ch < channels; ++ch)
+        input.channel(ch) = truncate(sin(counter(0.0, 0.03 * (ch + 1))), input.size);
+
+    const iir_params<fbase> params(
+        std::vector{ biquad_lowpass<fbase>(0.05, 0.7), biquad_highpass<fbase>(0.01, 0.7) });
+    audio_biquad planar(channels, params);
+    audio_biquad interleaved(channels, params);
+    audio_data_planar output(channels, input.size);
+    planar.apply(output, input);
+    audio_data_interleaved filtered(input);
+    interleaved.apply(filtered);
+    const audio_data_planar output_interleaved(filtered);
+
+    for (size_t ch = 0; ch < channels; ++ch)
+    {
+        const univector<fbase> expected = iir(input.channel(ch), params);
+        CHECK(rms(output.channel(ch) - expected) < 1e-6);
+        CHECK(rms(output_interleaved.channel(ch) - expected) < 1e-6);
+    }
+}
+
+TEST_CASE("audio_dynamics")
+{
+    const size_t channels = 3;
+    audio_data_planar input(channels, 2000);
+    for (size_t ch = 0; ch < channels; ++ch)
+        input.channel(ch) = truncate(sin(counter(0.0, 0.02 * (ch + 1))) * (ch + 1), input.size);
+
+    dynamics_params<fbase> params;
+    params.mode      = dynamics_mode::limiter;
+    params.threshold = -3;
+    params.lookahead = 0.001;
+    audio_dynamics planar(params, 48000, channels, true);
+    audio_dynamics interleaved(params, 48000, channels, true);
+    audio_data_planar output(channels, input.size);
+    planar.apply(output, input);
+    audio_data_interleaved limited(input);
+    interleaved.apply(limited);
+    const audio_data_planar output_interleaved(limited);
+
+    const fbase ceiling = std::pow(10.0, -3.0 / 20);
+    for (size_t ch = 0; ch < channels; ++ch)
+    {
+        CHECK(absmaxof(output.channel(ch)) <= ceiling * 1.00001);
+        CHECK(rms(output.channel(ch) - output_interleaved.channel(ch)) < 1e-6);
+    }
+    // Linked: the quietest channel is reduced by the same gain as the loudest one
+    CHECK(absmaxof(output.channel(0)) < ceiling / 2);
+}
+
+TEST_CASE("audio_matrix_mixer")
+{
+    const size_t inputs = 5, outputs = 3, size = 1000;
+    audio_data_planar input(inputs, size);
+    for (size_t ch = 0; ch < inputs; ++ch)
+        input.channel(ch) = truncate(sin(counter(0.0, 0.01 * (ch + 1))), size);
+    // Output 2 is silent, output 1 uses one input
+    const std::vector<fbase> gains{ 0.5, -1, 0, 0.25, 2, //
+                                    0, 0, 0.75, 0, 0,    //
+                                    0, 0, 0, 0, 0 };
+    auto reference = [&](size_t o, size_t n, const std::vector<fbase>& g)
+    {
+        fbase sum = 0;
+        for (size_t i = 0; i < inputs; ++i)
+            sum += g[o * inputs + i] * input.channel(i)[n];
+        return sum;
+    };
+    auto check = [&](const audio_data_planar& output, const std::vector<fbase>& g)
+    {
+        fbase error = 0;
+        for (size_t o = 0; o < outputs; ++o)
+            for (size_t n = 0; n < size; ++n)
+                error = std::max(error, std::abs(output.channel(o)[n] - reference(o, n, g)));
+        CHECK(error < 1e-6);
+    };
+
+    audio_matrix_mixer mixer(inputs, outputs, gains);
+    audio_data_planar planar(outputs, size);
+    mixer.apply(planar, input);
+    check(planar, gains);
+
+    const audio_data_interleaved input_interleaved(input);
+    audio_data_interleaved interleaved(outputs, size);
+    mixer.apply(interleaved, input_interleaved);
+    check(audio_data_planar(interleaved), gains);
+    mixer.apply(interleaved, input);
+    check(audio_data_planar(interleaved), gains);
+    mixer.apply(planar, input_interleaved);
+    check(planar, gains);
+
+    // Crossfade over the next call with frames, then the new gains
+    std::vector<fbase> gains2(gains.size(), 0);
+    gains2[1 * inputs + 4] = 1;
+    mixer.set_gains(gains2, true);
+    CHECK(mixer.gain(1, 4) == 1);
+    mixer.process(planar.pointers(), input.pointers(), 0);
+    mixer.apply(planar, input);
+    fbase error = 0;
+    for (size_t n = 0; n < size; ++n)
+    {
+        const fbase t = fbase(n + 1) / size;
+        for (size_t o = 0; o < outputs; ++o)
+            error = std::max(error, std::abs(planar.channel(o)[n] - (reference(o, n, gains) * (1 - t) +
+                                                                     reference(o, n, gains2) * t)));
+    }
+    CHECK(error < 1e-6);
+    mixer.apply(planar, input);
+    check(planar, gains2);
+
+    // More channels than audio_data allows
+    const size_t many = 40;
+    std::vector<univector<fbase>> sources(many, univector<fbase>(size));
+    std::vector<const fbase*> source_pointers(many);
+    for (size_t i = 0; i < many; ++i)
+    {
+        sources[i]         = truncate(cos(counter(0.0, 0.001 * (i + 1))), size);
+        source_pointers[i] = sources[i].data();
+    }
+    std::vector<univector<fbase>> buses(many / 2, univector<fbase>(size));
+    std::vector<fbase*> bus_pointers(many / 2);
+    audio_matrix_mixer console(many, many / 2);
+    for (size_t o = 0; o < many / 2; ++o)
+    {
+        bus_pointers[o] = buses[o].data();
+        console.set_gain(o, 2 * o, 1);
+        console.set_gain(o, 2 * o + 1, -1);
+    }
+    console.process(bus_pointers.data(), source_pointers.data(), size);
+    for (size_t o = 0; o < many / 2; ++o)
+        CHECK(absmaxof(buses[o] - (sources[2 * o] - sources[2 * o + 1])) < 1e-6);
+
+    // Presets
+    const fbase h = std::sqrt(fbase(0.5));
+    const audio_matrix_mixer downmix =
+        audio_matrix_mixer::for_arrangements(speaker_arrangement::Arr51, speaker_arrangement::Stereo);
+    CHECK(downmix.inputs() == 6);
+    CHECK(downmix.outputs() == 2);
+    // L R C Lfe Ls Rs
+    const fbase left[6] = { 1, 0, h, 0, h, 0 };
+    for (size_t i = 0; i < 6; ++i)
+    {
+        CHECK(std::abs(downmix.gain(0, i) - left[i]) < 1e-6);
+        CHECK(std::abs(downmix.gain(1, i) - left[i ^ (i < 2 || i >= 4 ? 1 : 0)]) < 1e-6);
+    }
+    const audio_matrix_mixer upmix =
+        audio_matrix_mixer::for_arrangements(speaker_arrangement::Mono, speaker_arrangement::Stereo);
+    CHECK(std::abs(upmix.gain(0, 0) - h) < 1e-6);
+    CHECK(std::abs(upmix.gain(1, 0) - h) < 1e-6);
+    const audio_matrix_mixer surround =
+        audio_matrix_mixer::for_arrangements(speaker_arrangement::Music40, speaker_arrangement::Mono);
+    for (size_t i = 0; i < 4; ++i)
+        CHECK(std::abs(surround.gain(0, i) - (i < 2 ? h : fbase(0.5))) < 1e-6);
+}
+
+TEST_CASE("filtfilt_stream")
+{
+    const size_t channels = 2;
+    audio_data_planar input(channels, 10007);
+    for (size_t ch = 0; ch < channels; ++ch)
+        input.channel(ch) =
+            truncate(sin(counter(0.0, 0.003 * (ch + 1))) + cos(counter(0.0, 0.9)), input.size);
+
+    audiofile_format format{};
+    format.codec       = audiofile_codec::ieee_float;
+    format.bit_depth   = 64;
+    format.endianness  = audiofile_endianness::little;
+    format.sample_rate = 44100;
+    format.channels    = channels;
+    std::string name   = "temp" + std::to_string(std::random_device{}()) + ".tmp";
+    auto encoder       = create_raw_encoder({});
+    REQUIRE(encoder->open(name, format));
+    REQUIRE(encoder->write(audio_data_interleaved(input)));
+    REQUIRE(encoder->close());
+
+    const iir_params<fbase> params = to_sos<fbase>(iir_lowpass(butterworth(4), 0.1));
+    auto decoder                   = create_raw_decoder({ {}, format });
+    REQUIRE(decoder->open(name));
+    audio_data_planar output(channels);
+    auto filtered = filtfilt_stream(
+        *decoder, params, [&](const audio_data_planar& segment) { output.append(segment); }, 1000);
+    REQUIRE(filtered);
+    CHECK(*filtered == input.size);
+    REQUIRE(output.size == input.size);
+    for (size_t ch = 0; ch < channels; ++ch)
+    {
+        univector<fbase> expected = input.channel(ch);
+        filtfilt(expected, params);
+        CHECK(rms(output.channel(ch) - expected) < 1e-6);
+    }
+    decoder.reset();
+    std::remove(name.c_str());
+}
+
 #ifndef KFR_NO_MAIN
 int main(int argc, char* argv[])
 {
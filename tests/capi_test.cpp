@@ -223,6 +223,61 @@ void test_fir_f64()
     kfr_filter_delete_plan_f64(filter);
 }
 
+void test_fir_method_f32()
+{
+    const float eps = 0.0001f;
+    printf("[TEST] FIR method f32\n");
+    kfr_f32 taps[600];
+    for (int i = 0; i < 600; i++)
+        taps[i] = cosf(i * 0.1f) / 600;
+    KFR_FILTER_F32* direct = kfr_filter_create_fir_plan_method_f32(taps, 600, 0, KFR_FIR_DIRECT);
+    KFR_FILTER_F32* fft    = kfr_filter_create_fir_plan_method_f32(taps, 600, 100, KFR_FIR_FFT);
+
+    kfr_f32 buf1[FILTER_SIZE * 4];
+    kfr_f32 buf2[FILTER_SIZE * 4];
+    for (int i = 0; i < FILTER_SIZE * 4; i++)
+        buf1[i] = buf2[i] = sinf(i * 0.3f);
+
+    kfr_filter_process_f32(direct, buf1, buf1, FILTER_SIZE * 4);
+    for (int i = 0; i < FILTER_SIZE * 4; i += 100)
+    {
+        const int size = i + 100 <= FILTER_SIZE * 4 ? 100 : FILTER_SIZE * 4 - i;
+        kfr_filter_process_f32(fft, buf2 + i, buf2 + i, size);
+    }
+    for (int i = 0; i < FILTER_SIZE * 4; i++)
+        CHECK(fabsf(buf1[i] - buf2[i]) < eps, "FIR: wrong result at %d: %g != %g", i, buf1[i], buf2[i]);
+
+    kfr_filter_delete_plan_f32(direct);
+    kfr_filter_delete_plan_f32(fft);
+}
+
+void test_fir_long_f64()
+{
+    const double eps = 1e-9;
+    printf("[TEST] FIR long f64\n");
+    // Long enough for the FFT convolution to be chosen by the plain constructor
+    const int tapcount = 8000;
+    const int size     = 16384;
+    static kfr_f64 taps[tapcount];
+    static kfr_f64 buf1[size];
+    static kfr_f64 buf2[size];
+    for (int i = 0; i < tapcount; i++)
+        taps[i] = cos(i * 0.1) / tapcount;
+    KFR_FILTER_F64* automatic = kfr_filter_create_fir_plan_f64(taps, tapcount);
+    KFR_FILTER_F64* direct    = kfr_filter_create_fir_plan_method_f64(taps, tapcount, 0, KFR_FIR_DIRECT);
+    for (int i = 0; i < size; i++)
+        buf1[i] = buf2[i] = sin(i * 0.3);
+
+    kfr_filter_process_f64(direct, buf1, buf1, size);
+    for (int i = 0; i < size; i += 1024)
+        kfr_filter_process_f64(automatic, buf2 + i, buf2 + i, 1024);
+    for (int i = 0; i < size; i++)
+        CHECK(fabs(buf1[i] - buf2[i]) < eps, "FIR: wrong result at %d: %g != %g", i, buf1[i], buf2[i]);
+
+    kfr_filter_delete_plan_f64(automatic);
+    kfr_filter_delete_plan_f64(direct);
+}
+
 void test_iir_f32()
 {
     const float eps = 0.00001f;
@@ -291,6 +346,8 @@ int main()
     test_dft_f64();
     test_fir_f32();
     test_fir_f64();
+    test_fir_method_f32();
+    test_fir_long_f64();
     test_iir_f32();
     test_iir_f64();
 
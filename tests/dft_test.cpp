@@ -148,6 +148,255 @@ TEST_CASE("test_complex_convolve_filter")
     CHECK(rms(cabs(dest - univector<complex<fbase>>({ 0.25, 1., 2.75, 2.5, 3.75 }))) < 0.0001);
 }
 
+TEST_CASE("test_convolve_filter_progressive")
+{
+    random_state gen = random_init(2247448713, 915890490, 864203735, 2982561);
+    univector<fbase> ir = truncate(gen_random_range<fbase>(gen, -1.0, +1.0), 3000);
+    univector<fbase> in = truncate(gen_random_range<fbase>(gen, -1.0, +1.0), 5000);
+    univector<fbase> ref(in.size());
+    univector<fbase> out(in.size());
+    convolve_filter<fbase> filter(ir, 256);
+    convolve_filter<fbase> progressive(ir, 256, true);
+    filter.apply(ref, in);
+    size_t position = 0;
+    for (size_t chunk : { 1, 100, 155, 256, 512, 37, 3939 })
+    {
+        chunk = std::min(chunk, in.size() - position);
+        progressive.apply(out.data() + position, in.data() + position, chunk);
+        progressive.progressive_step_for(std::chrono::microseconds(5));
+        position += chunk;
+    }
+    CHECK(position == in.size());
+    CHECK(rms(out - ref) < 0.0001);
+
+    progressive.reset();
+    progressive.apply(out, in);
+    CHECK(rms(out - ref) < 0.0001);
+}
+
+TEST_CASE("fir_auto_filter")
+{
+    random_state gen = random_init(2247448713, 915890490, 864203735, 2982561);
+    univector<fbase> taps = truncate(gen_random_range<fbase>(gen, -1.0, +1.0), 2500);
+    univector<fbase> in   = truncate(gen_random_range<fbase>(gen, -1.0, +1.0), 6000);
+
+    fir_auto_filter<fbase> direct(taps, 256, fir_method::direct);
+    fir_auto_filter<fbase> fft(taps, 256, fir_method::fft);
+    CHECK(direct.method() == fir_method::direct);
+    CHECK(direct.fft_block_size() == 0);
+    CHECK(fft.method() == fir_method::fft);
+    CHECK(fft.fft_block_size() >= 32);
+
+    univector<fbase> ref(in.size());
+    univector<fbase> out(in.size());
+    direct.apply(ref, in);
+    for (size_t position = 0; position < in.size(); position += 256)
+        fft.apply(out.data() + position, in.data() + position, std::min(size_t(256), in.size() - position));
+    CHECK(rms(out - ref) < 0.0001);
+
+    const fir_cost_model<fbase> model;
+    CHECK(model.select(16, 256) == fir_method::direct);
+    CHECK(model.select(20000, 256) == fir_method::fft);
+    // Small calls make the FFT convolution more expensive
+    CHECK(model.fft_cost(2500, 1024, 16) > model.fft_cost(2500, 1024, 1024));
+    CHECK(fir_auto_filter<fbase>(taps.slice(0, 8), 256).method() == fir_method::direct);
+    CHECK(fir_auto_filter<fbase>(taps, 1024).method() == fir_method::fft);
+}
+
+TEST_CASE("analytic_plan")
+{
+    const size_t size = 256;
+    analytic_plan<fbase> plan(size);
+    univector<complex<fbase>> out(size);
+    univector<fbase> env(size);
+    univector<fbase> ph(size);
+
+    const univector<fbase> in = truncate(cos(counter(fbase(0), c_pi<fbase, 2> * 5 / size)), size);
+    const univector<fbase> im = truncate(sin(counter(fbase(0), c_pi<fbase, 2> * 5 / size)), size);
+    plan.execute(out, in);
+    CHECK(rms(real(out) - in) < 0.00001);
+    CHECK(rms(imag(out) - im) < 0.00001);
+    plan.envelope(env, in);
+    CHECK(rms(env - 1) < 0.00001);
+    plan.phase(ph, in);
+    CHECK(rms(cos(ph) - in) < 0.00001);
+    CHECK(rms(sin(ph) - im) < 0.00001);
+
+    // Reference: zero negative frequencies of the complex spectrum. 360 is not a power of two, so the
+    // inverse real DFT into the output buffer takes the mixed-radix path
+    random_state gen = random_init(2247448713, 915890490, 864203735, 2982561);
+    for (size_t n : { size, size_t(360) })
+    {
+        analytic_plan<fbase> sized(n);
+        const univector<fbase> x = truncate(gen_random_range<fbase>(gen, -1.0, +1.0), n);
+        dft_plan<fbase> dft(n);
+        univector<u8> temp(dft.temp_size);
+        univector<complex<fbase>> spectrum(n);
+        univector<complex<fbase>> ref(n);
+        univector<complex<fbase>> result(n);
+        for (size_t i = 0; i < n; ++i)
+            ref[i] = x[i];
+        dft.execute(spectrum, ref, temp);
+        for (size_t i = 1; i < n; ++i)
+            spectrum[i] *= i < n / 2 ? fbase(2) : i == n / 2 ? fbase(1) : fbase(0);
+        dft.execute(ref, spectrum, temp, true);
+        ref = ref * (fbase(1) / n);
+        sized.execute(result, x);
+        CHECK(rms(cabs(result - ref)) < 0.00001);
+    }
+}
+
+TEST_CASE("analytic_stream")
+{
+    const size_t taps = 255;
+    const univector<fbase> in =
+        truncate(sin(counter(fbase(0), fbase(0.21))) + 0.5 * cos(counter(fbase(0), fbase(0.05))), 3000);
+    univector<complex<fbase>> out(in.size());
+    univector<complex<fbase>> ref(in.size());
+    analytic_stream<fbase> stream(taps, 256);
+    hilbert_fir<fbase> hilbert(taps);
+    CHECK(stream.latency() == hilbert.latency());
+    stream.apply(out.data(), in.data(), 1000);
+    stream.apply(out.data() + 1000, in.data() + 1000, in.size() - 1000);
+    hilbert.apply(ref, in);
+    CHECK(rms(cabs(out - ref)) < 0.0001);
+
+    // Steady state envelope of a mid-band sine is flat
+    univector<fbase> env(in.size());
+    const univector<fbase> sine = truncate(sin(counter(fbase(0), fbase(0.3))), in.size());
+    stream.reset();
+    stream.envelope(env.data(), sine.data(), sine.size());
+    CHECK(absmaxof(env.slice(taps, in.size() - taps) - 1) < 0.001);
+}
+
+TEST_CASE("psd_estimator")
+{
+    const size_t segment = 256;
+    random_state gen     = random_init(2247448713, 915890490, 864203735, 2982561);
+    const univector<fbase> noise = truncate(gen_random_range<fbase>(gen, -1.0, +1.0), 100000);
+
+    // Reference: straightforward loop over frames
+    {
+        psd_estimator<fbase> welch = psd_estimator<fbase>::welch(segment, 1000);
+        const univector<fbase> window = truncate(window_hann<fbase>(segment), segment);
+        dft_plan_real<fbase> dft(segment);
+        univector<u8> temp(dft.temp_size);
+        univector<complex<fbase>> spectrum(segment / 2 + 1);
+        univector<fbase> ref(segment / 2 + 1, 0);
+        size_t frames = 0;
+        for (size_t start = 0; start + segment <= 3000; start += segment / 2, ++frames)
+        {
+            univector<fbase> frame = noise.slice(start, segment) * window;
+            dft.execute(spectrum, frame, temp);
+            ref = ref + cabssqr(spectrum);
+        }
+        ref = ref * (fbase(2) / (frames * 1000 * sumsqr(window)));
+        ref[0] *= fbase(0.5);
+        ref[segment / 2] *= fbase(0.5);
+
+        size_t position = 0;
+        for (size_t chunk : { 1, 100, 155, 256, 512, 37, 1939 })
+        {
+            welch.push(noise.data() + position, chunk);
+            position += chunk;
+        }
+        CHECK(position == 3000);
+        CHECK(welch.segments() == frames);
+        CHECK(rms(welch.result() - ref) / rms(ref) < 0.00001);
+    }
+
+    // Uniform noise in [-1, 1] has variance 1/3, so the one-sided density is 2/3
+    {
+        psd_estimator<fbase> welch = psd_estimator<fbase>::welch(segment);
+        welch.push(noise);
+        CHECK(std::abs(mean(welch.result().slice(1, segment / 2 - 1)) - fbase(2) / 3) < 0.02);
+
+        psd_estimator<fbase> median = psd_estimator<fbase>::welch(segment, 1, psd_average::median);
+        median.push(noise);
+        CHECK(std::abs(mean(median.result().slice(1, segment / 2 - 1)) - fbase(2) / 3) < 0.05);
+
+        // Only the last 8 periodograms are kept, all of them are taken from the quiet noise
+        psd_estimator<fbase> latest = psd_estimator<fbase>::welch(segment, 1, psd_average::median, 8);
+        const univector<fbase> loud = noise * fbase(10);
+        latest.push(loud);
+        latest.push(noise.data(), 2048);
+        CHECK(latest.segments() == (noise.size() + 2048 - segment) / (segment / 2) + 1);
+        CHECK(std::abs(mean(latest.result().slice(1, segment / 2 - 1)) - fbase(2) / 3) < 0.1);
+
+        psd_estimator<fbase> bartlett = psd_estimator<fbase>::bartlett(segment);
+        bartlett.push(noise);
+        CHECK(bartlett.segments() == noise.size() / segment);
+        CHECK(std::abs(mean(bartlett.result().slice(1, segment / 2 - 1)) - fbase(2) / 3) < 0.02);
+    }
+
+    // Power spectrum of a sine at a bin frequency is A²/2
+    {
+        psd_estimator<fbase> spectrum(segment, segment / 2, to_handle(window_hann<fbase>(segment)),
+                                      psd_average::mean, psd_scaling::spectrum);
+        const univector<fbase> sine =
+            truncate(3 * sin(counter(fbase(0), c_pi<fbase, 2> * 20 / segment)), 4096);
+        spectrum.push(sine);
+        CHECK(std::abs(spectrum.result()[20] - fbase(4.5)) < 0.1);
+    }
+
+    // Coherence of a linearly dependent pair is 1
+    {
+        csd_estimator<fbase> csd = csd_estimator<fbase>::welch(segment);
+        const univector<fbase> y = noise * fbase(0.5);
+        csd.push(noise.data(), y.data(), 5000);
+        csd.push(noise.data() + 5000, y.data() + 5000, 5000);
+        CHECK(rms(csd.coherence() - 1) < 0.0001);
+        CHECK(rms(cabs(csd.csd() - csd.psd_x() * fbase(0.5))) / rms(csd.psd_x()) < 0.0001);
+        CHECK(rms(csd.psd_y() - csd.psd_x() * fbase(0.25)) / rms(csd.psd_y()) < 0.0001);
+
+        // No power in one of the channels
+        csd_estimator<fbase> silent = csd_estimator<fbase>::welch(segment);
+        const univector<fbase> zero(5000, 0);
+        silent.push(zero.data(), noise.data(), 5000);
+        CHECK(absmaxof(silent.coherence()) == 0);
+    }
+}
+
+TEST_CASE("minimum_phase")
+{
+    univector<fbase> taps(101);
+    fir_lowpass(taps, 0.2, to_handle(window_kaiser<fbase>(taps.size(), 8)));
+
+    // Magnitude response at the normalized frequency f
+    auto magnitude = [](const univector<fbase>& h, double f)
+    {
+        std::complex<double> sum = 0;
+        for (size_t n = 0; n < h.size(); ++n)
+            sum += double(h[n]) * std::polar(1.0, -c_pi<double, 2> * f * n);
+        return std::abs(sum);
+    };
+
+    const univector<fbase> full = minimum_phase(taps);
+    const univector<fbase> half = minimum_phase(taps, true);
+    CHECK(full.size() == 101);
+    CHECK(half.size() == 51);
+    for (size_t i = 0; i <= 100; ++i)
+    {
+        const double f = 0.005 * i;
+        const double m = magnitude(taps, f);
+        CHECK(std::abs(magnitude(full, f) - m) < 0.001);
+        // Truncation to the half length is approximate
+        CHECK(std::abs(magnitude(half, f) - std::sqrt(m)) < (f < 0.15 ? 0.002 : 0.01));
+    }
+
+    // Of the filters with the same magnitude response the minimum phase one has the most energy in any
+    // number of the first taps
+    double energy = 0, linear_energy = 0;
+    for (size_t i = 0; i < taps.size(); ++i)
+    {
+        energy += full[i] * full[i];
+        linear_energy += taps[i] * taps[i];
+        CHECK(energy > linear_energy * 0.999);
+    }
+    CHECK(std::abs(energy - linear_energy) < 0.001 * linear_energy);
+    CHECK(sumsqr(full.slice(0, 25)) > 0.95 * energy);
+}
+
 TEST_CASE("test_correlate")
 {
     univector<fbase, 5> a({ 1, 2, 3, 4, 5 });
@@ -157,6 +406,38 @@ TEST_CASE("test_correlate")
     CHECK(rms(c - univector<fbase>({ 1.5, 1., 1.5, 2.5, 3.75, -4., 7.75, 3.5, 1.25 })) < 0.0001);
 }
 
+TEST_CASE("test_correlate_maxlag")
+{
+    random_state gen         = random_init(2247448713, 915890490, 864203735, 2982561);
+    const univector<fbase> a = truncate(gen_random_range<fbase>(gen, -1.0, +1.0), 1000);
+    const univector<fbase> b = truncate(gen_random_range<fbase>(gen, -1.0, +1.0), 800);
+    const univector<fbase> full = correlate(a, b);
+    for (size_t maxlag : { 0, 5, 40, 300 })
+    {
+        const univector<fbase> c = correlate(a, b, maxlag);
+        CHECK(c.size() == 2 * maxlag + 1);
+        CHECK(rms(c - full.slice(b.size() - 1 - maxlag, 2 * maxlag + 1)) < 0.0001);
+    }
+
+    // b is a delayed by 17 samples
+    univector<fbase> delayed(a.size(), 0);
+    delayed.slice(17) = a.slice(0, a.size() - 17);
+    for (size_t maxlag : { 20, 100 })
+    {
+        for (correlation_weighting weighting : { correlation_weighting::none, correlation_weighting::phat })
+        {
+            const univector<fbase> c = correlate(a, delayed, maxlag, weighting);
+            CHECK(std::abs(find_correlation_peak(c).lag + 17) < 0.1);
+        }
+    }
+
+    // Parabolic interpolation is exact for a parabola
+    const univector<fbase> parabola    = truncate(-sqr(counter(fbase(-10)) - fbase(2.3)), 21);
+    const correlation_peak<fbase> peak = find_correlation_peak(parabola);
+    CHECK(std::abs(peak.lag - fbase(2.3)) < 0.0001);
+    CHECK(std::abs(peak.value) < 0.0001);
+}
+
 TEST_CASE("test_complex_correlate")
 {
     univector<complex<fbase>, 5> a({ 1, 2, 3, 4, 5 });
@@ -393,6 +674,96 @@ TEST_CASE("fft_accuracy")
         });
 }
 
+TEST_CASE("dft_progressive_budget")
+{
+    constexpr size_t size = 4096;
+    random_state gen      = random_init(2247448713, 915890490, 864203735, 2982561);
+    dft_plan<float> dft(size, dft_order::normal, true);
+    univector<complex<float>> in = truncate(gen_random_range<float>(gen, -1.0, +1.0), size);
+    univector<complex<float>> ref(size);
+    univector<complex<float>> out(size);
+    univector<u8> temp(dft.temp_size);
+    dft.execute(ref, in, temp);
+
+    dft.progressive_calibrate();
+    CHECK(dft.progressive_cost[0].size() == dft.progressive_total_steps());
+    CHECK(dft.progressive_cost[1].size() == dft.progressive_total_steps());
+
+    auto prog = dft.progressive_start(false, out.data(), in.data(), temp.data());
+    CHECK(dft.progressive_step_for(prog, std::chrono::nanoseconds(0)));
+    CHECK(prog.step == 0);
+    CHECK(!dft.progressive_step_for(prog, std::chrono::seconds(10)));
+    CHECK(prog.step == dft.progressive_total_steps());
+    CHECK(rms(cabs(ref - out)) < 0.0001);
+
+    dft_plan_real<float> dftr(size, dft_pack_format::CCs, true);
+    univector<float> rin = truncate(gen_random_range<float>(gen, -1.0, +1.0), size);
+    univector<complex<float>> rref(size / 2 + 1);
+    univector<complex<float>> rout(size / 2 + 1);
+    univector<u8> rtemp(dftr.temp_size);
+    dftr.execute(rref, rin, rtemp);
+    auto rprog = dftr.progressive_start(rout.data(), rin.data(), rtemp.data());
+    while (dftr.progressive_step_for(rprog, std::chrono::microseconds(1)))
+    {
+    }
+    CHECK(rms(cabs(rref - rout)) < 0.0001);
+}
+
+TEST_CASE("dft_shared_twiddles")
+{
+    random_state gen = random_init(2247448713, 915890490, 864203735, 2982561);
+    auto stage_data  = [](const auto& plan)
+    {
+        std::set<const u8*> result;
+        size_t total = 0;
+        for (const auto& stage : plan.all_stages)
+        {
+            if (stage->data_size)
+                result.insert(stage->data);
+            total += stage->data_size;
+        }
+        CHECK(plan.data_size <= total);
+        return result;
+    };
+
+    univector<complex<fbase>> in = truncate(gen_random_range<fbase>(gen, -1.0, +1.0), 16384);
+    univector<complex<fbase>> ref(in.size());
+    univector<complex<fbase>> out(in.size());
+    auto small = std::make_unique<dft_plan<fbase>>(in.size());
+    univector<u8> temp(small->temp_size);
+    small->execute(ref, in, temp);
+    {
+        dft_plan<fbase> large(in.size() * 4);
+        const std::set<const u8*> a = stage_data(*small);
+        const std::set<const u8*> b = stage_data(large);
+        std::vector<const u8*> common;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(common));
+        CHECK(!common.empty());
+    }
+    small->execute(out, in, temp);
+    CHECK(rms(cabs(ref - out)) == 0);
+
+    // Last plan using the data is destroyed, the next one recreates it
+    small.reset();
+    dft_plan<fbase> again(in.size());
+    again.execute(out, in, temp);
+    CHECK(rms(cabs(ref - out)) == 0);
+#ifndef KFR_ARCH_NEON
+    // Autosort stages after the first one depend only on the number of blocks, so the 16384 plan shares
+    // the stages of 1024, 256, 64 and 16 blocks with the 4096 plan (float plans of these sizes use autosort
+    // except on NEON)
+    {
+        dft_plan<float> autosort_small(4096);
+        dft_plan<float> autosort_large(16384);
+        const std::set<const u8*> a = stage_data(autosort_small);
+        const std::set<const u8*> b = stage_data(autosort_large);
+        std::vector<const u8*> common;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(common));
+        CHECK(common.size() == 4);
+    }
+#endif
+}
+
 TEST_CASE("dct")
 {
     constexpr size_t size = 16;
@@ -452,6 +823,25 @@ static void test_dft_md_t(random_state& gen, shape<Dims> shape)
             CHECK(rms_diff_inplace <= min_prec);
             const T rms_diff_outofplace = rms(cabs(refout - outo));
             CHECK(rms_diff_outofplace <= min_prec);
+
+            // Test progressive (step-by-step) execution
+            outo      = scalar(qnan);
+            size_t steps = dft.progressive_total_steps();
+            auto prog = dft.progressive_start(inverse, outo.data(), in.data(), temp.data());
+            while (dft.progressive_step(prog))
+            {
+                --steps;
+            }
+            CHECK(steps == 1);
+            out  = in;
+            prog = dft.progressive_start(inverse, out.data(), out.data(), temp.data());
+            while (dft.progressive_step_for(prog, std::chrono::microseconds(10)))
+            {
+            }
+            const T rms_diff_inplace_progressive = rms(cabs(refout - out));
+            CHECK(rms_diff_inplace_progressive <= min_prec);
+            const T rms_diff_outofplace_progressive = rms(cabs(refout - outo));
+            CHECK(rms_diff_outofplace_progressive <= min_prec);
         }
     }
 
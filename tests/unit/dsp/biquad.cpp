@@ -4,11 +4,13 @@
  * See LICENSE.txt for details
  */
 
+#include <kfr/base/random.hpp>
 #include <kfr/base/reduce.hpp>
 #include <kfr/base/simd_expressions.hpp>
 #include <kfr/base/univector.hpp>
 #include <kfr/dsp/biquad.hpp>
 #include <kfr/dsp/biquad_design.hpp>
+#include <kfr/dsp/iir_design.hpp>
 #include <kfr/dsp/special.hpp>
 
 KFR_PRAGMA_MSVC(warning(push))
@@ -121,6 +123,294 @@ TEST_CASE("iir_filter")
     float buf[256];
     f.apply(buf);
 }
+
+/// Cascade of sections in transposed direct form II, coefficients of the sample i are returned by coefs(i)
+template <typename T, typename Fn>
+static univector<T> iir_reference(const univector<T>& input, size_t sections, Fn&& coefs)
+{
+    univector<T> output(input.size());
+    std::vector<T> s1(sections, T(0)), s2(sections, T(0));
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        const std::vector<biquad_section<T>> bq = coefs(i);
+        T x                                     = input[i];
+        for (size_t k = 0; k < sections; ++k)
+        {
+            const T y = bq[k].b0 * x + s1[k];
+            s1[k]     = s2[k] + bq[k].b1 * x - bq[k].a1 * y;
+            s2[k]     = bq[k].b2 * x - bq[k].a2 * y;
+            x         = y;
+        }
+        output[i] = x;
+    }
+    return output;
+}
+
+template <typename T>
+static std::vector<biquad_section<T>> lerp_sections(const iir_params<T>& from, const iir_params<T>& to, T t)
+{
+    std::vector<biquad_section<T>> result(from);
+    for (size_t k = 0; k < result.size(); ++k)
+    {
+        result[k].a1 = from[k].a1 + (to[k].a1 - from[k].a1) * t;
+        result[k].a2 = from[k].a2 + (to[k].a2 - from[k].a2) * t;
+        result[k].b0 = from[k].b0 + (to[k].b0 - from[k].b0) * t;
+        result[k].b1 = from[k].b1 + (to[k].b1 - from[k].b1) * t;
+        result[k].b2 = from[k].b2 + (to[k].b2 - from[k].b2) * t;
+    }
+    return result;
+}
+
+template <typename T>
+static void test_iir_filter_set_params(const iir_params<T>& from, const iir_params<T>& to, bool exact)
+{
+    random_state gen         = random_init(1, 2, 3, 4);
+    const univector<T> input = truncate(gen_random_range<T>(std::ref(gen), -1.0, 1.0), 3000);
+    const T tolerance        = std::is_same_v<T, float> ? 1e-5 : 1e-12;
+    const size_t size        = input.size();
+    // Sections of a cascade switch a few samples apart, only the output after the transient is compared
+    const size_t compare_from = exact ? 0 : 2500;
+    auto check                = [&](const univector<T>& output, const univector<T>& expected)
+    {
+        CHECK(rms(output.slice(compare_from) - expected.slice(compare_from)) <
+              rms(expected.slice(compare_from)) * tolerance);
+    };
+
+    // Same coefficients, state is kept
+    iir_filter<T> unchanged(from), updated(from);
+    univector<T> output(size), expected(size);
+    unchanged.apply(expected.data(), input.data(), 700);
+    unchanged.apply(expected.data() + 700, input.data() + 700, size - 700);
+    updated.apply(output.data(), input.data(), 700);
+    updated.set_params(from);
+    updated.apply(output.data() + 700, input.data() + 700, size - 700);
+    CHECK(rms(output - expected) == 0);
+
+    // Immediate switch at the sample 700
+    iir_filter<T> filter(from);
+    filter.apply(output.data(), input.data(), 700);
+    filter.set_params(to);
+    CHECK(!filter.ramping());
+    filter.apply(output.data() + 700, input.data() + 700, size - 700);
+    check(output, iir_reference(input, from.size(),
+                                [&](size_t i) { return lerp_sections(from, to, T(i < 700 ? 0 : 1)); }));
+
+    // Ramp over 1000 samples from the sample 500, coefficients of each step are the ones at its end
+    constexpr size_t ramp_start = 500, ramp = 1000, step = 16;
+    iir_filter<T> ramped(from);
+    ramped.apply(output.data(), input.data(), ramp_start);
+    ramped.set_params(to, ramp, step);
+    CHECK(ramped.ramping());
+    for (size_t offset = ramp_start; offset < size; offset += 300)
+        ramped.apply(output.data() + offset, input.data() + offset, std::min(size_t(300), size - offset));
+    CHECK(!ramped.ramping());
+    check(output, iir_reference(input, from.size(),
+                                [&](size_t i)
+                                {
+                                    if (i < ramp_start)
+                                        return lerp_sections(from, to, T(0));
+                                    const size_t end = (i - ramp_start) / step * step + step;
+                                    return lerp_sections(from, to, T(std::min(end, ramp)) / T(ramp));
+                                }));
+}
+
+TEST_CASE("iir_filter_set_params")
+{
+    test_matrix(named("type") = ctypes_t<float, double>{},
+                [](auto type)
+                {
+                    using T = typename decltype(type)::type;
+                    test_iir_filter_set_params<T>(iir_params<T>(biquad_lowpass<T>(0.05, 0.7)),
+                                                  iir_params<T>(biquad_peak<T>(0.2, 1.0, 6.0)), true);
+                    test_iir_filter_set_params<T>(to_sos<T>(iir_lowpass(butterworth(6), 0.05)),
+                                                  to_sos<T>(iir_highpass(chebyshev1(6, 1), 0.2)), false);
+                });
+}
+
+template <typename T>
+static void test_iir_block_filter(const iir_params<T>& params)
+{
+    constexpr size_t size = 5000;
+    random_state gen      = random_init(1, 2, 3, 4);
+    const univector<T> input    = truncate(gen_random_range<T>(std::ref(gen), -1.0, 1.0), size);
+    const univector<T> expected = iir(input, params);
+    // biquad_process in double precision is the reference for the rounding errors of both, the block form
+    // rounds the precomputed matrices and may be a few times less accurate for poles close to the unit circle
+    iir_params<double> params_f64(params.size());
+    std::copy(params.begin(), params.end(), params_f64.begin());
+    const univector<double> input_f64 = input;
+    const univector<double> exact     = iir(input_f64, params_f64);
+    const double tolerance = std::max(10 * rms(univector<double>(expected) - exact), rms(exact) * 1e-12);
+
+    iir_block_filter<T> filter(params);
+    CHECK(filter.sections() == params.size());
+    univector<T> output(size);
+    // Calls of any size, including the ones shorter than a block
+    size_t offset = 0;
+    for (size_t count : { 1000, 7, 1, 333, 16, 2000 })
+    {
+        filter.apply(output.data() + offset, input.data() + offset, count);
+        offset += count;
+    }
+    filter.apply(output.data() + offset, input.data() + offset, size - offset);
+    CHECK(rms(univector<double>(output) - exact) <= tolerance);
+
+    filter.reset();
+    univector<T> inplace = input;
+    filter.apply(inplace);
+    CHECK(rms(univector<double>(inplace) - exact) <= tolerance);
+}
+
+TEST_CASE("iir_block_filter")
+{
+    test_matrix(named("type") = ctypes_t<float, double>{},
+                [](auto type)
+                {
+                    using T = typename decltype(type)::type;
+                    test_iir_block_filter<T>(iir_params<T>(biquad_peak<T>(0.1, 1.0, 6.0)));
+                    test_iir_block_filter<T>(to_sos<T>(iir_lowpass(butterworth(8), 0.05)));
+                    test_iir_block_filter<T>(to_sos<T>(iir_highpass(chebyshev1(6, 1), 0.2)));
+                    test_iir_block_filter<T>(to_sos<T>(iir_lowpass(butterworth(12), 0.01)));
+                });
+}
+
+template <typename T>
+static void test_iir_parallel()
+{
+    const iir_params<T> params  = to_sos<T>(iir_lowpass(butterworth(8), 0.02));
+    random_state gen            = random_init(1, 2, 3, 4);
+    const univector<T> input    = truncate(gen_random_range<T>(std::ref(gen), -1.0, 1.0), 100000);
+    const univector<T> expected = iir(input, params);
+    univector<T> expected_filtfilt = input;
+    filtfilt(expected_filtfilt, params);
+    const T tolerance = std::is_same_v<T, float> ? 1e-4 : 1e-12;
+    for (size_t threads : { 1, 2, 3, 8 })
+    {
+        univector<T> output = input;
+        iir_parallel(output, params, threads);
+        CHECK(rms(output - expected) < rms(expected) * tolerance);
+        output = input;
+        filtfilt_parallel(output, params, threads);
+        CHECK(rms(output - expected_filtfilt) < rms(expected_filtfilt) * tolerance);
+    }
+}
+
+TEST_CASE("iir_parallel")
+{
+    test_iir_parallel<float>();
+    test_iir_parallel<double>();
+}
+
+template <typename T>
+static void test_multichannel_biquad(size_t channels, bool shared, bool interleaved, bool inplace)
+{
+    constexpr size_t frames = 300;
+    std::vector<iir_params<T>> params(channels);
+    for (size_t c = 0; c < channels; ++c)
+    {
+        const size_t i = shared ? 0 : c;
+        params[c].push_back(biquad_lowpass<T>(0.05 + 0.01 * (i % 30), 0.7));
+        for (size_t s = 0; s < i % 4; ++s)
+            params[c].push_back(biquad_peak<T>(0.1 + 0.05 * s, 1.0, 3.0 + i % 5));
+    }
+    random_state gen = random_init(1, 2, 3, 4);
+    std::vector<univector<T>> input(channels);
+    std::vector<univector<T>> expected(channels);
+    for (size_t c = 0; c < channels; ++c)
+    {
+        input[c]    = truncate(gen_random_range<T>(std::ref(gen), -1.0, 1.0), frames);
+        expected[c] = iir(input[c], params[c]);
+    }
+
+    multichannel_biquad<T> filter =
+        shared ? multichannel_biquad<T>(channels, params[0]) : multichannel_biquad<T>(params);
+    CHECK(filter.channels() == channels);
+    std::vector<univector<T>> output(channels, univector<T>(frames));
+    // Two calls of different sizes check that the state is carried over
+    const size_t split = 77;
+    if (interleaved)
+    {
+        univector<T> in(frames * channels);
+        univector<T> out(frames * channels);
+        for (size_t c = 0; c < channels; ++c)
+            for (size_t f = 0; f < frames; ++f)
+                in[f * channels + c] = input[c][f];
+        T* dest = inplace ? in.data() : out.data();
+        filter.process_interleaved(dest, in.data(), split);
+        filter.process_interleaved(dest + split * channels, in.data() + split * channels, frames - split);
+        for (size_t c = 0; c < channels; ++c)
+            for (size_t f = 0; f < frames; ++f)
+                output[c][f] = dest[f * channels + c];
+    }
+    else
+    {
+        std::vector<T*> dest(channels);
+        std::vector<const T*> src(channels);
+        for (size_t c = 0; c < channels; ++c)
+        {
+            if (inplace)
+                output[c] = input[c];
+            dest[c] = output[c].data();
+            src[c]  = inplace ? output[c].data() : input[c].data();
+        }
+        filter.process(dest.data(), src.data(), split);
+        for (size_t c = 0; c < channels; ++c)
+        {
+            dest[c] += split;
+            src[c] += split;
+        }
+        filter.process(dest.data(), src.data(), frames - split);
+    }
+    for (size_t c = 0; c < channels; ++c)
+        CHECK(rms(output[c] - expected[c]) < (std::is_same_v<T, float> ? 1e-6 : 1e-14));
+}
+
+template <typename T>
+static void test_parallel_sos(const zpk& filter, double tolerance)
+{
+    random_state gen              = random_init(5, 6, 7, 8);
+    const univector<double> input = truncate(gen_random_range<double>(std::ref(gen), -1.0, 1.0), 3000);
+    const univector<double> expected = iir(input, to_sos<double>(filter));
+
+    parallel_sos_filter<T> parallel(to_parallel_sos<T>(filter));
+    univector<T> output = univector<T>(input);
+    for (size_t offset = 0; offset < output.size(); offset += 700)
+        parallel.apply(output.data() + offset, std::min(size_t(700), output.size() - offset));
+    CHECK(rms(univector<double>(output) - expected) < rms(expected) * tolerance);
+}
+
+TEST_CASE("parallel_sos_filter")
+{
+    test_matrix(named("type") = ctypes_t<float, double>{},
+                [](auto type)
+                {
+                    using T       = typename decltype(type)::type;
+                    const double e = std::is_same_v<T, float> ? 1e-5 : 1e-12;
+                    test_parallel_sos<T>(iir_lowpass(butterworth(7), 0.1), e);
+                    test_parallel_sos<T>(iir_highpass(chebyshev2(6, 60), 0.3), e);
+                    test_parallel_sos<T>(iir_bandpass(chebyshev1(5, 1), 0.1, 0.2), e);
+                    // More zeros than poles, the direct term is an FIR filter
+                    test_parallel_sos<T>(zpk{ { 0.5, -0.3, 0.2 }, { 0.9 }, 2.0 }, e);
+                });
+}
+
+TEST_CASE("multichannel_biquad")
+{
+    for (size_t channels : { 1, 3, 8, 11, 16, 33, 64 })
+    {
+        for (bool shared : { false, true })
+        {
+            for (bool interleaved : { false, true })
+            {
+                for (bool inplace : { false, true })
+                {
+                    test_multichannel_biquad<float>(channels, shared, interleaved, inplace);
+                    test_multichannel_biquad<double>(channels, shared, interleaved, inplace);
+                }
+            }
+        }
+    }
+}
 } // namespace KFR_ARCH_NAME
 } // namespace kfr
 
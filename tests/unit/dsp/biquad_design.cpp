@@ -4,4 +4,132 @@
  * See LICENSE.txt for details
  */
 
+#include <kfr/base/random.hpp>
+#include <kfr/base/reduce.hpp>
+#include <kfr/base/simd_expressions.hpp>
+#include <kfr/base/univector.hpp>
+#include <kfr/dsp/biquad.hpp>
 #include <kfr/dsp/biquad_design.hpp>
+
+namespace kfr
+{
+inline namespace KFR_ARCH_NAME
+{
+
+template <typename T>
+static T max_section_error(const biquad_section<T>& x, const biquad_section<T>& y)
+{
+    const biquad_section<T> a = x.normalized_a0();
+    const biquad_section<T> b = y.normalized_a0();
+    return std::max({ std::abs(a.a1 - b.a1), std::abs(a.a2 - b.a2), std::abs(a.b0 - b.b0),
+                      std::abs(a.b1 - b.b1), std::abs(a.b2 - b.b2) });
+}
+
+template <typename T>
+static void test_biquad_batch()
+{
+    // Not a multiple of the vector width, the last vector is partial
+    constexpr size_t count = 37;
+    random_state gen       = random_init(3, 1, 4, 1);
+    const univector<T> frequency =
+        truncate(gen_random_range<T>(std::ref(gen), 0.001, 0.45), count);
+    const univector<T> Q    = truncate(gen_random_range<T>(std::ref(gen), 0.3, 10.0), count);
+    const univector<T> gain = truncate(gen_random_range<T>(std::ref(gen), -24.0, 24.0), count);
+    const T tolerance       = std::is_same_v<T, float> ? 1e-5 : 1e-12;
+
+    auto check = [&](auto&& batch, auto&& scalar)
+    {
+        // Array of sections
+        iir_params<T> sections(count);
+        batch(biquad_soa<T>(sections));
+        // Separate arrays
+        univector<T> a1(count), a2(count), b0(count), b1(count), b2(count);
+        const biquad_soa<T> arrays(a1.data(), a2.data(), b0.data(), b1.data(), b2.data());
+        batch(arrays);
+        T error = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const biquad_section<T> expected = scalar(i);
+            error                            = std::max(error, max_section_error(sections[i], expected));
+            error                            = std::max(error, max_section_error(arrays[i], expected));
+            CHECK(sections[i].a0 == T(1));
+        }
+        CHECK(error < tolerance);
+    };
+
+    check([&](const biquad_soa<T>& out) { biquad_lowpass(out, frequency.data(), Q.data(), count); },
+          [&](size_t i) { return biquad_lowpass<T>(frequency[i], Q[i]); });
+    check([&](const biquad_soa<T>& out) { biquad_highpass(out, frequency.data(), Q.data(), count); },
+          [&](size_t i) { return biquad_highpass<T>(frequency[i], Q[i]); });
+    check([&](const biquad_soa<T>& out) { biquad_bandpass(out, frequency.data(), Q.data(), count); },
+          [&](size_t i) { return biquad_bandpass<T>(frequency[i], Q[i]); });
+    check([&](const biquad_soa<T>& out) { biquad_notch(out, frequency.data(), Q.data(), count); },
+          [&](size_t i) { return biquad_notch<T>(frequency[i], Q[i]); });
+    check([&](const biquad_soa<T>& out)
+          { biquad_peak(out, frequency.data(), Q.data(), gain.data(), count); },
+          [&](size_t i) { return biquad_peak<T>(frequency[i], Q[i], gain[i]); });
+    check([&](const biquad_soa<T>& out) { biquad_lowshelf(out, frequency.data(), gain.data(), count); },
+          [&](size_t i) { return biquad_lowshelf<T>(frequency[i], gain[i]); });
+    check([&](const biquad_soa<T>& out) { biquad_highshelf(out, frequency.data(), gain.data(), count); },
+          [&](size_t i) { return biquad_highshelf<T>(frequency[i], gain[i]); });
+
+    // Lanes of iir_params, the unused ones keep the identity sections
+    iir_params<T, 8> params;
+    biquad_peak(biquad_soa<T>(params), frequency.data(), Q.data(), gain.data(), 5);
+    const iir_params<T> unpacked(params);
+    for (size_t i = 0; i < 8; ++i)
+    {
+        CHECK(max_section_error(unpacked[i], i < 5 ? biquad_peak<T>(frequency[i], Q[i], gain[i])
+                                                   : biquad_section<T>()) < tolerance);
+    }
+}
+
+TEST_CASE("biquad_batch")
+{
+    test_biquad_batch<float>();
+    test_biquad_batch<double>();
+}
+
+template <typename T>
+static void test_multichannel_biquad_set_section()
+{
+    constexpr size_t channels = 11, frames = 500;
+    random_state gen          = random_init(2, 7, 1, 8);
+    const univector<T> input  = truncate(gen_random_range<T>(std::ref(gen), -1.0, 1.0), channels * frames);
+    const univector<T> frequency = truncate(gen_random_range<T>(std::ref(gen), 0.01, 0.4), channels);
+    const univector<T> Q         = truncate(gen_random_range<T>(std::ref(gen), 0.5, 4.0), channels);
+    const univector<T> gain      = truncate(gen_random_range<T>(std::ref(gen), -12.0, 12.0), channels);
+
+    // Second section of every channel is replaced by the batch design
+    univector<T> a1(channels), a2(channels), b0(channels), b1(channels), b2(channels);
+    biquad_peak(biquad_soa<T>(a1.data(), a2.data(), b0.data(), b1.data(), b2.data()), frequency.data(),
+                Q.data(), gain.data(), channels);
+    multichannel_biquad<T> filter(channels, std::vector<biquad_section<T>>{ biquad_lowpass<T>(0.3, 0.7),
+                                                                            biquad_section<T>() });
+    filter.set_section(1, biquad_soa<T>(a1.data(), a2.data(), b0.data(), b1.data(), b2.data()));
+    univector<T> output(channels * frames);
+    filter.process_interleaved(output.data(), input.data(), frames);
+
+    for (size_t c = 0; c < channels; ++c)
+    {
+        univector<T> channel(frames);
+        for (size_t i = 0; i < frames; ++i)
+            channel[i] = input[i * channels + c];
+        const std::vector<biquad_section<T>> sections{ biquad_lowpass<T>(0.3, 0.7),
+                                                       biquad_peak<T>(frequency[c], Q[c], gain[c]) };
+        const univector<T> expected = iir(channel, iir_params<T>(sections));
+        T error                     = 0;
+        for (size_t i = 0; i < frames; ++i)
+            error = std::max(error, std::abs(output[i * channels + c] - expected[i]));
+        CHECK(error < (std::is_same_v<T, float> ? 1e-4 : 1e-12));
+    }
+}
+
+TEST_CASE("multichannel_biquad_set_section")
+{
+    test_multichannel_biquad_set_section<float>();
+    test_multichannel_biquad_set_section<double>();
+}
+
+} // namespace KFR_ARCH_NAME
+} // namespace kfr
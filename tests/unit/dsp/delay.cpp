@@ -44,4 +44,73 @@ TEST_CASE("fracdelay")
     CHECK(rms(b - univector<double>({ 0, 1, 2, 3, 4 })) < constants<double>::epsilon * 5);
 }
 
+template <typename T>
+static void test_fractional_delay_line(delay_interpolation interpolation, T tolerance)
+{
+    constexpr size_t size = 5000;
+    fractional_delay_line<T> line(100, interpolation, 256, 16);
+
+    // Polynomials of the order up to the number of points minus 1 are delayed exactly
+    const size_t order = interpolation == delay_interpolation::linear ? 1 : 3;
+    univector<T> ramp(size);
+    for (size_t i = 0; i < size; ++i)
+        ramp[i] = static_cast<T>(std::pow(i * 0.01, order));
+    univector<T> out(size);
+    line.process(out.data(), ramp.data(), T(20.25), size);
+    if (interpolation != delay_interpolation::sinc)
+    {
+        for (size_t i = 200; i < size; ++i)
+        {
+            const double expected = std::pow((i - 20.25) * 0.01, order);
+            CHECK(std::abs(out[i] - expected) < tolerance * std::pow(i * 0.01, order));
+        }
+    }
+
+    // Modulated delay of a sine
+    const double f            = 0.02;
+    const univector<T> sine   = truncate(sin(counter(T(0), T(c_pi<double, 2> * f))), size);
+    const univector<T> delays = truncate(50 + 40 * sin(counter(T(0), T(0.003))), size);
+    line.reset();
+    // Any block sizes
+    for (size_t offset = 0, block = 1; offset < size; offset += block, block = block * 3 % 257 + 1)
+    {
+        block = std::min(block, size - offset);
+        line.process(out.data() + offset, sine.data() + offset, delays.slice(offset), block);
+    }
+    T error = 0;
+    for (size_t i = 100; i < size; ++i)
+    {
+        const double expected = std::sin(c_pi<double, 2> * f * (i - double(delays[i])));
+        error                 = std::max(error, T(std::abs(out[i] - expected)));
+    }
+    CHECK(error < tolerance);
+
+    // Taps read from one line match the separate lines
+    univector<T> tap1(size), tap2(size), ref1(size), ref2(size);
+    fractional_delay_line<T> line1(100, interpolation, 256, 16), line2(100, interpolation, 256, 16);
+    line.reset();
+    const univector<T> delays2 = truncate(10 + 5 * cos(counter(T(0), T(0.01))), size);
+    for (size_t offset = 0; offset < size; offset += 200)
+    {
+        line.push(sine.data() + offset, 200);
+        T* outputs[2]                   = { tap1.data() + offset, tap2.data() + offset };
+        const univector_ref<const T> taps[2] = { delays.slice(offset, 200), delays2.slice(offset, 200) };
+        line.read(outputs, taps, 2, 200);
+    }
+    line1.process(ref1.data(), sine.data(), delays, size);
+    line2.process(ref2.data(), sine.data(), delays2, size);
+    CHECK(absmaxof(tap1 - ref1) == 0);
+    CHECK(absmaxof(tap2 - ref2) == 0);
+}
+
+TEST_CASE("fractional_delay_line")
+{
+    test_fractional_delay_line<float>(delay_interpolation::linear, 0.005f);
+    test_fractional_delay_line<double>(delay_interpolation::linear, 0.005);
+    test_fractional_delay_line<float>(delay_interpolation::lagrange, 0.0002f);
+    test_fractional_delay_line<double>(delay_interpolation::lagrange, 0.0002);
+    test_fractional_delay_line<float>(delay_interpolation::sinc, 0.0005f);
+    test_fractional_delay_line<double>(delay_interpolation::sinc, 0.0005);
+}
+
 } // namespace KFR_ARCH_NAME
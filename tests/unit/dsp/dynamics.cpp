@@ -0,0 +1,167 @@
+/**
+ * KFR (https://www.kfrlib.com)
+ * Copyright (C) 2016-2025 Dan Casarin
+ * See LICENSE.txt for details
+ */
+
+#include <kfr/base/random.hpp>
+#include <kfr/base/reduce.hpp>
+#include <kfr/base/simd_expressions.hpp>
+#include <kfr/base/univector.hpp>
+#include <kfr/dsp/dynamics.hpp>
+
+namespace kfr
+{
+inline namespace KFR_ARCH_NAME
+{
+
+template <typename T>
+static void test_dynamics_static_curve()
+{
+    // Gain of a constant level after the smoothing has settled, against the expected curve in dB
+    auto check = [](const dynamics_params<T>& params, double level_db, double expected_db)
+    {
+        dynamics_processor<T> processor(params, 48000);
+        univector<T> x(20000, static_cast<T>(std::pow(10.0, level_db / 20)));
+        const T input = x[0];
+        processor.apply(x);
+        CHECK(std::abs(20 * std::log10(x.back() / input) - expected_db) < 1e-3);
+        CHECK(std::abs(processor.gain_reduction() - (expected_db - params.makeup)) < 1e-3);
+    };
+    dynamics_params<T> compressor;
+    compressor.threshold = -20;
+    compressor.ratio     = 4;
+    compressor.knee      = 6;
+    compressor.attack    = 0.001;
+    compressor.release   = 0.01;
+    check(compressor, -30, 0);
+    // Inside the knee: (1/4 - 1)·(-1 + 3)² / 12
+    check(compressor, -21, -0.25);
+    check(compressor, -10, -7.5);
+    compressor.makeup = 3;
+    check(compressor, -10, -4.5);
+
+    dynamics_params<T> expander;
+    expander.mode      = dynamics_mode::expander;
+    expander.threshold = -40;
+    expander.ratio     = 2;
+    expander.attack    = 0.001;
+    expander.release   = 0.01;
+    check(expander, -50, -10);
+    check(expander, -30, 0);
+}
+
+template <typename T>
+static void test_dynamics_limiter()
+{
+    constexpr size_t size = 20000;
+    random_state gen      = random_init(4, 2, 7, 1);
+    univector<T> input    = truncate(gen_random_range<T>(std::ref(gen), -1.0, 1.0), size);
+    // Quiet start, then bursts up to 4 times the full scale
+    input.slice(0, 1000) = input.slice(0, 1000) * T(0.1);
+    for (size_t i = 1000; i < size; ++i)
+        input[i] *= static_cast<T>(i % 3000 < 500 ? 4 : 0.3);
+
+    dynamics_params<T> params;
+    params.mode      = dynamics_mode::limiter;
+    params.threshold = -6;
+    params.release   = 0.05;
+    params.lookahead = 0.002;
+    dynamics_processor<T> limiter(params, 48000);
+    CHECK(limiter.latency() == 96);
+    univector<T> output(size);
+    limiter.apply(output, input);
+
+    const T ceiling = static_cast<T>(std::pow(10.0, -6.0 / 20));
+    CHECK(absmaxof(output) <= ceiling * T(1.00001));
+    CHECK(absmaxof(output) > ceiling * T(0.9));
+    // Below the threshold the input passes unchanged, delayed by the lookahead
+    for (size_t i = 96; i < 1000; ++i)
+        CHECK(output[i] == input[i - 96]);
+    CHECK(limiter.gain_reduction() < 0);
+}
+
+template <typename T>
+static void test_dynamics_multichannel()
+{
+    constexpr size_t channels = 11, frames = 3000;
+    random_state gen          = random_init(9, 1, 3, 5);
+    univector<T> input = truncate(gen_random_range<T>(std::ref(gen), -1.0, 1.0), channels * frames);
+    // Only the channel 0 is above the threshold
+    for (size_t f = 0; f < frames; ++f)
+        for (size_t c = 1; c < channels; ++c)
+            input[f * channels + c] *= T(0.01);
+
+    dynamics_params<T> params;
+    params.threshold = -12;
+    params.ratio     = 3;
+    params.knee      = 4;
+    params.lookahead = 0.001;
+    const T tolerance = std::is_same_v<T, float> ? 1e-6 : 1e-12;
+
+    for (bool linked : { false, true })
+    {
+        // Interleaved buffers through the filter interface, in blocks of any size
+        dynamics_processor<T> interleaved(params, 48000, channels, linked);
+        univector<T> output(channels * frames);
+        for (size_t offset = 0, block = 1; offset < frames; offset += block, block = block * 7 % 101 + 1)
+        {
+            block = std::min(block, frames - offset);
+            interleaved.apply(output.data() + offset * channels, input.data() + offset * channels,
+                              block * channels);
+        }
+
+        // Planar, at once
+        dynamics_processor<T> planar(params, 48000, channels, linked);
+        std::vector<univector<T>> channel_data(channels, univector<T>(frames));
+        std::vector<T*> pointers(channels);
+        for (size_t c = 0; c < channels; ++c)
+        {
+            for (size_t f = 0; f < frames; ++f)
+                channel_data[c][f] = input[f * channels + c];
+            pointers[c] = channel_data[c].data();
+        }
+        planar.process(pointers.data(), pointers.data(), frames);
+
+        const size_t delay = interleaved.latency();
+        T error = 0, quiet_gain = 0;
+        for (size_t c = 0; c < channels; ++c)
+        {
+            // Unlinked channels are the same as separate processors
+            dynamics_processor<T> mono(params, 48000);
+            univector<T> expected(frames);
+            for (size_t f = 0; f < frames; ++f)
+                expected[f] = input[f * channels + c];
+            mono.apply(expected);
+            for (size_t f = 0; f < frames; ++f)
+            {
+                error = std::max(error, std::abs(output[f * channels + c] - channel_data[c][f]));
+                if (!linked)
+                    error = std::max(error, std::abs(output[f * channels + c] - expected[f]));
+                // Ratio of the output to the delayed input of the channel 1
+                if (c == 1 && f == frames - 1)
+                    quiet_gain = output[f * channels + c] / input[(f - delay) * channels + c];
+            }
+        }
+        CHECK(error < tolerance);
+        const T loud_gain = output[(frames - 1) * channels] / input[(frames - 1 - delay) * channels];
+        if (linked)
+            CHECK(std::abs(quiet_gain - loud_gain) < tolerance);
+        else
+            CHECK(std::abs(quiet_gain - 1) < tolerance);
+        CHECK(loud_gain < T(0.9));
+    }
+}
+
+TEST_CASE("dynamics_processor")
+{
+    test_dynamics_static_curve<float>();
+    test_dynamics_static_curve<double>();
+    test_dynamics_limiter<float>();
+    test_dynamics_limiter<double>();
+    test_dynamics_multichannel<float>();
+    test_dynamics_multichannel<double>();
+}
+
+} // namespace KFR_ARCH_NAME
+} // namespace kfr
@@ -5,7 +5,10 @@
  */
 
 #include <complex>
+#include <kfr/base/math_expressions.hpp>
 #include <kfr/dsp/fir.hpp>
+#include <kfr/dsp/fir_design.hpp>
+#include <kfr/dsp/hilbert.hpp>
 
 namespace kfr
 {
@@ -225,6 +228,337 @@ TEST_CASE("fir_complex")
                          return result;
                      });
 }
+
+template <typename U>
+static void test_fir_filter_block(size_t tapcount)
+{
+    using T                 = deep_subtype<U>;
+    const univector<T> re   = truncate(sin(counter(T(0), T(0.31))), 1000);
+    const univector<T> im   = truncate(cos(counter(T(0), T(0.07))), 1000);
+    const univector<T> taps = truncate(cos(counter(T(0.5), T(0.11))), tapcount);
+    univector<U> data(re.size());
+    if constexpr (is_complex<U>)
+        data = make_complex(re, im);
+    else
+        data = re + im;
+    const univector<U> ref = fir(data, fir_params{ taps });
+
+    fir_filter<T, U> filter(taps);
+    univector<U> out(data.size());
+    size_t offset = 0;
+    // Blocks shorter and longer than the filter, then in place
+    for (size_t block : { 1, 7, 64, 2, 300, 33 })
+    {
+        filter.apply(out.data() + offset, data.data() + offset, block);
+        offset += block;
+    }
+    out.slice(offset) = data.slice(offset);
+    filter.apply(out.data() + offset, data.size() - offset);
+    CHECK(absmaxof(cabs(out - ref)) < T(1e-5) * tapcount);
+
+    // Block and expression processing share the delay line
+    filter.reset();
+    filter.apply(out.data(), data.data(), 100);
+    filter.apply(out.data() + 100, data.slice(100, 50), 50);
+    filter.apply(out.data() + 150, data.data() + 150, data.size() - 150);
+    CHECK(absmaxof(cabs(out - ref)) < T(1e-5) * tapcount);
+}
+
+TEST_CASE("fir_filter_block")
+{
+    for (size_t tapcount : { 1, 3, 17, 64, 201 })
+    {
+        test_fir_filter_block<float>(tapcount);
+        test_fir_filter_block<double>(tapcount);
+        test_fir_filter_block<complex<float>>(tapcount);
+    }
+
+    // Taps wider than the samples are not rounded
+    const univector<float> data  = truncate(sin(counter(0.f, 0.31f)), 1000);
+    const univector<double> taps = truncate(cos(counter(0.5, 0.11)), 31);
+    const univector<float> ref   = fir(data, fir_params{ taps });
+    fir_filter<double, float> filter(taps);
+    univector<float> out(data.size());
+    filter.apply(out.data(), data.data(), data.size());
+    CHECK(absmaxof(out - ref) == 0);
+}
+
+template <typename U>
+static void test_fir_multirate(size_t tapcount, size_t factor)
+{
+    using T                 = deep_subtype<U>;
+    const univector<T> re   = truncate(sin(counter(T(0), T(0.031))), 1500);
+    const univector<T> im   = truncate(cos(counter(T(0), T(0.007))), 1500);
+    const univector<T> taps = truncate(cos(counter(T(0.5), T(0.11))) / tapcount, tapcount);
+    univector<U> data(re.size());
+    if constexpr (is_complex<U>)
+        data = make_complex(re, im);
+    else
+        data = re + im;
+    const T epsilon = std::is_same_v<T, float> ? 1e-5 : 1e-12;
+
+    // Reference: every factor-th output of the full-rate filter
+    const univector<U> filtered = fir(data, fir_params{ taps });
+    fir_decimator<T, U> decimator(taps, factor);
+    univector<U> decimated(data.size() / factor + 1);
+    size_t in = 0, out = 0;
+    for (size_t block : { 1, 5, 300, 2, 1000, 192 })
+    {
+        const size_t expected = decimator.output_size_for_input(block);
+        const size_t written  = decimator.process(decimated.data() + out, data.data() + in, block);
+        CHECK(written == expected);
+        out += written;
+        in += block;
+    }
+    CHECK(out == (data.size() + factor - 1) / factor);
+    T error = 0;
+    for (size_t i = 0; i < out; ++i)
+        error = std::max(error, cabs(decimated[i] - filtered[i * factor]));
+    CHECK(error < epsilon);
+
+    // Reference: the filter applied to the zero-stuffed input
+    univector<U> stuffed(data.size() * factor, U(0));
+    for (size_t i = 0; i < data.size(); ++i)
+        stuffed[i * factor] = data[i];
+    const univector<U> upsampled = fir(stuffed, fir_params{ taps });
+    fir_interpolator<T, U> interpolator(taps, factor);
+    univector<U> interpolated(stuffed.size());
+    in = 0;
+    for (size_t block : { 1, 5, 300, 2, 1000, 192 })
+    {
+        CHECK(interpolator.process(interpolated.data() + in * factor, data.data() + in, block) ==
+              block * factor);
+        in += block;
+    }
+    CHECK(absmaxof(cabs(interpolated - upsampled)) < epsilon);
+}
+
+TEST_CASE("fir_multirate")
+{
+    for (size_t factor : { 2, 3, 4, 7, 16, 64 })
+    {
+        for (size_t tapcount : { 1, 15, 64, 127 })
+        {
+            test_fir_multirate<float>(tapcount, factor);
+            test_fir_multirate<double>(tapcount, factor);
+            test_fir_multirate<complex<float>>(tapcount, factor);
+        }
+    }
+}
+
+TEST_CASE("hilbert_fir")
+{
+    using T                      = double;
+    const univector<T, 200> data = sin(counter() * 0.3) + cos(counter() * 0.05) + sequence(1, -2, 0.5);
+    for (size_t taps : { 3, 31, 33 })
+    {
+        univector<T> full(taps);
+        fir_hilbert(full, to_handle(window_kaiser<T>(taps, T(8))));
+        const univector<T> ref = fir(data, fir_params<T>{ full });
+
+        hilbert_fir<T> hilbert(taps);
+        CHECK(hilbert.latency() == taps / 2);
+        CHECK(hilbert.nonzero_taps() == (taps / 2 + 1) / 2 * 2);
+        univector<complex<T>> out(data.size());
+        hilbert.apply(out.data(), data.data(), 77);
+        hilbert.apply(out.data() + 77, data.data() + 77, data.size() - 77);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            CHECK(out[i].real() == (i >= taps / 2 ? data[i - taps / 2] : T(0)));
+            CHECK(std::abs(out[i].imag() - ref[i]) < 1e-12);
+        }
+    }
+}
+
+template <typename U>
+static void test_fir_halfband(size_t tapcount)
+{
+    using T = deep_subtype<U>;
+    univector<T> taps(tapcount);
+    fir_halfband(taps, to_handle(window_kaiser<T>(tapcount, T(6))));
+    const size_t center = tapcount / 2;
+    CHECK(taps[center] == T(0.5));
+    CHECK(std::abs(sum(taps) - 1) < 1e-5);
+    for (size_t i = 0; i < tapcount; ++i)
+        if (i != center && (i - center) % 2 == 0)
+            CHECK(taps[i] == 0);
+
+    const univector<T> re = truncate(sin(counter(T(0), T(0.031))), 1500);
+    const univector<T> im = truncate(cos(counter(T(0), T(0.007))), 1500);
+    univector<U> data(re.size());
+    if constexpr (is_complex<U>)
+        data = make_complex(re, im);
+    else
+        data = re + im;
+    const T epsilon = std::is_same_v<T, float> ? 1e-5 : 1e-12;
+
+    const univector<U> filtered = fir(data, fir_params{ taps });
+    fir_decimator<T, U> decimator(taps, 2);
+    univector<U> decimated(data.size() / 2);
+    size_t in = 0, out = 0;
+    for (size_t block : { 1, 5, 300, 2, 1000, 192 })
+    {
+        out += decimator.process(decimated.data() + out, data.data() + in, block);
+        in += block;
+    }
+    CHECK(out == decimated.size());
+    T error = 0;
+    for (size_t i = 0; i < out; ++i)
+        error = std::max(error, cabs(decimated[i] - filtered[i * 2]));
+    CHECK(error < epsilon);
+
+    univector<U> stuffed(data.size() * 2, U(0));
+    for (size_t i = 0; i < data.size(); ++i)
+        stuffed[i * 2] = data[i];
+    const univector<U> upsampled = fir(stuffed, fir_params{ taps });
+    halfband_interpolator<T, U> interpolator(taps);
+    univector<U> interpolated(stuffed.size());
+    in = 0;
+    for (size_t block : { 1, 5, 300, 2, 1000, 192 })
+    {
+        CHECK(interpolator.process(interpolated.data() + in * 2, data.data() + in, block) == block * 2);
+        in += block;
+    }
+    CHECK(absmaxof(cabs(interpolated - upsampled)) < epsilon);
+}
+
+TEST_CASE("fir_halfband")
+{
+    for (size_t tapcount : { 3, 5, 7, 31, 33, 99 })
+    {
+        test_fir_halfband<float>(tapcount);
+        test_fir_halfband<double>(tapcount);
+        test_fir_halfband<complex<float>>(tapcount);
+    }
+}
+
+// Frequency response with the linear phase removed, real for the symmetric taps, imaginary for the
+// antisymmetric ones
+template <typename T>
+static std::complex<double> fir_zero_phase_response(const univector<T>& taps, double f)
+{
+    std::complex<double> sum = 0;
+    for (size_t n = 0; n < taps.size(); ++n)
+        sum += double(taps[n]) * std::polar(1.0, -2 * c_pi<double> * f * (n - (taps.size() - 1) * 0.5));
+    return sum;
+}
+
+// Maximum weighted error of the amplitude over the bands
+template <typename T>
+static double fir_remez_error(const univector<T>& taps, const std::vector<remez_band>& bands,
+                              remez_type type = remez_type::bandpass)
+{
+    double error = 0;
+    for (const remez_band& band : bands)
+    {
+        for (size_t i = 0; i <= 200; ++i)
+        {
+            const double f = band.low + (band.high - band.low) * i / 200;
+            const std::complex<double> h = fir_zero_phase_response(taps, f);
+            double amplitude = 0, desired = band.gain, weight = band.weight;
+            switch (type)
+            {
+            case remez_type::bandpass:
+                amplitude = h.real();
+                break;
+            case remez_type::differentiator:
+                amplitude = h.imag();
+                desired *= f;
+                if (band.gain != 0 && f > 0)
+                    weight /= f;
+                break;
+            case remez_type::hilbert:
+                amplitude = -h.imag();
+                break;
+            }
+            error = std::max(error, weight * std::abs(amplitude - desired));
+        }
+    }
+    return error;
+}
+
+template <typename T>
+static void test_fir_remez()
+{
+    const double tolerance = std::is_same_v<T, float> ? 1e-5 : 1e-9;
+    {
+        // Low-pass, odd number of taps
+        const std::vector<remez_band> bands{ { 0, 0.2, 1 }, { 0.25, 0.5, 0 } };
+        univector<T> taps(51);
+        const remez_result result = fir_remez(taps, bands);
+        CHECK(result.converged);
+        CHECK(result.deviation < 0.01);
+        CHECK(fir_remez_error(taps, bands) < result.deviation * 1.03 + tolerance);
+        for (size_t i = 0; i < taps.size(); ++i)
+            CHECK(taps[i] == taps[taps.size() - 1 - i]);
+    }
+    {
+        // Low-pass, even number of taps, the stopband error is 10 times smaller
+        const std::vector<remez_band> bands{ { 0, 0.15, 1, 1 }, { 0.2, 0.5, 0, 10 } };
+        univector<T> taps(50);
+        const remez_result result = fir_remez(taps, bands);
+        CHECK(result.converged);
+        CHECK(fir_remez_error(taps, bands) < result.deviation * 1.03 + tolerance);
+        CHECK(std::abs(fir_zero_phase_response(taps, 0.5)) < tolerance);
+    }
+    {
+        // Band-pass, three bands
+        const std::vector<remez_band> bands{ { 0, 0.1, 0 }, { 0.15, 0.3, 1 }, { 0.35, 0.5, 0 } };
+        univector<T> taps(61);
+        const remez_result result = fir_remez(taps, bands);
+        CHECK(result.converged);
+        CHECK(result.deviation < 0.01);
+        CHECK(fir_remez_error(taps, bands) < result.deviation * 1.03 + tolerance);
+    }
+    {
+        // Hilbert transformer, the sign matches fir_hilbert
+        const std::vector<remez_band> bands{ { 0.05, 0.45, 1 } };
+        univector<T> taps(31);
+        const remez_result result = fir_remez(taps, bands, remez_type::hilbert);
+        CHECK(result.converged);
+        CHECK(result.deviation < 0.01);
+        CHECK(fir_remez_error(taps, bands, remez_type::hilbert) < result.deviation * 1.03 + tolerance);
+        CHECK(taps[15] == T(0));
+        CHECK(taps[16] > 0);
+        for (size_t i = 0; i < taps.size(); ++i)
+            CHECK(taps[i] == -taps[taps.size() - 1 - i]);
+    }
+    {
+        // Differentiator, even number of taps
+        const std::vector<remez_band> bands{ { 0, 0.45, 2 * c_pi<double> } };
+        univector<T> taps(16);
+        const remez_result result = fir_remez(taps, bands, remez_type::differentiator);
+        CHECK(result.converged);
+        CHECK(result.deviation < 0.01);
+        CHECK(fir_remez_error(taps, bands, remez_type::differentiator) <
+              result.deviation * 1.03 + tolerance);
+    }
+    {
+        // Halfband, every second tap except the center one is zero
+        univector<T> taps(31);
+        const remez_result result = fir_remez_halfband(taps, 0.2);
+        CHECK(result.converged);
+        for (size_t i = 1; i < taps.size(); i += 2)
+            CHECK(taps[i] == (i == 15 ? T(0.5) : T(0)));
+        const std::vector<remez_band> bands{ { 0, 0.2, 1 }, { 0.3, 0.5, 0 } };
+        CHECK(fir_remez_error(taps, bands) < result.deviation * 1.03 + tolerance);
+    }
+    {
+        // Estimated number of taps is enough for the specification or almost
+        const size_t count = fir_estimate_taps(0.01, 0.001, 0.05);
+        CHECK(count >= 45);
+        CHECK(count <= 60);
+        univector<T> taps(count | 1);
+        const remez_result result = fir_remez(taps, { { 0, 0.15, 1, 1 }, { 0.2, 0.5, 0, 10 } });
+        CHECK(result.deviation < 0.015);
+    }
+}
+
+TEST_CASE("fir_remez")
+{
+    test_fir_remez<float>();
+    test_fir_remez<double>();
+}
 } // namespace KFR_ARCH_NAME
 
 } // namespace kfr
@@ -0,0 +1,105 @@
+/**
+ * KFR (https://www.kfrlib.com)
+ * Copyright (C) 2016-2025 Dan Casarin
+ * See LICENSE.txt for details
+ */
+
+#include <kfr/test/test.hpp>
+
+#include <kfr/base.hpp>
+#include <kfr/dsp/moving_stats.hpp>
+
+using namespace kfr;
+
+namespace KFR_ARCH_NAME
+{
+
+template <typename T, typename Fn>
+static univector<T> moving_reference(const univector<T>& input, size_t length, Fn&& fn)
+{
+    univector<T> result(input.size());
+    std::vector<T> window(length);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        // Zeros before the start of the input
+        for (size_t j = 0; j < length; ++j)
+            window[j] = i + j >= length - 1 ? input[i + j + 1 - length] : T(0);
+        result[i] = fn(window);
+    }
+    return result;
+}
+
+template <typename T>
+static void test_moving_stats(size_t length)
+{
+    constexpr size_t size    = 1000;
+    random_state gen         = random_init(5, 3, 8, 2);
+    const univector<T> input = truncate(gen_random_range<T>(std::ref(gen), -1.0, 1.0), size);
+    // Runs of equal values and a trend exercise the ties and the deque
+    univector<T> data = input;
+    for (size_t i = 300; i < 400; ++i)
+        data[i] = T(0.25);
+    for (size_t i = 600; i < 800; ++i)
+        data[i] = static_cast<T>((i - 600) * 0.01) + data[i] * T(0.1);
+
+    const univector<T> max_ref = moving_reference(data, length, [](std::vector<T>& w)
+                                                  { return *std::max_element(w.begin(), w.end()); });
+    const univector<T> min_ref = moving_reference(data, length, [](std::vector<T>& w)
+                                                  { return *std::min_element(w.begin(), w.end()); });
+    const univector<T> median_ref = moving_reference(data, length,
+                                                     [](std::vector<T>& w)
+                                                     {
+                                                         std::sort(w.begin(), w.end());
+                                                         const size_t n = w.size();
+                                                         return n % 2 ? w[n / 2]
+                                                                      : (w[n / 2 - 1] + w[n / 2]) * T(0.5);
+                                                     });
+    const univector<T> variance_ref = moving_reference(data, length,
+                                                       [](std::vector<T>& w)
+                                                       {
+                                                           double m = 0, s = 0;
+                                                           for (T x : w)
+                                                               m += x;
+                                                           m /= w.size();
+                                                           for (T x : w)
+                                                               s += (x - m) * (x - m);
+                                                           return static_cast<T>(s / w.size());
+                                                       });
+
+    CHECK(absmaxof(univector<T>(moving_max(data, length)) - max_ref) == 0);
+    CHECK(absmaxof(univector<T>(moving_min(data, length)) - min_ref) == 0);
+    CHECK(absmaxof(univector<T>(moving_median(data, length)) - median_ref) == 0);
+    CHECK(absmaxof(univector<T>(moving_variance(data, length)) - variance_ref) <
+          (std::is_same_v<T, float> ? 1e-5 : 1e-13));
+
+    // State is kept between the blocks
+    moving_max_state<T> max_state(length);
+    moving_min_state<T> min_state(length);
+    moving_median_state<T> median_state(length);
+    moving_variance_state<T> variance_state(length);
+    univector<T> max_out(size), min_out(size), median_out(size), variance_out(size);
+    for (size_t offset = 0, block = 1; offset < size; offset += block, block = block * 5 % 67 + 1)
+    {
+        block = std::min(block, size - offset);
+        const auto in = data.slice(offset, block);
+        max_out.slice(offset, block)      = moving_max(in, std::ref(max_state));
+        min_out.slice(offset, block)      = moving_min(in, std::ref(min_state));
+        median_out.slice(offset, block)   = moving_median(in, std::ref(median_state));
+        variance_out.slice(offset, block) = moving_variance(in, std::ref(variance_state));
+    }
+    CHECK(absmaxof(max_out - max_ref) == 0);
+    CHECK(absmaxof(min_out - min_ref) == 0);
+    CHECK(absmaxof(median_out - median_ref) == 0);
+    CHECK(absmaxof(variance_out - variance_ref) < (std::is_same_v<T, float> ? 1e-5 : 1e-13));
+}
+
+TEST_CASE("moving_stats")
+{
+    for (size_t length : { 1, 2, 7, 64, 131 })
+    {
+        test_moving_stats<float>(length);
+        test_moving_stats<double>(length);
+    }
+}
+
+} // namespace KFR_ARCH_NAME
@@ -28,4 +28,69 @@ TEST_CASE("phasor")
     univector<fbase, 100> v2 = sin(constants<fbase>::pi_s(2) * counter(0, 15000 / sr));
     CHECK(rms(v1 - v2) < 1.e-5);
 }
+template <typename T>
+static void test_oscillator_bank(T tolerance)
+{
+    // Not a multiple of the vector width, blocks are split between the calls
+    constexpr size_t partials = 37, size = 3000;
+    oscillator_bank<T> bank(partials);
+    for (size_t k = 0; k < partials; ++k)
+        bank.set(k, T(0.001 + 0.0123 * k), T(1.0 / (k + 1)), T(0.1 * k));
+    univector<T> sum(size);
+    univector<univector<T>> outputs(partials, univector<T>(size));
+    std::vector<T*> pointers(partials);
+    oscillator_bank<T> copy = bank;
+    bank.process(sum.data(), 1000);
+    bank.process(sum.data() + 1000, size - 1000);
+    for (size_t k = 0; k < partials; ++k)
+        pointers[k] = outputs[k].data();
+    copy.process(pointers.data(), size);
+
+    double error = 0, sum_error = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        double expected = 0;
+        for (size_t k = 0; k < partials; ++k)
+        {
+            const double frequency = T(0.001 + 0.0123 * k);
+            const double partial   = std::sin(c_pi<double, 2> * frequency * i + double(T(0.1 * k))) / (k + 1);
+            error = std::max(error, std::abs(outputs[k][i] - partial));
+            expected += partial;
+        }
+        sum_error = std::max(sum_error, std::abs(sum[i] - expected));
+    }
+    CHECK(error < tolerance);
+    CHECK(sum_error < tolerance * 10);
+
+    // Ramps: the frequency and the amplitude change linearly
+    oscillator_bank<T> ramp(1);
+    ramp.set(0, T(0.01), T(1));
+    ramp.set_frequency(0, T(0.03), 1000);
+    ramp.set_amplitude(0, T(0.5), 500);
+    univector<T> out(2000);
+    ramp.process(out.data(), out.size());
+    double phase = 0;
+    error        = 0;
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        const double amplitude = i < 500 ? 1 - 0.5 * i / 500 : 0.5;
+        error                  = std::max(error, std::abs(out[i] - amplitude * std::sin(phase)));
+        phase += c_pi<double, 2> * (0.01 + 0.02 * std::min(i, size_t(1000)) / 1000);
+    }
+    CHECK(error < tolerance * 10);
+
+    // Magnitude of the phasors doesn't drift
+    oscillator_bank<T> long_run(1);
+    long_run.set(0, T(0.1234), T(1));
+    univector<T> tail(1000000);
+    long_run.process(tail.data(), tail.size());
+    CHECK(std::abs(absmaxof(tail.slice(tail.size() - 100)) - 1) < 0.01);
+    CHECK(absmaxof(tail) < 1 + tolerance);
+}
+
+TEST_CASE("oscillator_bank")
+{
+    test_oscillator_bank<float>(0.001f);
+    test_oscillator_bank<double>(1e-9);
+}
 } // namespace KFR_ARCH_NAME
@@ -47,5 +47,224 @@ TEST_CASE("resampler_test_complex")
 
     CHECK(rms(cabs(slice(out - ref, static_cast<size_t>(ceil(delay * 2))))) < 0.005f);
 }
+
+template <typename T>
+static void test_resampler_polyphase(resample_quality quality, int interpolation, int decimation)
+{
+    using ftype    = subtype<T>;
+    using itype    = typename samplerate_converter<T>::itype;
+    auto resampler = sample_rate_converter<T>(quality, interpolation, decimation);
+    const itype L  = resampler.interpolation_factor;
+    const itype D  = resampler.decimation_factor;
+
+    univector<T> in(5000);
+    for (size_t i = 0; i < in.size(); ++i)
+        in[i] = T(std::sin(i * ftype(0.01)) + ftype(0.001) * (i % 17));
+
+    // Direct evaluation of the polyphase filter, one output at a time, input is followed by zeros
+    const size_t out_size = static_cast<size_t>(resampler.output_size_for_input(in.size())) + 3000;
+    univector<T> ref(out_size);
+    for (size_t n = 0; n < out_size; ++n)
+    {
+        const std::lldiv_t pos = floor_div(itype(n) * D - resampler.taps + L, L);
+        const itype tap_start  = L - 1 - pos.rem;
+        T acc                  = 0;
+        for (itype k = 0; k < resampler.depth; ++k)
+        {
+            const itype idx = pos.quot + k;
+            if (idx >= 0 && idx < itype(in.size()))
+                acc += resampler.filter[size_t(tap_start * resampler.depth + k)] * in[size_t(idx)];
+        }
+        ref[n] = acc;
+    }
+
+    // Pull method with varying block sizes, the last blocks get less input than required or none
+    univector<T> out(out_size);
+    size_t consumed = 0;
+    for (size_t produced = 0, block = 1; produced < out_size; block = block * 3 + 1)
+    {
+        const size_t count = std::min(block % 700 + 1, out_size - produced);
+        univector<T> chunk(count);
+        consumed += resampler.process(chunk, in.slice(std::min(consumed, in.size())));
+        out.slice(produced, count) = chunk;
+        produced += count;
+    }
+    CHECK(rms(cabs(out - ref)) < ftype(1e-5));
+}
+
+TEST_CASE("resampler_polyphase")
+{
+    for (resample_quality quality : { resample_quality::draft, resample_quality::normal })
+    {
+        for (auto ratio : { std::pair<int, int>{ 48000, 44100 }, std::pair<int, int>{ 44100, 48000 },
+                            std::pair<int, int>{ 1, 3 }, std::pair<int, int>{ 3, 1 },
+                            std::pair<int, int>{ 4, 6 }, std::pair<int, int>{ 1, 1 } })
+        {
+            test_resampler_polyphase<float>(quality, ratio.first, ratio.second);
+            test_resampler_polyphase<double>(quality, ratio.first, ratio.second);
+            test_resampler_polyphase<complex<float>>(quality, ratio.first, ratio.second);
+        }
+    }
+}
+
+template <typename T>
+static void test_resampler_multichannel(size_t channels, int interpolation, int decimation)
+{
+    const size_t in_size = 3000;
+    std::vector<univector<T>> in(channels);
+    univector<T> in_interleaved(in_size * channels);
+    for (size_t c = 0; c < channels; ++c)
+    {
+        in[c] = truncate(sin(counter(T(c), T(0.01) * (c + 1))), in_size);
+        for (size_t i = 0; i < in_size; ++i)
+            in_interleaved[i * channels + c] = in[c][i];
+    }
+
+    // Every channel with its own converter
+    std::vector<univector<T>> ref(channels);
+    size_t out_size = 0;
+    for (size_t c = 0; c < channels; ++c)
+    {
+        auto resampler = sample_rate_converter<T>(resample_quality::normal, interpolation, decimation);
+        out_size       = resampler.output_size_for_input(in_size) + 200;
+        ref[c].resize(out_size);
+        resampler.process(ref[c], in[c]);
+    }
+
+    const resample_quality quality = resample_quality::normal;
+    multichannel_samplerate_converter<T> planar(quality, interpolation, decimation, channels);
+    multichannel_samplerate_converter<T> interleaved(quality, interpolation, decimation, channels);
+    std::vector<univector<T>> out(channels, univector<T>(out_size));
+    univector<T> out_interleaved(out_size * channels);
+    size_t consumed = 0;
+    for (size_t produced = 0, block = 1; produced < out_size; block = block * 3 + 1)
+    {
+        const size_t count = std::min(block % 500 + 1, out_size - produced);
+        const size_t avail = in_size - std::min(consumed, in_size);
+        std::vector<T*> outputs(channels);
+        std::vector<const T*> inputs(channels);
+        for (size_t c = 0; c < channels; ++c)
+        {
+            outputs[c] = out[c].data() + produced;
+            inputs[c]  = in[c].data() + (in_size - avail);
+        }
+        const size_t used = planar.process(outputs.data(), count, inputs.data(), avail);
+        CHECK(interleaved.process_interleaved(out_interleaved.data() + produced * channels, count,
+                                              in_interleaved.data() + (in_size - avail) * channels,
+                                              avail) == used);
+        consumed += used;
+        produced += count;
+    }
+    for (size_t c = 0; c < channels; ++c)
+    {
+        CHECK(rms(out[c] - ref[c]) < T(1e-6));
+        univector<T> channel(out_size);
+        for (size_t i = 0; i < out_size; ++i)
+            channel[i] = out_interleaved[i * channels + c];
+        CHECK(rms(channel - ref[c]) < T(1e-6));
+    }
+}
+
+TEST_CASE("resampler_multichannel")
+{
+    for (size_t channels : { 1, 2, 3, 4, 6, 8, 11, 16 })
+    {
+        test_resampler_multichannel<float>(channels, 48000, 44100);
+        test_resampler_multichannel<double>(channels, 44100, 48000);
+        test_resampler_multichannel<float>(channels, 1, 3);
+    }
+}
+
+template <typename T>
+static void test_resampler_variable(sinc_interpolation interpolation, double ratio, T tolerance)
+{
+    const double frequency = 0.05;
+    variable_samplerate_converter<T> resampler(resample_quality::normal, ratio, interpolation);
+    const size_t skip = resampler.depth;
+
+    univector<T> out;
+    std::vector<double> time;
+    double t = 0;
+    for (size_t offset = 0, block = 1; offset < 20000; offset += block, block = block * 3 % 997 + 1)
+    {
+        // Ratio drifts by up to 1% between the blocks
+        const double current = ratio * (1 + 0.01 * std::sin(offset * 0.001));
+        resampler.set_ratio(current);
+        univector<T> in(block);
+        for (size_t i = 0; i < block; ++i)
+            in[i] = static_cast<T>(std::sin(c_pi<double, 2> * frequency * (offset + i)));
+        const size_t count = resampler.process(out, in);
+        for (size_t i = 0; i < count; ++i, t += 1 / current)
+            time.push_back(t);
+    }
+    CHECK(out.size() == time.size());
+    CHECK(out.size() > 20000 * ratio * 0.9);
+
+    univector<T> ref(out.size() - skip);
+    for (size_t i = 0; i < ref.size(); ++i)
+        ref[i] = static_cast<T>(std::sin(c_pi<double, 2> * frequency * time[skip + i]));
+    CHECK(rms(out.slice(skip) - ref) < tolerance);
+}
+
+TEST_CASE("resampler_variable")
+{
+    for (double ratio : { 48000.37 / 44099.91, 1.0, 0.7 })
+    {
+        test_resampler_variable<float>(sinc_interpolation::linear, ratio, 1e-5f);
+        test_resampler_variable<float>(sinc_interpolation::cubic, ratio, 1e-5f);
+        test_resampler_variable<double>(sinc_interpolation::cubic, ratio, 1e-6);
+    }
+}
+
+template <typename T>
+static void test_resampler_multistage(size_t input_rate, size_t output_rate, size_t halfband_stages)
+{
+    multistage_samplerate_converter<T> resampler(resample_quality::normal, output_rate, input_rate);
+    CHECK(resampler.halfband_taps.size() == halfband_stages);
+
+    // Tone in the passband and tone above the lower Nyquist frequency, which must not alias
+    const size_t rate = std::min(input_rate, output_rate);
+    const double pass = 0.1 * rate, stop = 0.6 * rate;
+    const size_t size = input_rate / 2;
+    univector<T> pass_in(size), stop_in(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        pass_in[i] = static_cast<T>(std::sin(c_pi<double, 2> * pass * i / input_rate));
+        stop_in[i] = static_cast<T>(std::sin(c_pi<double, 2> * stop * i / input_rate));
+    }
+
+    univector<T> out(resampler.output_size_for_input(size));
+    CHECK(out.size() + 2 >= size * output_rate / input_rate);
+    size_t produced = 0;
+    for (size_t offset = 0, block = 1; offset < size; offset += block, block = block * 5 % 3001 + 1)
+    {
+        block = std::min(block, size - offset);
+        produced += resampler.process(out.data() + produced, pass_in.data() + offset, block);
+    }
+    CHECK(produced == out.size());
+    const double delay = resampler.get_fractional_delay();
+    const size_t skip  = static_cast<size_t>(delay * 2) + 16;
+    univector<T> ref(out.size() - skip);
+    for (size_t i = 0; i < ref.size(); ++i)
+        ref[i] = static_cast<T>(std::sin(c_pi<double, 2> * pass * (skip + i - delay) / output_rate));
+    CHECK(rms(out.slice(skip) - ref) < T(1e-4));
+
+    if (output_rate < input_rate)
+    {
+        multistage_samplerate_converter<T> stopband(resample_quality::normal, output_rate, input_rate);
+        const univector<T> rejected = stopband.process(stop_in);
+        CHECK(rms(rejected.slice(skip)) < T(1e-4));
+    }
+}
+
+TEST_CASE("resampler_multistage")
+{
+    test_resampler_multistage<float>(192000, 8000, 4);
+    test_resampler_multistage<double>(192000, 8000, 4);
+    test_resampler_multistage<float>(96000, 12000, 3);
+    test_resampler_multistage<float>(8000, 48000, 2);
+    test_resampler_multistage<double>(11025, 176400, 4);
+    test_resampler_multistage<float>(44100, 48000, 0);
+}
 } // namespace KFR_ARCH_NAME
 } // namespace kfr
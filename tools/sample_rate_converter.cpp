@@ -58,21 +58,16 @@ int main(int argc, char** argv)
         return 2;
     }
 
-    std::vector<samplerate_converter<fbase>> resamplers(channels);
-    for (size_t ch = 0; ch < channels; ++ch)
-    {
-        resamplers[ch] = resampler<fbase>(resample_quality::high, output_sr, input_sr);
-    }
-    auto& resampler0 = resamplers.front();
+    // One converter for all channels, processes the interleaved audio as it is read and written
+    audio_resampler resampler(resample_quality::high, input_sr, output_sr, channels);
+    const size_t delay = resampler.get_delay();
 
     constexpr size_t output_chunk_size = 16384;
-    audio_data output_chunk(channels, output_chunk_size);
-    audio_data_interleaved output_chunk_interleaved(channels, output_chunk_size);
+    audio_data_interleaved output_chunk(channels, output_chunk_size);
 
-    const size_t input_delay_compensation = resampler0.input_size_for_output(resampler0.get_delay());
+    const size_t input_delay_compensation = resampler.input_size_for_output(delay);
     const size_t input_chunk_size = output_chunk_size * input_sr / output_sr + 1 + input_delay_compensation;
-    audio_data_interleaved input_chunk_interleaved(channels, input_chunk_size);
-    audio_data input_chunk(channels, input_chunk_size);
+    audio_data_interleaved input_chunk(channels, input_chunk_size);
 
     bool first_chunk = true;
     std::chrono::high_resolution_clock::duration resampling_time{};
@@ -82,10 +77,10 @@ int main(int argc, char** argv)
     for (;;)
     {
         const size_t frames_to_read =
-            resampler0.input_size_for_output(output_chunk_size + (first_chunk ? resampler0.get_delay() : 0));
+            resampler.input_size_for_output(output_chunk_size + (first_chunk ? delay : 0));
 
-        // Read channels of audio
-        const auto frames_read = decoder->read_to(input_chunk_interleaved.truncate(frames_to_read));
+        // Read interleaved audio
+        const auto frames_read = decoder->read_to(input_chunk.truncate(frames_to_read));
         if (!frames_read)
         {
             if (frames_read.error() == audiofile_error::end_of_file)
@@ -93,40 +88,34 @@ int main(int argc, char** argv)
             println("Error: cannot read input file: ", to_string(frames_read.error()));
             return 2;
         }
-        // Deinterleave
-        input_chunk = input_chunk_interleaved.truncate(*frames_read);
 
         size_t frames_to_write = output_chunk_size;
         if (*frames_read < frames_to_read)
         {
-            frames_to_write = resampler0.output_size_for_input(*frames_read) + resampler0.get_delay();
+            frames_to_write = resampler.output_size_for_input(*frames_read) + delay;
         }
-        if (frames_to_write <= resampler0.get_delay())
+        if (frames_to_write <= delay)
         {
             println("Error: input file is too short for resampling");
             return 2;
         }
 
         const std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
-        for (size_t ch = 0; ch < channels; ++ch)
+        audio_data_interleaved input = input_chunk.truncate(*frames_read);
+        if (first_chunk)
         {
-            auto& r       = resamplers[ch];
-            auto&& output = output_chunk.channel(ch).truncate(frames_to_write).ref();
-            auto&& input  = input_chunk.channel(ch).truncate(*frames_read);
-            if (first_chunk)
-            {
-                // Skip the first r.get_delay() samples (FIR filter delay).
-                r.skip(r.get_delay(), input);
-            }
-
-            // Process new block of audio
-            r.process(output, input);
+            // Skip the first delay samples (FIR filter delay).
+            audio_data_interleaved skipped(channels, delay);
+            input = input.slice(std::min(resampler.process(skipped, input), input.size));
         }
+
+        // Process new block of audio
+        audio_data_interleaved output = output_chunk.truncate(frames_to_write);
+        resampler.process(output, input);
         resampling_time += std::chrono::high_resolution_clock::now() - t1;
-        output_chunk_interleaved = output_chunk.slice(0, frames_to_write);
 
         // Write audio
-        auto written = encoder->write(output_chunk_interleaved);
+        auto written = encoder->write(output);
         if (!written)
         {
             println("Error: cannot write to output file: ", to_string(written.error()));